@@ -0,0 +1,74 @@
+#pragma once
+#include <mini/console.h>
+#include <mini/time.h>
+
+namespace mini::bench {
+
+//
+// operations between two clock reads,
+// the clock has a millisecond resolution.
+//
+static constexpr size_type batch_size = 16;
+
+inline timestamp_type duration = 1000;
+
+//
+// runs the operation for the configured duration
+// and prints the operations (and bytes) per second.
+//
+template <
+  typename OPERATION
+>
+void
+run(
+  const char* name,
+  const char* backend,
+  size_type bytes_per_operation,
+  OPERATION&& operation
+  )
+{
+  //
+  // warm up the caches and the lazy initialization
+  // of the backend.
+  //
+  operation();
+
+  size_type operation_count = 0;
+  timestamp_type elapsed;
+
+  const timestamp_type start = time::timestamp();
+
+  do
+  {
+    for (size_type i = 0; i < batch_size; i++)
+    {
+      operation();
+    }
+
+    operation_count += batch_size;
+    elapsed = time::timestamp() - start;
+  } while (elapsed < duration);
+
+  const double seconds = elapsed / 1000.0;
+  const double operations_per_second = operation_count / seconds;
+
+  if (bytes_per_operation)
+  {
+    mini::console::write(
+      "%-28s %-8s %12.0f op/s %10.1f MB/s\n",
+      name,
+      backend,
+      operations_per_second,
+      operations_per_second * bytes_per_operation / (1000.0 * 1000.0));
+  }
+  else
+  {
+    mini::console::write(
+      "%-28s %-8s %12.0f op/s\n",
+      name,
+      backend,
+      operations_per_second);
+  }
+}
+
+}
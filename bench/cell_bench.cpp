@@ -0,0 +1,258 @@
+//
+// throughput of the relay cell path: building, encrypting and
+// serializing a RELAY_DATA cell on one end, parsing, decrypting
+// and verifying it on the other end, and back.
+//
+// the steady state of the path must not allocate, the bench
+// fails when any allocation happens while the cells are processed.
+// only the allocations made through operator new are counted,
+// the allocations made inside the crypto backend are not.
+//
+// usage:
+//   cell-bench [duration in milliseconds]
+//
+
+#include "bench.h"
+
+#include <mini/byte_buffer.h>
+#include <mini/stack_buffer.h>
+#include <mini/tor/cell.h>
+#include <mini/tor/relay_cell.h>
+#include <mini/tor/circuit_node_crypto_state.h>
+#include <mini/tor/tor_socket.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<mini::size_type> allocation_count { 0 };
+
+}
+
+void*
+operator new(
+  std::size_t size
+  )
+{
+  allocation_count++;
+
+  if (void* pointer = std::malloc(size ? size : 1))
+  {
+    return pointer;
+  }
+
+  throw std::bad_alloc();
+}
+
+void
+operator delete(
+  void* pointer
+  ) noexcept
+{
+  std::free(pointer);
+}
+
+void
+operator delete(
+  void* pointer,
+  std::size_t size
+  ) noexcept
+{
+  MINI_UNREFERENCED(size);
+
+  std::free(pointer);
+}
+
+namespace {
+
+using namespace mini;
+using namespace mini::tor;
+
+//
+// cells processed while the allocations are counted.
+//
+static constexpr size_type check_cell_count = 1000;
+
+static constexpr protocol_version_type protocol_version = tor_socket::protocol_version_preferred;
+
+static constexpr circuit_id_type circuit_id = 0x80000001;
+
+static constexpr tor_stream_id_type stream_id = 1;
+
+static constexpr size_type digest_size = 20;
+
+static constexpr size_type key_size = 16;
+
+//
+// one end of a single-hop circuit.
+//
+// the relay end gets the key material of the client end
+// with the forward and backward halves swapped, so what
+// one end sends forward the other end receives backward.
+//
+class circuit_end
+{
+  public:
+    circuit_end(
+      const byte_buffer_ref key_material
+      )
+      : _crypto_state(key_material)
+    {
+
+    }
+
+    //
+    // builds, encrypts and serializes the cell into the wire buffer.
+    //
+    void
+    send(
+      const byte_buffer_ref relay_payload,
+      mutable_byte_buffer_ref wire
+      )
+    {
+      relay_cell cell(
+        circuit_id,
+        cell_command::relay,
+        nullptr,
+        cell_command::relay_data,
+        stream_id,
+        relay_payload);
+
+      _crypto_state.build_forward_cell(cell);
+
+      stack_byte_buffer<cell::payload_size> keystream;
+      memory::zero(keystream.get_buffer(), keystream.get_size());
+
+      _crypto_state.xor_forward_keystream(keystream);
+      memory::exclusive_or(cell.get_mutable_payload().get_buffer(), keystream.get_buffer(), keystream.get_size());
+
+      cell.write_bytes(protocol_version, wire);
+    }
+
+    //
+    // parses, decrypts and verifies the cell from the wire buffer
+    // and copies its relay payload into the output buffer.
+    //
+    bool
+    receive(
+      const byte_buffer_ref wire,
+      mutable_byte_buffer_ref relay_payload
+      )
+    {
+      const size_type header_size = wire.get_size() - cell::payload_size;
+
+      cell received_cell(
+        circuit_id,
+        cell_command::relay,
+        wire.slice(header_size));
+
+      stack_byte_buffer<cell::payload_size> keystream;
+      memory::zero(keystream.get_buffer(), keystream.get_size());
+
+      _crypto_state.xor_backward_keystream(keystream);
+      memory::exclusive_or(received_cell.get_mutable_payload().get_buffer(), keystream.get_buffer(), keystream.get_size());
+
+      if (!_crypto_state.verify_backward_cell(received_cell))
+      {
+        return false;
+      }
+
+      const relay_cell decrypted_cell(nullptr, received_cell);
+      const byte_buffer_ref payload = decrypted_cell.get_relay_payload();
+
+      memory::copy(relay_payload.get_buffer(), payload.get_buffer(), payload.get_size());
+      return true;
+    }
+
+  private:
+    circuit_node_crypto_state _crypto_state;
+};
+
+}
+
+int
+main(
+  int argc,
+  char* argv[]
+  )
+{
+  if (argc > 1)
+  {
+    mini::bench::duration = static_cast<timestamp_type>(atoi(argv[1]));
+  }
+
+  //
+  // Df | Db | Kf | Kb
+  //
+  byte_buffer client_key_material(2 * digest_size + 2 * key_size);
+
+  for (size_type i = 0; i < client_key_material.get_size(); i++)
+  {
+    client_key_material[i] = static_cast<byte_type>(i * 7 + 1);
+  }
+
+  //
+  // Db | Df | Kb | Kf
+  //
+  byte_buffer relay_key_material;
+  relay_key_material.add_many(client_key_material.slice(digest_size, 2 * digest_size));
+  relay_key_material.add_many(client_key_material.slice(0, digest_size));
+  relay_key_material.add_many(client_key_material.slice(2 * digest_size + key_size, 2 * digest_size + 2 * key_size));
+  relay_key_material.add_many(client_key_material.slice(2 * digest_size, 2 * digest_size + key_size));
+
+  circuit_end client(client_key_material);
+  circuit_end relay(relay_key_material);
+
+  byte_buffer wire(cell(circuit_id, cell_command::relay).get_size_in_bytes(protocol_version));
+  byte_buffer relay_payload(relay_cell::payload_data_size);
+  byte_buffer received_payload(relay_cell::payload_data_size);
+
+  bool verified = true;
+
+  auto round_trip = [&]() {
+    client.send(relay_payload, wire);
+    verified &= relay.receive(wire, received_payload);
+
+    relay.send(received_payload, wire);
+    verified &= client.receive(wire, received_payload);
+  };
+
+  //
+  // the first round trip may initialize the backend lazily.
+  //
+  round_trip();
+
+  const size_type allocations_before = allocation_count;
+
+  for (size_type i = 0; i < check_cell_count; i++)
+  {
+    round_trip();
+  }
+
+  const size_type allocations = allocation_count - allocations_before;
+
+  if (!verified)
+  {
+    mini::console::write("cell-bench: a cell failed the digest check\n");
+    return EXIT_FAILURE;
+  }
+
+  if (allocations)
+  {
+    mini::console::write(
+      "cell-bench: %u allocations in %u cells, the relay cell path must not allocate\n",
+      static_cast<uint32_t>(allocations),
+      static_cast<uint32_t>(check_cell_count * 2));
+
+    return EXIT_FAILURE;
+  }
+
+  //
+  // two cells per round trip.
+  //
+  mini::bench::run("relay cell round trip", "", 2 * cell::payload_size, round_trip);
+
+  return EXIT_SUCCESS;
+}
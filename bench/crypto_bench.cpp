@@ -0,0 +1,233 @@
+//
+// throughput of the crypto backends on the operations
+// the tor protocol performs per cell and per handshake.
+//
+// usage:
+//   crypto-bench [duration in milliseconds per case]
+//
+
+#include "bench.h"
+
+#include <mini/byte_buffer.h>
+#include <mini/crypto/aes.h>
+#include <mini/crypto/dh.h>
+#include <mini/crypto/sha1.h>
+#include <mini/crypto/sha256.h>
+#include <mini/crypto/hmac_sha256.h>
+#include <mini/crypto/curve25519.h>
+#include <mini/crypto/ext/sha1.h>
+#include <mini/crypto/ext/curve25519.h>
+
+#include <cstdlib>
+
+namespace {
+
+using namespace mini;
+using mini::bench::run;
+
+//
+// size of the relay cell payload.
+//
+static constexpr size_type relay_payload_size = 509;
+
+//
+// size of a large stream buffer.
+//
+static constexpr size_type bulk_size = 64 * 1024;
+
+//
+// second oakley group, used by the TAP handshake.
+//
+static const byte_type dh_generator[] = {
+  2
+};
+
+static const byte_type dh_modulus[] = {
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xc9, 0x0f, 0xda, 0xa2, 0x21, 0x68, 0xc2, 0x34,
+  0xc4, 0xc6, 0x62, 0x8b, 0x80, 0xdc, 0x1c, 0xd1, 0x29, 0x02, 0x4e, 0x08, 0x8a, 0x67, 0xcc, 0x74,
+  0x02, 0x0b, 0xbe, 0xa6, 0x3b, 0x13, 0x9b, 0x22, 0x51, 0x4a, 0x08, 0x79, 0x8e, 0x34, 0x04, 0xdd,
+  0xef, 0x95, 0x19, 0xb3, 0xcd, 0x3a, 0x43, 0x1b, 0x30, 0x2b, 0x0a, 0x6d, 0xf2, 0x5f, 0x14, 0x37,
+  0x4f, 0xe1, 0x35, 0x6d, 0x6d, 0x51, 0xc2, 0x45, 0xe4, 0x85, 0xb5, 0x76, 0x62, 0x5e, 0x7e, 0xc6,
+  0xf4, 0x4c, 0x42, 0xe9, 0xa6, 0x37, 0xed, 0x6b, 0x0b, 0xff, 0x5c, 0xb6, 0xf4, 0x06, 0xb7, 0xed,
+  0xee, 0x38, 0x6b, 0xfb, 0x5a, 0x89, 0x9f, 0xa5, 0xae, 0x9f, 0x24, 0x11, 0x7c, 0x4b, 0x1f, 0xe6,
+  0x49, 0x28, 0x66, 0x51, 0xec, 0xe6, 0x53, 0x81, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+};
+
+template <
+  typename AES_TYPE
+>
+void
+bench_aes_ctr(
+  const char* backend
+  )
+{
+  byte_buffer key(AES_TYPE::key_size_in_bytes);
+
+  AES_TYPE cipher;
+  cipher.init(typename AES_TYPE::key(key));
+
+  byte_buffer cell(relay_payload_size);
+  byte_buffer bulk(bulk_size);
+
+  run("aes-128-ctr (509 B)", backend, cell.get_size(), [&]() {
+    cipher.encrypt_inplace(cell);
+  });
+
+  run("aes-128-ctr (64 KiB)", backend, bulk.get_size(), [&]() {
+    cipher.encrypt_inplace(bulk);
+  });
+}
+
+template <
+  typename HASH_TYPE
+>
+void
+bench_sha1(
+  const char* backend
+  )
+{
+  byte_buffer cell(relay_payload_size);
+  byte_buffer bulk(bulk_size);
+
+  //
+  // the running digest of a circuit node
+  // is updated and read for every relay cell.
+  //
+  HASH_TYPE running_digest;
+
+  run("sha1 update+get (509 B)", backend, cell.get_size(), [&]() {
+    running_digest.update(cell);
+    running_digest.duplicate().get();
+  });
+
+  run("sha1 (64 KiB)", backend, bulk.get_size(), [&]() {
+    HASH_TYPE::compute(bulk);
+  });
+}
+
+template <
+  typename HASH_TYPE,
+  typename HMAC_TYPE
+>
+void
+bench_sha256(
+  const char* backend
+  )
+{
+  byte_buffer key(32);
+  byte_buffer cell(relay_payload_size);
+  byte_buffer bulk(bulk_size);
+
+  run("sha256 (509 B)", backend, cell.get_size(), [&]() {
+    HASH_TYPE::compute(cell);
+  });
+
+  run("sha256 (64 KiB)", backend, bulk.get_size(), [&]() {
+    HASH_TYPE::compute(bulk);
+  });
+
+  run("hmac-sha256 (509 B)", backend, cell.get_size(), [&]() {
+    HMAC_TYPE::compute(key, cell);
+  });
+}
+
+template <
+  typename CURVE25519_TYPE
+>
+void
+bench_curve25519(
+  const char* backend
+  )
+{
+  auto peer_private_key = CURVE25519_TYPE::private_key::generate();
+  auto peer_public_key = peer_private_key.export_public_key();
+
+  run("x25519 keygen", backend, 0, [&]() {
+    CURVE25519_TYPE::private_key::generate();
+  });
+
+  auto private_key = CURVE25519_TYPE::private_key::generate();
+
+  run("x25519 shared secret", backend, 0, [&]() {
+    private_key.get_shared_secret(peer_public_key);
+  });
+}
+
+template <
+  typename DH_TYPE
+>
+void
+bench_dh(
+  const char* backend
+  )
+{
+  auto peer_private_key = DH_TYPE::private_key::generate(dh_generator, dh_modulus);
+  auto peer_public_key = peer_private_key.export_public_key();
+
+  run("dh-1024 keygen", backend, 0, [&]() {
+    DH_TYPE::private_key::generate(dh_generator, dh_modulus);
+  });
+
+  auto private_key = DH_TYPE::private_key::generate(dh_generator, dh_modulus);
+
+  run("dh-1024 shared secret", backend, 0, [&]() {
+    private_key.get_shared_secret(peer_public_key);
+  });
+}
+
+}
+
+int
+main(
+  int argc,
+  char* argv[]
+  )
+{
+  if (argc > 1)
+  {
+    mini::bench::duration = static_cast<timestamp_type>(atoi(argv[1]));
+  }
+
+  using namespace mini::crypto;
+
+#ifdef MINI_OS_WINDOWS
+  bench_aes_ctr<capi::aes<cipher_mode::ctr, 128>>("capi");
+  bench_aes_ctr<cng::aes<cipher_mode::ctr, 128>>("cng");
+
+  bench_sha1<capi::hash<hash_algorithm_type::sha1>>("capi");
+  bench_sha1<cng::hash<hash_algorithm_type::sha1>>("cng");
+  bench_sha1<ext::sha1>("ext");
+
+  bench_sha256<
+    capi::hash<hash_algorithm_type::sha256>,
+    capi::hmac<capi::hash<hash_algorithm_type::sha256>>>("capi");
+  bench_sha256<
+    cng::hash<hash_algorithm_type::sha256>,
+    cng::hmac<cng::hash<hash_algorithm_type::sha256>>>("cng");
+
+  bench_curve25519<cng::curve25519>("cng");
+  bench_curve25519<ext::curve25519>("ext");
+
+  bench_dh<capi::dh<1024>>("capi");
+  bench_dh<cng::dh<1024>>("cng");
+#else
+  //
+  // the capi and cng backends are stubs outside of windows.
+  //
+  bench_aes_ctr<openssl::aes<cipher_mode::ctr, 128>>("openssl");
+
+  bench_sha1<openssl::hash<hash_algorithm_type::sha1>>("openssl");
+  bench_sha1<ext::sha1>("ext");
+
+  bench_sha256<
+    openssl::hash<hash_algorithm_type::sha256>,
+    openssl::hmac<openssl::hash<hash_algorithm_type::sha256>>>("openssl");
+
+  bench_curve25519<openssl::curve25519>("openssl");
+  bench_curve25519<ext::curve25519>("ext");
+
+  bench_dh<openssl::dh<1024>>("openssl");
+#endif
+
+  return 0;
+}
@@ -0,0 +1,116 @@
+//
+// parse throughput of the directory documents
+// in doc/example-descriptors.
+//
+// usage:
+//   parser-bench [example descriptors directory] [duration in milliseconds per case]
+//
+
+#include "bench.h"
+
+#include <mini/logger.h>
+#include <mini/io/file.h>
+#include <mini/tor/consensus.h>
+#include <mini/tor/parsers/hidden_service_descriptor_parser.h>
+#include <mini/tor/parsers/introduction_point_parser.h>
+#include <mini/tor/parsers/onion_router_descriptor_parser.h>
+
+#include <cstdlib>
+
+namespace {
+
+using namespace mini;
+using namespace mini::tor;
+using mini::bench::run;
+
+string
+read_document(
+  const string_ref directory,
+  const char* file_name
+  )
+{
+  const string path = string::format("%s/%s", directory.get_buffer(), file_name);
+
+  //
+  // io::file::read_to_string() doesn't check
+  // whether the file could be opened.
+  //
+  if (!io::file::exists(path))
+  {
+    mini::console::write("cannot read '%s'\n", path.get_buffer());
+    exit(EXIT_FAILURE);
+  }
+
+  const string content = io::file::read_to_string(path);
+
+  if (content.is_empty())
+  {
+    mini::console::write("'%s' is empty\n", path.get_buffer());
+    exit(EXIT_FAILURE);
+  }
+
+  return content;
+}
+
+}
+
+int
+main(
+  int argc,
+  char* argv[]
+  )
+{
+  const string_ref directory = argc > 1
+    ? string_ref(argv[1])
+    : string_ref("doc/example-descriptors");
+
+  if (argc > 2)
+  {
+    mini::bench::duration = static_cast<timestamp_type>(atoi(argv[2]));
+  }
+
+  mini::log.set_level(mini::logger::level::off);
+
+  const string consensus_content = read_document(directory, "consensus.txt");
+  const string server_descriptor = read_document(directory, "server-descriptor-847b1f850344d7876491a54892f904934e4eb85d.txt");
+  const string hidden_service_descriptor = read_document(directory, "hidden-service-descriptor-4frkg4jpbmbjhlsrbyjpbmu3slphz7ts.txt");
+  const string introduction_points = read_document(directory, "introduction-point.txt");
+
+  //
+  // the example consensus has expired long ago,
+  // don't reject it.
+  //
+  run("consensus (with teardown)", "", consensus_content.get_size(), [&]() {
+    consensus parsed_consensus(consensus::content_tag(), consensus_content);
+  });
+
+  consensus example_consensus(consensus::content_tag(), consensus_content);
+
+  //
+  // the example server descriptor is the one of tor26.
+  //
+  onion_router* router = example_consensus.get_onion_router_by_name("tor26");
+
+  if (!router)
+  {
+    mini::console::write("'tor26' isn't in the example consensus\n");
+    return EXIT_FAILURE;
+  }
+
+  run("server descriptor", "", server_descriptor.get_size(), [&]() {
+    onion_router_descriptor_parser parser;
+    parser.parse(router, server_descriptor);
+  });
+
+  run("hidden service descriptor", "", hidden_service_descriptor.get_size(), [&]() {
+    hidden_service_descriptor_parser parser;
+    parser.parse(example_consensus, hidden_service_descriptor);
+  });
+
+  run("introduction points", "", introduction_points.get_size(), [&]() {
+    introduction_point_parser parser;
+    parser.parse(example_consensus, introduction_points);
+  });
+
+  return 0;
+}
@@ -0,0 +1,232 @@
+//
+// time-to-first-byte of a RELAY_DATA cell: from the moment
+// the circuit appends the payload to the stream until the
+// blocked reader returns it.
+//
+// the 10 ms sleep-poll reader which tor_stream used before
+// is replicated here, so both can be compared in one run.
+//
+// usage:
+//   stream-latency-bench [sample count]
+//
+
+#include <mini/console.h>
+#include <mini/logger.h>
+#include <mini/algorithm.h>
+#include <mini/byte_buffer.h>
+#include <mini/threading/event.h>
+#include <mini/threading/mutex.h>
+#include <mini/threading/thread.h>
+#include <mini/threading/thread_function.h>
+#include <mini/tor/circuit.h>
+#include <mini/tor/relay_cell.h>
+#include <mini/tor/tor_socket.h>
+#include <mini/tor/tor_stream.h>
+#include <mini/tor/detail/tor_stream_access.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+
+namespace mini::tor {
+
+using clock_type = std::chrono::steady_clock;
+
+//
+// the cells arrive 1 to 10 ms after the previous read,
+// so the arrivals are spread over the poll period
+// and the reader is blocked when they arrive.
+//
+static constexpr timeout_type poll_period = 10;
+
+struct stream_latency_bench
+{
+  collections::list<double> latencies;
+
+  //
+  // the reader of tor_stream before the event-driven receive path.
+  //
+  byte_buffer poll_buffer;
+  threading::mutex poll_buffer_mutex;
+
+  size_type
+  poll_read(
+    mutable_byte_buffer_ref output
+    )
+  {
+    for (;;)
+    {
+      mini_lock(poll_buffer_mutex)
+      {
+        if (!poll_buffer.is_empty())
+        {
+          break;
+        }
+      }
+
+      threading::thread::sleep(poll_period);
+    }
+
+    size_type size_copied;
+
+    mini_lock(poll_buffer_mutex)
+    {
+      size_copied = algorithm::min(output.get_size(), poll_buffer.get_size());
+      memory::copy(output.get_buffer(), poll_buffer.get_buffer(), size_copied);
+
+      poll_buffer = byte_buffer_ref(poll_buffer).slice(size_copied);
+    }
+
+    return size_copied;
+  }
+
+  void
+  poll_append(
+    const byte_buffer_ref payload
+    )
+  {
+    mini_lock(poll_buffer_mutex)
+    {
+      poll_buffer.add_many(payload);
+    }
+  }
+
+  //
+  // sends the cells one by one and measures
+  // how long the reader takes to return each of them.
+  //
+  template <
+    typename READ,
+    typename APPEND
+  >
+  void
+  measure(
+    const char* name,
+    size_type sample_count,
+    READ&& read,
+    APPEND&& append
+    )
+  {
+    byte_buffer payload(relay_cell::payload_data_size);
+
+    latencies.clear();
+    latencies.reserve(sample_count);
+
+    clock_type::time_point sent_at;
+    threading::event read_event(threading::reset_type::auto_reset);
+
+    threading::thread_function reader([&]() {
+      byte_buffer received(relay_cell::payload_data_size);
+
+      for (size_type i = 0; i < sample_count; i++)
+      {
+        size_type received_size = 0;
+
+        while (received_size < payload.get_size())
+        {
+          received_size += read(mutable_byte_buffer_ref(received).slice(received_size));
+        }
+
+        const std::chrono::duration<double, std::micro> latency = clock_type::now() - sent_at;
+        latencies.add(latency.count());
+
+        read_event.set();
+      }
+    });
+
+    reader.start();
+
+    for (size_type i = 0; i < sample_count; i++)
+    {
+      threading::thread::sleep(1 + static_cast<timeout_type>(i * 7) % poll_period);
+
+      sent_at = clock_type::now();
+      append(payload);
+
+      read_event.wait();
+    }
+
+    reader.join();
+
+    print(name);
+  }
+
+  void
+  print(
+    const char* name
+    )
+  {
+    std::sort(latencies.begin(), latencies.end());
+
+    double sum = 0;
+
+    for (auto latency : latencies)
+    {
+      sum += latency;
+    }
+
+    const size_type count = latencies.get_size();
+
+    mini::console::write(
+      "%-16s samples: %5u  min: %9.1f us  median: %9.1f us  p99: %9.1f us  mean: %9.1f us\n",
+      name,
+      static_cast<uint32_t>(count),
+      latencies[0],
+      latencies[count / 2],
+      latencies[count * 99 / 100],
+      sum / count);
+  }
+
+  void
+  run(
+    size_type sample_count
+    )
+  {
+    measure("sleep-poll", sample_count,
+      [this](mutable_byte_buffer_ref output) { return poll_read(output); },
+      [this](const byte_buffer_ref payload) { poll_append(payload); });
+
+    //
+    // the stream isn't registered in the circuit,
+    // nothing is sent over the unconnected socket.
+    //
+    tor_socket socket(nullptr);
+    circuit stream_circuit(socket);
+    tor_stream stream(1, &stream_circuit);
+
+    measure("tor_stream", sample_count,
+      [&stream](mutable_byte_buffer_ref output) { return stream.read(output.get_buffer(), output.get_size()); },
+      [&stream](const byte_buffer_ref payload) { detail::tor_stream_access::append_to_recv_buffer(stream, payload); });
+
+    detail::tor_stream_access::destroy(stream);
+  }
+};
+
+}
+
+int
+main(
+  int argc,
+  char* argv[]
+  )
+{
+  const int sample_count = argc > 1
+    ? atoi(argv[1])
+    : 500;
+
+  //
+  // print() needs at least one sample.
+  //
+  if (sample_count <= 0)
+  {
+    mini::console::write("usage: stream-latency-bench [sample count > 0]\n");
+    return EXIT_FAILURE;
+  }
+
+  mini::log.set_level(mini::logger::level::off);
+
+  mini::tor::stream_latency_bench bench;
+  bench.run(static_cast<mini::size_type>(sample_count));
+
+  return 0;
+}
@@ -6,9 +6,11 @@
 #include <mini/io/stream_reader.h>
 #include <mini/io/file.h>
 #include <mini/tor/circuit.h>
+#include <mini/tor/circuit_pool.h>
 #include <mini/tor/consensus.h>
 #include <mini/tor/tor_socket.h>
 #include <mini/tor/tor_stream.h>
+#include <mini/tor/crypto/ntor_key_pool.h>
 #include <mini/net/http.h>
 #include <mini/net/ssl_stream.h>
 #include <mini/net/uri.h>
@@ -33,26 +35,126 @@ class tor_client
     }
 
     void
-    extend_to_random(
+    reset_circuit(
+      void
+      )
+    {
+      delete _circuit;
+      _circuit = nullptr;
+    }
+
+    mini::tor::onion_router*
+    pick_random(
+      mini::tor::consensus::path_position position,
       mini::tor::onion_router::status_flags flags,
       mini::collections::list<uint16_t> or_ports = {}
       )
     {
-      auto routers = _consensus.get_onion_routers_by_criteria({
-        {}, or_ports, _forbidden_onion_routers, flags
+      auto random_router = _consensus.get_random_onion_router_by_criteria({
+        {}, or_ports, _forbidden_onion_routers, flags, position, {}
       });
 
-      // Vérifier que la liste n'est pas vide avant de générer un index aléatoire
-      if (routers.get_size() == 0) {
-        return;
+      if (random_router)
+      {
+        _forbidden_onion_routers.insert(random_router);
       }
-      
-      auto random_router = routers[mini::crypto::random_device.get_random(routers.get_size())];
 
-      if (random_router)
+      return random_router;
+    }
+
+    void
+    build_circuit(
+      mini::size_type hops
+      )
+    {
+      _hop_count = hops;
+
+      //
+      // take the prebuilt circuit from the pool,
+      // or start a new one on the already connected socket.
+      //
+      if (_circuit == nullptr && _circuit_pool && _socket.is_ready())
       {
-        _forbidden_onion_routers.add(random_router);
-        extend_to(random_router);
+        _circuit = _circuit_pool->get_general_circuit();
+
+        if (_circuit)
+        {
+          mini_info("Using prebuilt circuit...");
+          return;
+        }
+
+        _circuit = _socket.create_circuit();
+      }
+
+      //
+      // select all the remaining hops first and fetch
+      // their descriptors at once, so the circuit building
+      // doesn't wait for the directories.
+      //
+      mini::tor::onion_router_list path;
+
+      for (mini::size_type hop = get_hop_count(); hop < hops; hop++)
+      {
+        mini::tor::onion_router* router;
+
+        //
+        // first hop.
+        //
+        if (hop == 0)
+        {
+          router = pick_random(
+            mini::tor::consensus::path_position::guard,
+            mini::tor::onion_router::status_flag::fast    |
+            mini::tor::onion_router::status_flag::running |
+            mini::tor::onion_router::status_flag::valid,
+            { 80, 443 });
+        }
+
+        //
+        // last hop (exit node).
+        //
+        else if (hop == (hops - 1))
+        {
+          router = pick_random(
+            mini::tor::consensus::path_position::exit,
+            mini::tor::onion_router::status_flag::fast    |
+            mini::tor::onion_router::status_flag::running |
+            mini::tor::onion_router::status_flag::valid   |
+            mini::tor::onion_router::status_flag::exit);
+        }
+
+        //
+        // middle hops.
+        //
+        else
+        {
+          router = pick_random(
+            mini::tor::consensus::path_position::middle,
+            mini::tor::onion_router::status_flag::fast    |
+            mini::tor::onion_router::status_flag::running |
+            mini::tor::onion_router::status_flag::valid);
+        }
+
+        if (!router)
+        {
+          return;
+        }
+
+        path.add(router);
+      }
+
+      _consensus.prefetch_descriptors(path);
+
+      for (auto router : path)
+      {
+        const auto previous_hop_count = get_hop_count();
+
+        extend_to(router);
+
+        if (get_hop_count() != (previous_hop_count + 1))
+        {
+          break;
+        }
       }
     }
 
@@ -70,6 +172,13 @@ class tor_client
           onion_router->get_ip_address().to_string().get_buffer(),
           onion_router->get_or_port());
 
+        //
+        // the pool builds its circuits on the socket,
+        // stop it before reconnecting.
+        //
+        _socket.set_circuit_pool(nullptr);
+        _circuit_pool.reset();
+
         _socket.connect(onion_router);
 
         if (_socket.is_connected())
@@ -79,6 +188,7 @@ class tor_client
           if (get_hop_count() == 1)
           {
             mini_info("Connected...");
+            start_circuit_pool();
           }
           else
           {
@@ -223,6 +333,20 @@ class tor_client
       return result;
     }
 
+    void
+    start_circuit_pool(
+      void
+      )
+    {
+      mini::tor::circuit_pool::options pool_options;
+      pool_options.general_hop_count = _hop_count;
+
+      _circuit_pool = new mini::tor::circuit_pool(_socket, _consensus, pool_options);
+      _circuit_pool->start();
+
+      _socket.set_circuit_pool(_circuit_pool.get());
+    }
+
     mini::size_type
     get_hop_count(
       void
@@ -241,8 +365,10 @@ class tor_client
       ;
 
     mini::tor::tor_socket _socket;
+    mini::ptr<mini::tor::circuit_pool> _circuit_pool;
+    mini::size_type _hop_count = 0;
     mini::tor::circuit* _circuit = nullptr;
-    mini::collections::list<mini::tor::onion_router*> _forbidden_onion_routers;
+    mini::tor::onion_router_set _forbidden_onion_routers;
 };
 
 int
@@ -312,6 +438,12 @@ main(
   static_assert(hops >= 2, "There must be at least 2 hops in the circuit");
   static_assert(hops <= 9, "There must be at most 9 hops in the circuit");
 
+  //
+  // the ephemeral ntor keys are generated
+  // while the consensus is being fetched.
+  //
+  mini::tor::ntor_key_pool::get_default().start();
+
   mini_info("Fetching consensus...");
   tor_client tor;
   mini_info("Consensus fetched...");
@@ -319,40 +451,7 @@ main(
 connect_again:
   while (tor.get_hop_count() < hops)
   {
-    //
-    // first hop.
-    //
-    if (tor.get_hop_count() == 0)
-    {
-      tor.extend_to_random(
-        mini::tor::onion_router::status_flag::fast    |
-        mini::tor::onion_router::status_flag::running |
-        mini::tor::onion_router::status_flag::valid,
-        { 80, 443 });
-    }
-
-    //
-    // last hop (exit node).
-    //
-    else if (tor.get_hop_count() == (hops - 1))
-    {
-      tor.extend_to_random(
-        mini::tor::onion_router::status_flag::fast    |
-        mini::tor::onion_router::status_flag::running |
-        mini::tor::onion_router::status_flag::valid   |
-        mini::tor::onion_router::status_flag::exit);
-    }
-
-    //
-    // middle hops.
-    //
-    else
-    {
-      tor.extend_to_random(
-        mini::tor::onion_router::status_flag::fast    |
-        mini::tor::onion_router::status_flag::running |
-        mini::tor::onion_router::status_flag::valid);
-    }
+    tor.build_circuit(hops);
   }
 
   mini::string content = tor.http_get(
@@ -361,6 +460,7 @@ connect_again:
   if (content.is_empty())
   {
     mini_info("Trying to build new circuit...");
+    tor.reset_circuit();
     goto connect_again;
   }
 
@@ -373,6 +473,8 @@ connect_again:
   mini_info("content size: %u bytes", content.get_size());
   mini_info("-----------------------------");
 
+  mini::tor::ntor_key_pool::get_default().stop();
+
   return 0;
 }
 
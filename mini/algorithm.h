@@ -159,6 +159,22 @@ lower_bound(
   return std::lower_bound(first, last, value, comp);
 }
 
+template <
+  typename T,
+  typename TIterator,
+  typename Compare
+>
+inline TIterator
+upper_bound(
+  TIterator first,
+  TIterator last,
+  const T& value,
+  Compare comp
+  )
+{
+  return std::upper_bound(first, last, value, comp);
+}
+
 template <
   typename T,
   typename TIterator,
@@ -175,6 +191,20 @@ binary_search(
   return std::binary_search(first, last, value, comp);
 }
 
+template <
+  typename TIterator,
+  typename Compare
+>
+inline void
+sort(
+  TIterator first,
+  TIterator last,
+  Compare comp
+  )
+{
+  std::sort(first, last, comp);
+}
+
 }
 
 #endif
\ No newline at end of file
@@ -219,10 +219,13 @@ class buffer_ref
     // non-member operations.
     //
 
+    template <
+      typename U
+    >
     friend bool
     operator==(
-      const buffer_ref<T>& lhs,
-      const buffer_ref<T>& rhs
+      const buffer_ref<U>& lhs,
+      const buffer_ref<U>& rhs
       );
 
   protected:
@@ -2,14 +2,17 @@
 
 namespace mini::collections {
 
+//
+// constructors.
+//
 
 template <
   typename TKey,
   typename TValue,
-  typename IndexType = int,
-  typename Hash = hash_hashmap<pair<TKey, TValue>>,
-  typename KeyEqual = equal_to_hashmap<pair<TKey, TValue>>,
-  typename Allocator = allocator<pair<TKey, TValue>>
+  typename IndexType,
+  typename Hash,
+  typename KeyEqual,
+  typename Allocator
 >
 hashmap<TKey, TValue, IndexType, Hash, KeyEqual, Allocator>::hashmap(
   void
@@ -21,10 +24,10 @@ hashmap<TKey, TValue, IndexType, Hash, KeyEqual, Allocator>::hashmap(
 template <
   typename TKey,
   typename TValue,
-  typename IndexType = int,
-  typename Hash = hash_hashmap<pair<TKey, TValue>>,
-  typename KeyEqual = equal_to_hashmap<pair<TKey, TValue>>,
-  typename Allocator = allocator<pair<TKey, TValue>>
+  typename IndexType,
+  typename Hash,
+  typename KeyEqual,
+  typename Allocator
 >
 hashmap<TKey, TValue, IndexType, Hash, KeyEqual, Allocator>::hashmap(
   const hashmap& other
@@ -36,10 +39,10 @@ hashmap<TKey, TValue, IndexType, Hash, KeyEqual, Allocator>::hashmap(
 template <
   typename TKey,
   typename TValue,
-  typename IndexType = int,
-  typename Hash = hash_hashmap<pair<TKey, TValue>>,
-  typename KeyEqual = equal_to_hashmap<pair<TKey, TValue>>,
-  typename Allocator = allocator<pair<TKey, TValue>>
+  typename IndexType,
+  typename Hash,
+  typename KeyEqual,
+  typename Allocator
 >
 hashmap<TKey, TValue, IndexType, Hash, KeyEqual, Allocator>::hashmap(
   hashmap&& other
@@ -51,10 +54,10 @@ hashmap<TKey, TValue, IndexType, Hash, KeyEqual, Allocator>::hashmap(
 template <
   typename TKey,
   typename TValue,
-  typename IndexType = int,
-  typename Hash = hash_hashmap<pair<TKey, TValue>>,
-  typename KeyEqual = equal_to_hashmap<pair<TKey, TValue>>,
-  typename Allocator = allocator<pair<TKey, TValue>>
+  typename IndexType,
+  typename Hash,
+  typename KeyEqual,
+  typename Allocator
 >
 hashmap<TKey, TValue, IndexType, Hash, KeyEqual, Allocator>::hashmap(
   std::initializer_list<value_type> values
@@ -66,10 +69,10 @@ hashmap<TKey, TValue, IndexType, Hash, KeyEqual, Allocator>::hashmap(
 template <
   typename TKey,
   typename TValue,
-  typename IndexType = int,
-  typename Hash = hash_hashmap<pair<TKey, TValue>>,
-  typename KeyEqual = equal_to_hashmap<pair<TKey, TValue>>,
-  typename Allocator = allocator<pair<TKey, TValue>>
+  typename IndexType,
+  typename Hash,
+  typename KeyEqual,
+  typename Allocator
 >
 hashmap<TKey, TValue, IndexType, Hash, KeyEqual, Allocator>::hashmap(
   size_type reserve_size
@@ -86,33 +89,37 @@ hashmap<TKey, TValue, IndexType, Hash, KeyEqual, Allocator>::hashmap(
 template <
   typename TKey,
   typename TValue,
-  typename IndexType = int,
-  typename Hash = hash_hashmap<pair<TKey, TValue>>,
-  typename KeyEqual = equal_to_hashmap<pair<TKey, TValue>>,
-  typename Allocator = allocator<pair<TKey, TValue>>
+  typename IndexType,
+  typename Hash,
+  typename KeyEqual,
+  typename Allocator
 >
 hashmap<TKey, TValue, IndexType, Hash, KeyEqual, Allocator>&
 hashmap<TKey, TValue, IndexType, Hash, KeyEqual, Allocator>::operator=(
   const hashmap& other
   )
 {
-  return base_type::operator=(other);
+  base_type::operator=(other);
+
+  return *this;
 }
 
 template <
   typename TKey,
   typename TValue,
-  typename IndexType = int,
-  typename Hash = hash_hashmap<pair<TKey, TValue>>,
-  typename KeyEqual = equal_to_hashmap<pair<TKey, TValue>>,
-  typename Allocator = allocator<pair<TKey, TValue>>
+  typename IndexType,
+  typename Hash,
+  typename KeyEqual,
+  typename Allocator
 >
 hashmap<TKey, TValue, IndexType, Hash, KeyEqual, Allocator>&
 hashmap<TKey, TValue, IndexType, Hash, KeyEqual, Allocator>::operator=(
   hashmap&& other
   )
 {
-  return base_type::operator=(std::move(other));
+  base_type::operator=(std::move(other));
+
+  return *this;
 }
 
 //
@@ -122,10 +129,10 @@ hashmap<TKey, TValue, IndexType, Hash, KeyEqual, Allocator>::operator=(
 template <
   typename TKey,
   typename TValue,
-  typename IndexType = int,
-  typename Hash = hash_hashmap<pair<TKey, TValue>>,
-  typename KeyEqual = equal_to_hashmap<pair<TKey, TValue>>,
-  typename Allocator = allocator<pair<TKey, TValue>>
+  typename IndexType,
+  typename Hash,
+  typename KeyEqual,
+  typename Allocator
 >
 void
 hashmap<TKey, TValue, IndexType, Hash, KeyEqual, Allocator>::swap(
@@ -142,10 +149,10 @@ hashmap<TKey, TValue, IndexType, Hash, KeyEqual, Allocator>::swap(
 template <
   typename TKey,
   typename TValue,
-  typename IndexType = int,
-  typename Hash = hash_hashmap<pair<TKey, TValue>>,
-  typename KeyEqual = equal_to_hashmap<pair<TKey, TValue>>,
-  typename Allocator = allocator<pair<TKey, TValue>>
+  typename IndexType,
+  typename Hash,
+  typename KeyEqual,
+  typename Allocator
 >
 typename hashmap<TKey, TValue, IndexType, Hash, KeyEqual, Allocator>::mapped_type&
 hashmap<TKey, TValue, IndexType, Hash, KeyEqual, Allocator>::operator[](
@@ -158,10 +165,10 @@ hashmap<TKey, TValue, IndexType, Hash, KeyEqual, Allocator>::operator[](
 template <
   typename TKey,
   typename TValue,
-  typename IndexType = int,
-  typename Hash = hash_hashmap<pair<TKey, TValue>>,
-  typename KeyEqual = equal_to_hashmap<pair<TKey, TValue>>,
-  typename Allocator = allocator<pair<TKey, TValue>>
+  typename IndexType,
+  typename Hash,
+  typename KeyEqual,
+  typename Allocator
 >
 const typename hashmap<TKey, TValue, IndexType, Hash, KeyEqual, Allocator>::mapped_type&
 hashmap<TKey, TValue, IndexType, Hash, KeyEqual, Allocator>::operator[](
@@ -178,10 +185,10 @@ hashmap<TKey, TValue, IndexType, Hash, KeyEqual, Allocator>::operator[](
 template <
   typename TKey,
   typename TValue,
-  typename IndexType = int,
-  typename Hash = hash_hashmap<pair<TKey, TValue>>,
-  typename KeyEqual = equal_to_hashmap<pair<TKey, TValue>>,
-  typename Allocator = allocator<pair<TKey, TValue>>
+  typename IndexType,
+  typename Hash,
+  typename KeyEqual,
+  typename Allocator
 >
 bool
 hashmap<TKey, TValue, IndexType, Hash, KeyEqual, Allocator>::contains(
@@ -194,10 +201,10 @@ hashmap<TKey, TValue, IndexType, Hash, KeyEqual, Allocator>::contains(
 template <
   typename TKey,
   typename TValue,
-  typename IndexType = int,
-  typename Hash = hash_hashmap<pair<TKey, TValue>>,
-  typename KeyEqual = equal_to_hashmap<pair<TKey, TValue>>,
-  typename Allocator = allocator<pair<TKey, TValue>>
+  typename IndexType,
+  typename Hash,
+  typename KeyEqual,
+  typename Allocator
 >
 typename hashmap<TKey, TValue, IndexType, Hash, KeyEqual, Allocator>::iterator
 hashmap<TKey, TValue, IndexType, Hash, KeyEqual, Allocator>::find(
@@ -210,10 +217,10 @@ hashmap<TKey, TValue, IndexType, Hash, KeyEqual, Allocator>::find(
 template <
   typename TKey,
   typename TValue,
-  typename IndexType = int,
-  typename Hash = hash_hashmap<pair<TKey, TValue>>,
-  typename KeyEqual = equal_to_hashmap<pair<TKey, TValue>>,
-  typename Allocator = allocator<pair<TKey, TValue>>
+  typename IndexType,
+  typename Hash,
+  typename KeyEqual,
+  typename Allocator
 >
 typename hashmap<TKey, TValue, IndexType, Hash, KeyEqual, Allocator>::const_iterator
 hashmap<TKey, TValue, IndexType, Hash, KeyEqual, Allocator>::find(
@@ -230,10 +237,10 @@ hashmap<TKey, TValue, IndexType, Hash, KeyEqual, Allocator>::find(
 template <
   typename TKey,
   typename TValue,
-  typename IndexType = int,
-  typename Hash = hash_hashmap<pair<TKey, TValue>>,
-  typename KeyEqual = equal_to_hashmap<pair<TKey, TValue>>,
-  typename Allocator = allocator<pair<TKey, TValue>>
+  typename IndexType,
+  typename Hash,
+  typename KeyEqual,
+  typename Allocator
 >
 typename hashmap<TKey, TValue, IndexType, Hash, KeyEqual, Allocator>::iterator
 hashmap<TKey, TValue, IndexType, Hash, KeyEqual, Allocator>::insert(
@@ -247,10 +254,10 @@ hashmap<TKey, TValue, IndexType, Hash, KeyEqual, Allocator>::insert(
 template <
   typename TKey,
   typename TValue,
-  typename IndexType = int,
-  typename Hash = hash_hashmap<pair<TKey, TValue>>,
-  typename KeyEqual = equal_to_hashmap<pair<TKey, TValue>>,
-  typename Allocator = allocator<pair<TKey, TValue>>
+  typename IndexType,
+  typename Hash,
+  typename KeyEqual,
+  typename Allocator
 >
 typename hashmap<TKey, TValue, IndexType, Hash, KeyEqual, Allocator>::iterator
 hashmap<TKey, TValue, IndexType, Hash, KeyEqual, Allocator>::insert(
@@ -268,10 +275,10 @@ hashmap<TKey, TValue, IndexType, Hash, KeyEqual, Allocator>::insert(
 template <
   typename TKey,
   typename TValue,
-  typename IndexType = int,
-  typename Hash = hash_hashmap<pair<TKey, TValue>>,
-  typename KeyEqual = equal_to_hashmap<pair<TKey, TValue>>,
-  typename Allocator = allocator<pair<TKey, TValue>>
+  typename IndexType,
+  typename Hash,
+  typename KeyEqual,
+  typename Allocator
 >
 typename hashmap<TKey, TValue, IndexType, Hash, KeyEqual, Allocator>::iterator
 hashmap<TKey, TValue, IndexType, Hash, KeyEqual, Allocator>::find_or_insert(
@@ -121,6 +121,8 @@ hashset<T, IndexType, Hash, KeyEqual, Allocator>::operator=(
 {
   _node_list = other._node_list;
   _bucket_list = other._bucket_list;
+
+  return *this;
 }
 
 template <
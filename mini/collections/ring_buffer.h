@@ -0,0 +1,163 @@
+#pragma once
+#include <mini/allocator.h>
+#include <mini/byte_buffer_ref.h>
+
+#include <type_traits>
+
+namespace mini::collections {
+
+//
+// growable FIFO buffer of trivially copyable items.
+//
+// items are written at the tail and consumed from the head,
+// consuming never moves the remaining items.
+// the capacity is always a power of 2.
+//
+
+template <
+  typename T,
+  typename Allocator = allocator<T>
+>
+class ring_buffer
+{
+  MINI_MAKE_NONCOPYABLE(ring_buffer);
+
+  static_assert(
+    std::is_trivially_copyable_v<T>,
+    "ring_buffer supports only trivially copyable types");
+
+  public:
+    using value_type              = T;
+    using size_type = ::mini::size_type;
+    using difference_type         = pointer_difference_type;
+
+    using allocator_type          = Allocator;
+
+    static constexpr size_type min_capacity = 16;
+
+    //
+    // constructors.
+    //
+
+    ring_buffer(
+      void
+      );
+
+    ring_buffer(
+      ring_buffer&& other
+      );
+
+    ring_buffer(
+      size_type initial_capacity
+      );
+
+    //
+    // destructor.
+    //
+
+    ~ring_buffer(
+      void
+      );
+
+    //
+    // assign operators.
+    //
+
+    ring_buffer&
+    operator=(
+      ring_buffer&& other
+      );
+
+    //
+    // swap.
+    //
+
+    void
+    swap(
+      ring_buffer& other
+      );
+
+    //
+    // element access.
+    //
+
+    //
+    // returns the longest contiguous run of items
+    // starting at the head. the returned buffer
+    // is valid until the next write() or reserve().
+    //
+    buffer_ref<T>
+    get_front_buffer(
+      void
+      ) const;
+
+    //
+    // capacity.
+    //
+
+    bool
+    is_empty(
+      void
+      ) const;
+
+    size_type
+    get_size(
+      void
+      ) const;
+
+    size_type
+    get_capacity(
+      void
+      ) const;
+
+    void
+    reserve(
+      size_type new_capacity
+      );
+
+    //
+    // modifiers.
+    //
+
+    void
+    write(
+      const buffer_ref<T> items
+      );
+
+    size_type
+    read(
+      mutable_buffer_ref<T> items
+      );
+
+    size_type
+    peek(
+      mutable_buffer_ref<T> items
+      ) const;
+
+    size_type
+    discard(
+      size_type count
+      );
+
+    void
+    clear(
+      void
+      );
+
+  private:
+    size_type
+    get_mask(
+      void
+      ) const;
+
+    T* _buffer;
+    size_type _capacity;
+    size_type _head;
+    size_type _size;
+
+    Allocator _allocator;
+};
+
+}
+
+#include "ring_buffer.inl"
@@ -0,0 +1,327 @@
+#include "ring_buffer.h"
+
+#include <mini/common.h>
+#include <mini/memory.h>
+#include <mini/algorithm.h>
+
+namespace mini::collections {
+
+//
+// constructors.
+//
+
+template <
+  typename T,
+  typename Allocator
+>
+ring_buffer<T, Allocator>::ring_buffer(
+  void
+  )
+  : _buffer(nullptr)
+  , _capacity(0)
+  , _head(0)
+  , _size(0)
+{
+
+}
+
+template <
+  typename T,
+  typename Allocator
+>
+ring_buffer<T, Allocator>::ring_buffer(
+  ring_buffer&& other
+  )
+  : ring_buffer<T, Allocator>()
+{
+  swap(other);
+}
+
+template <
+  typename T,
+  typename Allocator
+>
+ring_buffer<T, Allocator>::ring_buffer(
+  size_type initial_capacity
+  )
+  : ring_buffer<T, Allocator>()
+{
+  reserve(initial_capacity);
+}
+
+//
+// destructor.
+//
+
+template <
+  typename T,
+  typename Allocator
+>
+ring_buffer<T, Allocator>::~ring_buffer(
+  void
+  )
+{
+  if (_buffer)
+  {
+    _allocator.deallocate(_buffer);
+  }
+}
+
+//
+// assign operators.
+//
+
+template <
+  typename T,
+  typename Allocator
+>
+ring_buffer<T, Allocator>&
+ring_buffer<T, Allocator>::operator=(
+  ring_buffer&& other
+  )
+{
+  swap(other);
+  return *this;
+}
+
+//
+// swap.
+//
+
+template <
+  typename T,
+  typename Allocator
+>
+void
+ring_buffer<T, Allocator>::swap(
+  ring_buffer& other
+  )
+{
+  mini::swap(_buffer, other._buffer);
+  mini::swap(_capacity, other._capacity);
+  mini::swap(_head, other._head);
+  mini::swap(_size, other._size);
+}
+
+//
+// element access.
+//
+
+template <
+  typename T,
+  typename Allocator
+>
+buffer_ref<T>
+ring_buffer<T, Allocator>::get_front_buffer(
+  void
+  ) const
+{
+  const size_type contiguous_size = algorithm::min(_size, _capacity - _head);
+
+  return buffer_ref<T>(
+    _buffer + _head,
+    _buffer + _head + contiguous_size);
+}
+
+//
+// capacity.
+//
+
+template <
+  typename T,
+  typename Allocator
+>
+bool
+ring_buffer<T, Allocator>::is_empty(
+  void
+  ) const
+{
+  return _size == 0;
+}
+
+template <
+  typename T,
+  typename Allocator
+>
+typename ring_buffer<T, Allocator>::size_type
+ring_buffer<T, Allocator>::get_size(
+  void
+  ) const
+{
+  return _size;
+}
+
+template <
+  typename T,
+  typename Allocator
+>
+typename ring_buffer<T, Allocator>::size_type
+ring_buffer<T, Allocator>::get_capacity(
+  void
+  ) const
+{
+  return _capacity;
+}
+
+template <
+  typename T,
+  typename Allocator
+>
+void
+ring_buffer<T, Allocator>::reserve(
+  size_type new_capacity
+  )
+{
+  if (new_capacity <= _capacity)
+  {
+    return;
+  }
+
+  size_type capacity = algorithm::max(_capacity, min_capacity);
+  while (capacity < new_capacity)
+  {
+    capacity *= 2;
+  }
+
+  //
+  // linearize the content into the new buffer,
+  // so the head starts at the index 0.
+  //
+  T* new_buffer = _allocator.allocate(capacity);
+  peek(mutable_buffer_ref<T>(new_buffer, new_buffer + _size));
+
+  if (_buffer)
+  {
+    _allocator.deallocate(_buffer);
+  }
+
+  _buffer = new_buffer;
+  _capacity = capacity;
+  _head = 0;
+}
+
+//
+// modifiers.
+//
+
+template <
+  typename T,
+  typename Allocator
+>
+void
+ring_buffer<T, Allocator>::write(
+  const buffer_ref<T> items
+  )
+{
+  const size_type count = items.get_size();
+
+  if (count == 0)
+  {
+    return;
+  }
+
+  reserve(_size + count);
+
+  //
+  // the free space may wrap around the end of the buffer,
+  // in which case the items are written in 2 parts.
+  //
+  const size_type tail = (_head + _size) & get_mask();
+  const size_type first_part_size = algorithm::min(count, _capacity - tail);
+
+  memory::copy(_buffer + tail, items.get_buffer(), first_part_size * sizeof(T));
+  memory::copy(_buffer, items.get_buffer() + first_part_size, (count - first_part_size) * sizeof(T));
+
+  _size += count;
+}
+
+template <
+  typename T,
+  typename Allocator
+>
+typename ring_buffer<T, Allocator>::size_type
+ring_buffer<T, Allocator>::read(
+  mutable_buffer_ref<T> items
+  )
+{
+  return discard(peek(items));
+}
+
+template <
+  typename T,
+  typename Allocator
+>
+typename ring_buffer<T, Allocator>::size_type
+ring_buffer<T, Allocator>::peek(
+  mutable_buffer_ref<T> items
+  ) const
+{
+  const size_type count = algorithm::min(items.get_size(), _size);
+
+  if (count == 0)
+  {
+    return 0;
+  }
+
+  const size_type first_part_size = algorithm::min(count, _capacity - _head);
+
+  memory::copy(items.get_buffer(), _buffer + _head, first_part_size * sizeof(T));
+  memory::copy(items.get_buffer() + first_part_size, _buffer, (count - first_part_size) * sizeof(T));
+
+  return count;
+}
+
+template <
+  typename T,
+  typename Allocator
+>
+typename ring_buffer<T, Allocator>::size_type
+ring_buffer<T, Allocator>::discard(
+  size_type count
+  )
+{
+  count = algorithm::min(count, _size);
+
+  _size -= count;
+
+  //
+  // rewind the head when the buffer is empty,
+  // so the next writes stay contiguous.
+  //
+  _head = _size
+    ? (_head + count) & get_mask()
+    : 0;
+
+  return count;
+}
+
+template <
+  typename T,
+  typename Allocator
+>
+void
+ring_buffer<T, Allocator>::clear(
+  void
+  )
+{
+  _head = 0;
+  _size = 0;
+}
+
+//
+// private methods.
+//
+
+template <
+  typename T,
+  typename Allocator
+>
+typename ring_buffer<T, Allocator>::size_type
+ring_buffer<T, Allocator>::get_mask(
+  void
+  ) const
+{
+  return _capacity - 1;
+}
+
+}
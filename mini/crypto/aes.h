@@ -2,6 +2,9 @@
 #include "common.h"
 #include "capi/aes.h"
 #include "cng/aes.h"
+#ifndef MINI_OS_WINDOWS
+#include "openssl/aes.h"
+#endif
 
 namespace mini::crypto {
 
@@ -1,5 +1,8 @@
 #include "aes.h"
 
+#include <mini/algorithm.h>
+#include <mini/memory.h>
+
 //
 // inspired by:
 //   - https://github.com/t6x/reaver-wps-fork-t6x/blob/master/src/crypto/crypto_cryptoapi.c
@@ -191,7 +194,7 @@ aes<AES_MODE, KEY_SIZE>::encrypt_inplace(
   mutable_byte_buffer_ref buffer
   )
 {
-  DWORD buffer_size = key_size_in_bytes;
+  DWORD buffer_size = static_cast<DWORD>(buffer.get_size());
   CryptEncrypt(
     _key.get_handle(),
     0,
@@ -199,7 +202,7 @@ aes<AES_MODE, KEY_SIZE>::encrypt_inplace(
     0,
     buffer.get_buffer(),
     &buffer_size,
-    key_size_in_bytes);
+    static_cast<DWORD>(buffer.get_size()));
 }
 
 template <
@@ -242,7 +245,7 @@ aes<AES_MODE, KEY_SIZE>::decrypt_inplace(
   mutable_byte_buffer_ref buffer
   )
 {
-  DWORD buffer_size = key_size_in_bytes;
+  DWORD buffer_size = static_cast<DWORD>(buffer.get_size());
   CryptDecrypt(
     _key.get_handle(),
     0,
@@ -250,7 +253,7 @@ aes<AES_MODE, KEY_SIZE>::decrypt_inplace(
     0,
     buffer.get_buffer(),
     &buffer_size,
-    key_size_in_bytes);
+    static_cast<DWORD>(buffer.get_size()));
 }
 
 template <
@@ -307,9 +310,9 @@ aes<cipher_mode::ctr, KEY_SIZE>::init(
   )
 {
   memory::zero(_counter);
-  memory::zero(_counter_out);
+  memory::zero(_keystream);
 
-  _keystream_pointer = 0xFFFF;
+  _keystream_pointer = keystream_size;
 
   base_type::init(std::move(reinterpret_cast<aes_key<cipher_mode::ecb, KEY_SIZE>&>(k)));
 }
@@ -322,9 +325,27 @@ aes<cipher_mode::ctr, KEY_SIZE>::encrypt_inplace(
   mutable_byte_buffer_ref buffer
   )
 {
-  for (byte_type& byte : buffer)
+  byte_type* data = buffer.get_buffer();
+  size_type bytes_remaining = buffer.get_size();
+
+  while (bytes_remaining > 0)
   {
-    byte ^= next_keystream_byte();
+    if (_keystream_pointer == keystream_size)
+    {
+      update_keystream();
+    }
+
+    //
+    // the partially consumed keystream is used first,
+    // so the offset is kept across the calls.
+    //
+    const size_type bytes_processed = algorithm::min(bytes_remaining, keystream_size - _keystream_pointer);
+
+    memory::exclusive_or(data, &_keystream[_keystream_pointer], bytes_processed);
+
+    data += bytes_processed;
+    bytes_remaining -= bytes_processed;
+    _keystream_pointer += bytes_processed;
   }
 }
 
@@ -406,43 +427,21 @@ aes<cipher_mode::ctr, KEY_SIZE>::crypt(
 template <
   size_type KEY_SIZE
 >
-byte_type
-aes<cipher_mode::ctr, KEY_SIZE>::next_keystream_byte(
+void
+aes<cipher_mode::ctr, KEY_SIZE>::update_keystream(
   void
   )
 {
-  if (_keystream_pointer >= key_size_in_bytes)
+  for (size_type offset = 0; offset < keystream_size; offset += block_size_in_bytes)
   {
-    update_counter();
+    memory::copy(&_keystream[offset], _counter.get_buffer(), block_size_in_bytes);
+    increment_counter();
   }
 
-  return _counter_out[_keystream_pointer++];
-}
-
-template <
-  size_type KEY_SIZE
->
-void
-aes<cipher_mode::ctr, KEY_SIZE>::update_counter(
-  void
-  )
-{
-  encrypt_counter();
-  increment_counter();
+  base_type::encrypt_inplace(_keystream);
   _keystream_pointer = 0;
 }
 
-template <
-  size_type KEY_SIZE
->
-void
-aes<cipher_mode::ctr, KEY_SIZE>::encrypt_counter(
-  void
-  )
-{
-  base_type::encrypt(_counter, _counter_out);
-}
-
 template <
   size_type KEY_SIZE
 >
@@ -451,7 +450,7 @@ aes<cipher_mode::ctr, KEY_SIZE>::increment_counter(
   void
   )
 {
-  for (int i = static_cast<int>(key_size_in_bytes) - 1; i >= 0; i--)
+  for (int i = static_cast<int>(block_size_in_bytes) - 1; i >= 0; i--)
   {
     if (++_counter[i])
     {
@@ -81,6 +81,11 @@ base64::decode(
   output.resize(output_size);
   decode_impl(input.get_buffer(), input.get_size(), output.get_buffer(), output_size);
 
+  //
+  // the first call returns only the upper bound.
+  //
+  output.resize(output_size);
+
   return output;
 }
 
@@ -11,8 +11,10 @@
 
 // Définitions des constantes équivalentes à celles de Windows
 #define CRYPT_STRING_BASE64 0x00000001
+#define CRYPT_STRING_BASE64_ANY 0x00000006
 #define CRYPT_STRING_HEXRAW 0x00000004
 #define CRYPT_STRING_HEXASCIIADDR 0x00000008
+#define CRYPT_STRING_NOCRLF 0x40000000
 #endif
 
 namespace mini::crypto::capi::detail {
@@ -39,6 +41,11 @@ base_encode_impl(
     output,
     reinterpret_cast<DWORD*>(&output_size));
 #else
+  //
+  // the output is never split into lines.
+  //
+  flags &= ~CRYPT_STRING_NOCRLF;
+
   if (!output)
   {
     // Calculer la taille nécessaire
@@ -121,13 +128,40 @@ base_decode_impl(
     NULL,
     NULL);
 #else
+  //
+  // CRYPT_STRING_BASE64_ANY accepts the input
+  // with the "-----BEGIN ...-----" header as well.
+  //
+  if (flags == CRYPT_STRING_BASE64_ANY)
+  {
+    if (input_size > 5 && memcmp(input, "-----", 5) == 0)
+    {
+      const char* header_end = static_cast<const char*>(memchr(input, '\n', input_size));
+      const size_type header_size = header_end ? header_end - input + 1 : input_size;
+
+      input += header_size;
+      input_size -= header_size;
+
+      for (size_type i = 0; i + 5 <= input_size; i++)
+      {
+        if (memcmp(input + i, "-----", 5) == 0)
+        {
+          input_size = i;
+          break;
+        }
+      }
+    }
+
+    flags = CRYPT_STRING_BASE64;
+  }
+
   if (!output)
   {
     // Calculer la taille nécessaire
     if (flags == CRYPT_STRING_BASE64)
     {
-      // Base64: 3 octets pour 4 caractères
-      output_size = (input_size / 4) * 3;
+      // Base64: 3 octets pour 4 caractères (au plus)
+      output_size = ((input_size + 3) / 4) * 3;
     }
     else if (flags == CRYPT_STRING_HEXRAW || flags == CRYPT_STRING_HEXASCIIADDR)
     {
@@ -143,16 +177,38 @@ base_decode_impl(
 
   if (flags == CRYPT_STRING_BASE64)
   {
-    BIO *bio, *b64;
-    
-    b64 = BIO_new(BIO_f_base64());
-    bio = BIO_new_mem_buf(input, input_size);
-    bio = BIO_push(b64, bio);
-    
-    BIO_set_flags(bio, BIO_FLAGS_BASE64_NO_NL);
-    output_size = BIO_read(bio, output, input_size);
-    
-    BIO_free_all(bio);
+    //
+    // the padding is optional (tor omits it)
+    // and the whitespace is skipped.
+    //
+    uint32_t accumulator = 0;
+    int accumulator_bits = 0;
+    size_type j = 0;
+
+    for (size_type i = 0; i < input_size; i++)
+    {
+      const char c = input[i];
+      int value;
+
+      if      (c >= 'A' && c <= 'Z') value = c - 'A';
+      else if (c >= 'a' && c <= 'z') value = c - 'a' + 26;
+      else if (c >= '0' && c <= '9') value = c - '0' + 52;
+      else if (c == '+')             value = 62;
+      else if (c == '/')             value = 63;
+      else if (c == '=')             break;
+      else                           continue;
+
+      accumulator = (accumulator << 6) | value;
+      accumulator_bits += 6;
+
+      if (accumulator_bits >= 8)
+      {
+        accumulator_bits -= 8;
+        output[j++] = static_cast<byte_type>(accumulator >> accumulator_bits);
+      }
+    }
+
+    output_size = j;
   }
   else if (flags == CRYPT_STRING_HEXRAW || flags == CRYPT_STRING_HEXASCIIADDR)
   {
@@ -281,18 +281,18 @@ class aes<cipher_mode::ctr, KEY_SIZE>
       );
 
   private:
-    byte_type
-    next_keystream_byte(
-      void
-      );
+    static constexpr size_type block_size_in_bytes = 16;
 
-    void
-    update_counter(
-      void
-      );
+    //
+    // the keystream is generated for this many counter
+    // blocks by a single ecb encryption, so a relay cell
+    // (509 bytes) costs one call to the block cipher.
+    //
+    static constexpr size_type keystream_block_count = 32;
+    static constexpr size_type keystream_size        = keystream_block_count * block_size_in_bytes;
 
     void
-    encrypt_counter(
+    update_keystream(
       void
       );
 
@@ -301,8 +301,8 @@ class aes<cipher_mode::ctr, KEY_SIZE>
       void
       );
 
-    stack_byte_buffer<key_size_in_bytes> _counter;
-    stack_byte_buffer<key_size_in_bytes> _counter_out;
+    stack_byte_buffer<block_size_in_bytes> _counter;
+    stack_byte_buffer<keystream_size> _keystream;
     size_type _keystream_pointer;
 };
 
@@ -6,6 +6,7 @@
 // in [] is noted which namespaces are currently supported.w
 //
 // unless stated otherwise, capi & cng are supported on win7+.
+// openssl is supported (and used by default) on the other platforms.
 //
 
 //
@@ -27,22 +28,38 @@
 // symmetric crypto
 //
 #ifndef MINI_CRYPTO_AES_NAMESPACE
+#ifdef MINI_OS_WINDOWS
 #define MINI_CRYPTO_AES_NAMESPACE         cng   // [capi, cng]
+#else
+#define MINI_CRYPTO_AES_NAMESPACE         openssl
+#endif
 #endif
 
 //
 // asymmetric crypto
 //
 #ifndef MINI_CRYPTO_CURVE25519_NAMESPACE
+#ifdef MINI_OS_WINDOWS
 #define MINI_CRYPTO_CURVE25519_NAMESPACE  cng   // [cng(win10+), ext]
+#else
+#define MINI_CRYPTO_CURVE25519_NAMESPACE  openssl
+#endif
 #endif
 
 #ifndef MINI_CRYPTO_DH_NAMESPACE
+#ifdef MINI_OS_WINDOWS
 #define MINI_CRYPTO_DH_NAMESPACE          cng   // [capi, cng(win8.1+)]
+#else
+#define MINI_CRYPTO_DH_NAMESPACE          openssl
+#endif
 #endif
 
 #ifndef MINI_CRYPTO_RSA_NAMESPACE
+#ifdef MINI_OS_WINDOWS
 #define MINI_CRYPTO_RSA_NAMESPACE         cng   // [capi, cng]
+#else
+#define MINI_CRYPTO_RSA_NAMESPACE         openssl
+#endif
 #endif
 
 //
@@ -52,7 +69,7 @@
 #ifdef MINI_OS_WINDOWS
 #define MINI_CRYPTO_HASH_NAMESPACE        cng   // [capi, cng]
 #else
-#define MINI_CRYPTO_HASH_NAMESPACE        capi   // [capi, cng]
+#define MINI_CRYPTO_HASH_NAMESPACE        openssl
 #endif
 #endif
 
@@ -60,7 +77,7 @@
 #ifdef MINI_OS_WINDOWS
 #define MINI_CRYPTO_HMAC_NAMESPACE        cng   // [capi, cng]
 #else
-#define MINI_CRYPTO_HMAC_NAMESPACE        capi   // [capi, cng]
+#define MINI_CRYPTO_HMAC_NAMESPACE        openssl
 #endif
 #endif
 
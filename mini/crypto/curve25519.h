@@ -2,6 +2,9 @@
 #include "common.h"
 #include "cng/curve25519.h"
 #include "ext/curve25519.h"
+#ifndef MINI_OS_WINDOWS
+#include "openssl/curve25519.h"
+#endif
 
 namespace mini::crypto {
 
@@ -2,6 +2,9 @@
 #include "common.h"
 #include "capi/dh.h"
 #include "cng/dh.h"
+#ifndef MINI_OS_WINDOWS
+#include "openssl/dh.h"
+#endif
 
 namespace mini::crypto {
 
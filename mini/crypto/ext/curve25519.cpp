@@ -1,11 +1,31 @@
 #include "curve25519.h"
 #include "detail/curve25519-donna.h"
+#include "detail/curve25519-radix51.h"
 #include "../random.h"
 
 namespace mini::crypto::ext {
 
 static const uint8_t basepoint_9[32] = { 9 };
 
+//
+// the radix 2^51 implementation is used on the 64-bit
+// targets with the 64x64->128 bit multiplication,
+// curve25519-donna (radix 2^25.5) elsewhere.
+//
+static void
+scalar_mult(
+  uint8_t* mypublic,
+  const uint8_t* secret,
+  const uint8_t* basepoint
+  )
+{
+#if defined(MINI_CURVE25519_HAS_RADIX51)
+  detail::curve25519_radix51(mypublic, secret, basepoint);
+#else
+  detail::curve25519_donna(mypublic, secret, basepoint);
+#endif
+}
+
 //
 // curve25519
 // public key.
@@ -127,7 +147,7 @@ curve25519_private_key::import(
   )
 {
   memory::copy(_blob.d, key.get_buffer(), key_size_in_bytes);
-  detail::curve25519_donna(_blob.X, _blob.d, basepoint_9);
+  scalar_mult(_blob.X, _blob.d, basepoint_9);
 }
 
 //
@@ -140,7 +160,7 @@ curve25519_private_key::export_public_key(
   ) const
 {
   curve25519_public_key result;
-  detail::curve25519_donna(result._blob.X, _blob.d, basepoint_9);
+  scalar_mult(result._blob.X, _blob.d, basepoint_9);
   return result;
 }
 
@@ -170,7 +190,7 @@ curve25519_private_key::get_shared_secret(
   ) const
 {
   byte_buffer result(key_size_in_bytes);
-  detail::curve25519_donna(&result[0], _blob.d, other_public_key._blob.X);
+  scalar_mult(&result[0], _blob.d, other_public_key._blob.X);
   return result;
 }
 
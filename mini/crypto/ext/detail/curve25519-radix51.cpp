@@ -0,0 +1,567 @@
+#include "curve25519-radix51.h"
+
+#if defined(MINI_CURVE25519_HAS_RADIX51)
+
+#if !defined(__SIZEOF_INT128__)
+# include <intrin.h>
+#endif
+
+namespace mini::crypto::ext::detail {
+
+//
+// the field element is
+//   f[0] + 2^51 * f[1] + 2^102 * f[2] + 2^153 * f[3] + 2^204 * f[4]
+//
+// the "reduced" elements (outputs of the multiplication)
+// have limbs below 2^51 + 2^13. the inputs of the multiplication
+// must have limbs below 2^53, so the 128-bit accumulators
+// and the 64-bit carries can't overflow.
+//
+
+using fe = uint64_t[5];
+
+static constexpr uint64_t mask51 = (uint64_t(1) << 51) - 1;
+
+//
+// 128-bit accumulator.
+//
+
+#if defined(__SIZEOF_INT128__)
+
+using uint128 = unsigned __int128;
+
+static inline uint128
+mul64(
+  uint64_t a,
+  uint64_t b
+  )
+{
+  return static_cast<uint128>(a) * b;
+}
+
+static inline uint128
+add128(
+  uint128 a,
+  uint128 b
+  )
+{
+  return a + b;
+}
+
+static inline uint128
+add128(
+  uint128 a,
+  uint64_t b
+  )
+{
+  return a + b;
+}
+
+static inline uint64_t
+lo51(
+  uint128 a
+  )
+{
+  return static_cast<uint64_t>(a) & mask51;
+}
+
+static inline uint64_t
+shr51(
+  uint128 a
+  )
+{
+  return static_cast<uint64_t>(a >> 51);
+}
+
+#else
+
+struct uint128
+{
+  uint64_t lo;
+  uint64_t hi;
+};
+
+static inline uint128
+mul64(
+  uint64_t a,
+  uint64_t b
+  )
+{
+  uint128 result;
+  result.lo = _umul128(a, b, &result.hi);
+  return result;
+}
+
+static inline uint128
+add128(
+  uint128 a,
+  uint128 b
+  )
+{
+  uint128 result;
+  const unsigned char carry = _addcarry_u64(0, a.lo, b.lo, &result.lo);
+  _addcarry_u64(carry, a.hi, b.hi, &result.hi);
+  return result;
+}
+
+static inline uint128
+add128(
+  uint128 a,
+  uint64_t b
+  )
+{
+  uint128 result;
+  const unsigned char carry = _addcarry_u64(0, a.lo, b, &result.lo);
+  _addcarry_u64(carry, a.hi, 0, &result.hi);
+  return result;
+}
+
+static inline uint64_t
+lo51(
+  uint128 a
+  )
+{
+  return a.lo & mask51;
+}
+
+static inline uint64_t
+shr51(
+  uint128 a
+  )
+{
+  return __shiftright128(a.lo, a.hi, 51);
+}
+
+#endif
+
+//
+// field arithmetic.
+//
+
+static inline void
+fe_copy(
+  fe out,
+  const fe in
+  )
+{
+  for (int i = 0; i < 5; i++)
+  {
+    out[i] = in[i];
+  }
+}
+
+static inline void
+fe_add(
+  fe out,
+  const fe a,
+  const fe b
+  )
+{
+  for (int i = 0; i < 5; i++)
+  {
+    out[i] = a[i] + b[i];
+  }
+}
+
+//
+// out = a - b + 2p, the b must be reduced.
+//
+static inline void
+fe_sub(
+  fe out,
+  const fe a,
+  const fe b
+  )
+{
+  static constexpr uint64_t two_p0   = 0xfffffffffffdaull;
+  static constexpr uint64_t two_p1_4 = 0xffffffffffffeull;
+
+  out[0] = a[0] + two_p0   - b[0];
+  out[1] = a[1] + two_p1_4 - b[1];
+  out[2] = a[2] + two_p1_4 - b[2];
+  out[3] = a[3] + two_p1_4 - b[3];
+  out[4] = a[4] + two_p1_4 - b[4];
+}
+
+static inline void
+fe_carry(
+  fe out,
+  uint128 t0,
+  uint128 t1,
+  uint128 t2,
+  uint128 t3,
+  uint128 t4
+  )
+{
+  uint64_t r0, r1, r2, r3, r4;
+
+               r0 = lo51(t0);
+  t1 = add128(t1, shr51(t0)); r1 = lo51(t1);
+  t2 = add128(t2, shr51(t1)); r2 = lo51(t2);
+  t3 = add128(t3, shr51(t2)); r3 = lo51(t3);
+  t4 = add128(t4, shr51(t3)); r4 = lo51(t4);
+
+  r0 += shr51(t4) * 19;
+  r1 += r0 >> 51;
+  r0 &= mask51;
+
+  out[0] = r0;
+  out[1] = r1;
+  out[2] = r2;
+  out[3] = r3;
+  out[4] = r4;
+}
+
+static void
+fe_mul(
+  fe out,
+  const fe a,
+  const fe b
+  )
+{
+  const uint64_t a0 = a[0], a1 = a[1], a2 = a[2], a3 = a[3], a4 = a[4];
+  const uint64_t b0 = b[0], b1 = b[1], b2 = b[2], b3 = b[3], b4 = b[4];
+
+  const uint64_t b1_19 = b1 * 19;
+  const uint64_t b2_19 = b2 * 19;
+  const uint64_t b3_19 = b3 * 19;
+  const uint64_t b4_19 = b4 * 19;
+
+  uint128 t0 = mul64(a0, b0);
+  t0 = add128(t0, mul64(a1, b4_19));
+  t0 = add128(t0, mul64(a2, b3_19));
+  t0 = add128(t0, mul64(a3, b2_19));
+  t0 = add128(t0, mul64(a4, b1_19));
+
+  uint128 t1 = mul64(a0, b1);
+  t1 = add128(t1, mul64(a1, b0));
+  t1 = add128(t1, mul64(a2, b4_19));
+  t1 = add128(t1, mul64(a3, b3_19));
+  t1 = add128(t1, mul64(a4, b2_19));
+
+  uint128 t2 = mul64(a0, b2);
+  t2 = add128(t2, mul64(a1, b1));
+  t2 = add128(t2, mul64(a2, b0));
+  t2 = add128(t2, mul64(a3, b4_19));
+  t2 = add128(t2, mul64(a4, b3_19));
+
+  uint128 t3 = mul64(a0, b3);
+  t3 = add128(t3, mul64(a1, b2));
+  t3 = add128(t3, mul64(a2, b1));
+  t3 = add128(t3, mul64(a3, b0));
+  t3 = add128(t3, mul64(a4, b4_19));
+
+  uint128 t4 = mul64(a0, b4);
+  t4 = add128(t4, mul64(a1, b3));
+  t4 = add128(t4, mul64(a2, b2));
+  t4 = add128(t4, mul64(a3, b1));
+  t4 = add128(t4, mul64(a4, b0));
+
+  fe_carry(out, t0, t1, t2, t3, t4);
+}
+
+static void
+fe_square(
+  fe out,
+  const fe a
+  )
+{
+  const uint64_t a0 = a[0], a1 = a[1], a2 = a[2], a3 = a[3], a4 = a[4];
+
+  const uint64_t a0_2  = a0 * 2;
+  const uint64_t a1_2  = a1 * 2;
+  const uint64_t a2_2  = a2 * 2;
+  const uint64_t a3_2  = a3 * 2;
+  const uint64_t a3_19 = a3 * 19;
+  const uint64_t a4_19 = a4 * 19;
+
+  uint128 t0 = mul64(a0, a0);
+  t0 = add128(t0, mul64(a1_2, a4_19));
+  t0 = add128(t0, mul64(a2_2, a3_19));
+
+  uint128 t1 = mul64(a0_2, a1);
+  t1 = add128(t1, mul64(a2_2, a4_19));
+  t1 = add128(t1, mul64(a3, a3_19));
+
+  uint128 t2 = mul64(a0_2, a2);
+  t2 = add128(t2, mul64(a1, a1));
+  t2 = add128(t2, mul64(a3_2, a4_19));
+
+  uint128 t3 = mul64(a0_2, a3);
+  t3 = add128(t3, mul64(a1_2, a2));
+  t3 = add128(t3, mul64(a4, a4_19));
+
+  uint128 t4 = mul64(a0_2, a4);
+  t4 = add128(t4, mul64(a1_2, a3));
+  t4 = add128(t4, mul64(a2, a2));
+
+  fe_carry(out, t0, t1, t2, t3, t4);
+}
+
+static void
+fe_square_times(
+  fe out,
+  const fe a,
+  int count
+  )
+{
+  fe_square(out, a);
+
+  for (int i = 1; i < count; i++)
+  {
+    fe_square(out, out);
+  }
+}
+
+static void
+fe_mul_scalar(
+  fe out,
+  const fe a,
+  uint64_t scalar
+  )
+{
+  fe_carry(
+    out,
+    mul64(a[0], scalar),
+    mul64(a[1], scalar),
+    mul64(a[2], scalar),
+    mul64(a[3], scalar),
+    mul64(a[4], scalar));
+}
+
+//
+// out = z^(p - 2) = z^(2^255 - 21)
+//
+static void
+fe_invert(
+  fe out,
+  const fe z
+  )
+{
+  fe t0, t1, t2, t3;
+
+  fe_square(t0, z);                 // 2
+  fe_square_times(t1, t0, 2);       // 8
+  fe_mul(t1, t1, z);                // 9
+  fe_mul(t0, t0, t1);               // 11
+  fe_square(t2, t0);                // 22
+  fe_mul(t1, t1, t2);               // 2^5 - 1
+  fe_square_times(t2, t1, 5);
+  fe_mul(t1, t2, t1);               // 2^10 - 1
+  fe_square_times(t2, t1, 10);
+  fe_mul(t2, t2, t1);               // 2^20 - 1
+  fe_square_times(t3, t2, 20);
+  fe_mul(t2, t3, t2);               // 2^40 - 1
+  fe_square_times(t2, t2, 10);
+  fe_mul(t1, t2, t1);               // 2^50 - 1
+  fe_square_times(t2, t1, 50);
+  fe_mul(t2, t2, t1);               // 2^100 - 1
+  fe_square_times(t3, t2, 100);
+  fe_mul(t2, t3, t2);               // 2^200 - 1
+  fe_square_times(t2, t2, 50);
+  fe_mul(t1, t2, t1);               // 2^250 - 1
+  fe_square_times(t1, t1, 5);       // 2^255 - 2^5
+  fe_mul(out, t1, t0);              // 2^255 - 21
+}
+
+//
+// swaps a and b if swap is 1, in constant time.
+//
+static inline void
+fe_cswap(
+  fe a,
+  fe b,
+  uint64_t swap
+  )
+{
+  const uint64_t mask = 0 - swap;
+
+  for (int i = 0; i < 5; i++)
+  {
+    const uint64_t x = mask & (a[i] ^ b[i]);
+    a[i] ^= x;
+    b[i] ^= x;
+  }
+}
+
+static inline uint64_t
+load64_le(
+  const uint8_t* p
+  )
+{
+  uint64_t result = 0;
+
+  for (int i = 7; i >= 0; i--)
+  {
+    result = (result << 8) | p[i];
+  }
+
+  return result;
+}
+
+//
+// the most significant bit of the u-coordinate
+// is ignored (rfc7748, section 5).
+//
+static void
+fe_expand(
+  fe out,
+  const uint8_t* in
+  )
+{
+  const uint64_t x0 = load64_le(in +  0);
+  const uint64_t x1 = load64_le(in +  8);
+  const uint64_t x2 = load64_le(in + 16);
+  const uint64_t x3 = load64_le(in + 24);
+
+  out[0] =   x0                      & mask51;
+  out[1] = ((x0 >> 51) | (x1 << 13)) & mask51;
+  out[2] = ((x1 >> 38) | (x2 << 26)) & mask51;
+  out[3] = ((x2 >> 25) | (x3 << 39)) & mask51;
+  out[4] =  (x3 >> 12)               & mask51;
+}
+
+static inline void
+fe_carry_chain(
+  uint64_t t[5]
+  )
+{
+  t[1] += t[0] >> 51; t[0] &= mask51;
+  t[2] += t[1] >> 51; t[1] &= mask51;
+  t[3] += t[2] >> 51; t[2] &= mask51;
+  t[4] += t[3] >> 51; t[3] &= mask51;
+}
+
+//
+// fully reduces the element modulo p
+// and stores it as 32 little-endian bytes.
+//
+static void
+fe_contract(
+  uint8_t* out,
+  const fe in
+  )
+{
+  uint64_t t[5];
+  fe_copy(t, in);
+
+  fe_carry_chain(t);
+  t[0] += 19 * (t[4] >> 51); t[4] &= mask51;
+  fe_carry_chain(t);
+  t[0] += 19 * (t[4] >> 51); t[4] &= mask51;
+
+  //
+  // t is in <0, 2^255 - 1>,
+  // adding 19 moves the values >= p over 2^255.
+  //
+  t[0] += 19;
+  fe_carry_chain(t);
+  t[0] += 19 * (t[4] >> 51); t[4] &= mask51;
+
+  //
+  // t is in <19, 2^255 - 1> (offset by 19),
+  // add 2^255 - 19 and drop the 2^255.
+  //
+  t[0] += (uint64_t(1) << 51) - 19;
+  t[1] += (uint64_t(1) << 51) - 1;
+  t[2] += (uint64_t(1) << 51) - 1;
+  t[3] += (uint64_t(1) << 51) - 1;
+  t[4] += (uint64_t(1) << 51) - 1;
+  fe_carry_chain(t);
+  t[4] &= mask51;
+
+  const uint64_t x0 =  t[0]        | (t[1] << 51);
+  const uint64_t x1 = (t[1] >> 13) | (t[2] << 38);
+  const uint64_t x2 = (t[2] >> 26) | (t[3] << 25);
+  const uint64_t x3 = (t[3] >> 39) | (t[4] << 12);
+
+  const uint64_t words[] = { x0, x1, x2, x3 };
+
+  for (int i = 0; i < 4; i++)
+  {
+    for (int j = 0; j < 8; j++)
+    {
+      out[i * 8 + j] = static_cast<uint8_t>(words[i] >> (j * 8));
+    }
+  }
+}
+
+//
+// rfc7748
+// 5. The X25519 and X448 Functions
+//
+
+void
+curve25519_radix51(
+  uint8_t* mypublic,
+  const uint8_t* secret,
+  const uint8_t* basepoint
+  )
+{
+  uint8_t e[32];
+
+  for (int i = 0; i < 32; i++)
+  {
+    e[i] = secret[i];
+  }
+
+  e[0]  &= 248;
+  e[31] &= 127;
+  e[31] |= 64;
+
+  fe x1;
+  fe_expand(x1, basepoint);
+
+  fe x2 = { 1 };
+  fe z2 = { 0 };
+  fe x3;
+  fe z3 = { 1 };
+  fe_copy(x3, x1);
+
+  fe a, aa, b, bb, c, d, da, cb, ee, t;
+  uint64_t swap = 0;
+
+  for (int pos = 254; pos >= 0; pos--)
+  {
+    const uint64_t bit = (e[pos / 8] >> (pos & 7)) & 1;
+
+    swap ^= bit;
+    fe_cswap(x2, x3, swap);
+    fe_cswap(z2, z3, swap);
+    swap = bit;
+
+    fe_add(a, x2, z2);
+    fe_square(aa, a);
+    fe_sub(b, x2, z2);
+    fe_square(bb, b);
+    fe_sub(ee, aa, bb);
+    fe_add(c, x3, z3);
+    fe_sub(d, x3, z3);
+    fe_mul(da, d, a);
+    fe_mul(cb, c, b);
+
+    fe_add(t, da, cb);
+    fe_square(x3, t);
+
+    fe_sub(t, da, cb);
+    fe_square(t, t);
+    fe_mul(z3, x1, t);
+
+    fe_mul(x2, aa, bb);
+
+    fe_mul_scalar(t, ee, 121665);
+    fe_add(t, aa, t);
+    fe_mul(z2, ee, t);
+  }
+
+  fe_cswap(x2, x3, swap);
+  fe_cswap(z2, z3, swap);
+
+  fe_invert(z2, z2);
+  fe_mul(x2, x2, z2);
+  fe_contract(mypublic, x2);
+}
+
+}
+
+#endif
@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdint>
+
+//
+// the radix 2^51 field arithmetic needs
+// the 64x64->128 bit multiplication.
+//
+#if defined(__SIZEOF_INT128__) || (defined(_MSC_VER) && defined(_M_X64))
+# define MINI_CURVE25519_HAS_RADIX51
+#endif
+
+namespace mini::crypto::ext::detail {
+
+#if defined(MINI_CURVE25519_HAS_RADIX51)
+
+//
+// X25519 (rfc7748) with the field elements
+// represented as 5 unsigned 51-bit limbs.
+//
+void
+curve25519_radix51(
+  uint8_t* mypublic,
+  const uint8_t* secret,
+  const uint8_t* basepoint
+  );
+
+#endif
+
+}
@@ -0,0 +1,251 @@
+#include "sha1_compress.h"
+
+//
+// SHA extensions are available on x86/x64 only,
+// the kernel mode code doesn't touch the vector registers.
+//
+#if !defined(MINI_MODE_KERNEL) && (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86))
+# define MINI_SHA1_USE_SHANI
+# if defined(_MSC_VER)
+#  include <intrin.h>
+#  include <immintrin.h>
+#  define MINI_SHA1_TARGET_SHANI
+# else
+#  include <cpuid.h>
+#  include <immintrin.h>
+#  define MINI_SHA1_TARGET_SHANI __attribute__((target("sha,sse4.1,ssse3")))
+# endif
+#endif
+
+namespace mini::crypto::ext::detail {
+
+static inline uint32_t
+rotl(
+  uint32_t value,
+  int count
+  )
+{
+  return (value << count) | (value >> (32 - count));
+}
+
+static inline uint32_t
+load_be32(
+  const uint8_t* p
+  )
+{
+  return
+    (static_cast<uint32_t>(p[0]) << 24) |
+    (static_cast<uint32_t>(p[1]) << 16) |
+    (static_cast<uint32_t>(p[2]) <<  8) |
+    (static_cast<uint32_t>(p[3])      );
+}
+
+//
+// FIPS 180-4, 6.1.2.
+//
+static void
+sha1_compress_generic(
+  uint32_t state[5],
+  const uint8_t* blocks,
+  size_t block_count
+  )
+{
+  for (; block_count > 0; block_count--, blocks += 64)
+  {
+    uint32_t w[16];
+
+    for (int i = 0; i < 16; i++)
+    {
+      w[i] = load_be32(blocks + i * 4);
+    }
+
+    uint32_t a = state[0];
+    uint32_t b = state[1];
+    uint32_t c = state[2];
+    uint32_t d = state[3];
+    uint32_t e = state[4];
+
+    for (int i = 0; i < 80; i++)
+    {
+      //
+      // the message schedule is kept in a 16-word ring.
+      //
+      if (i >= 16)
+      {
+        w[i & 15] = rotl(w[(i - 3) & 15] ^ w[(i - 8) & 15] ^ w[(i - 14) & 15] ^ w[i & 15], 1);
+      }
+
+      uint32_t f;
+      uint32_t k;
+
+      if (i < 20)
+      {
+        f = (b & c) | (~b & d);
+        k = 0x5a827999;
+      }
+      else if (i < 40)
+      {
+        f = b ^ c ^ d;
+        k = 0x6ed9eba1;
+      }
+      else if (i < 60)
+      {
+        f = (b & c) | (b & d) | (c & d);
+        k = 0x8f1bbcdc;
+      }
+      else
+      {
+        f = b ^ c ^ d;
+        k = 0xca62c1d6;
+      }
+
+      const uint32_t temp = rotl(a, 5) + f + e + k + w[i & 15];
+      e = d;
+      d = c;
+      c = rotl(b, 30);
+      b = a;
+      a = temp;
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+  }
+}
+
+#if defined(MINI_SHA1_USE_SHANI)
+
+static bool
+is_shani_supported(
+  void
+  )
+{
+  unsigned int leaf1[4] = { 0 };
+  unsigned int leaf7[4] = { 0 };
+
+#if defined(_MSC_VER)
+  int regs[4];
+
+  __cpuid(regs, 0);
+  if (regs[0] < 7)
+  {
+    return false;
+  }
+
+  __cpuidex(regs, 1, 0);
+  for (int i = 0; i < 4; i++) leaf1[i] = static_cast<unsigned int>(regs[i]);
+
+  __cpuidex(regs, 7, 0);
+  for (int i = 0; i < 4; i++) leaf7[i] = static_cast<unsigned int>(regs[i]);
+#else
+  if (!__get_cpuid_count(1, 0, &leaf1[0], &leaf1[1], &leaf1[2], &leaf1[3]) ||
+      !__get_cpuid_count(7, 0, &leaf7[0], &leaf7[1], &leaf7[2], &leaf7[3]))
+  {
+    return false;
+  }
+#endif
+
+  const bool has_ssse3  = (leaf1[2] & (1u <<  9)) != 0;
+  const bool has_sse41  = (leaf1[2] & (1u << 19)) != 0;
+  const bool has_shani  = (leaf7[1] & (1u << 29)) != 0;
+
+  return has_ssse3 && has_sse41 && has_shani;
+}
+
+//
+// 4 rounds of the group g (rounds 4*g .. 4*g+3),
+// the round function selector must be an immediate.
+//
+#define MINI_SHA1_RNDS4(abcd, e, g)                                   \
+  ((g) < 5  ? _mm_sha1rnds4_epu32((abcd), (e), 0) :                   \
+   (g) < 10 ? _mm_sha1rnds4_epu32((abcd), (e), 1) :                   \
+   (g) < 15 ? _mm_sha1rnds4_epu32((abcd), (e), 2) :                   \
+              _mm_sha1rnds4_epu32((abcd), (e), 3))
+
+MINI_SHA1_TARGET_SHANI
+static void
+sha1_compress_shani(
+  uint32_t state[5],
+  const uint8_t* blocks,
+  size_t block_count
+  )
+{
+  const __m128i byte_swap_mask = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+
+  __m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0x1b);
+  __m128i e0   = _mm_set_epi32(static_cast<int>(state[4]), 0, 0, 0);
+
+  for (; block_count > 0; block_count--, blocks += 64)
+  {
+    const __m128i abcd_save = abcd;
+    const __m128i e0_save   = e0;
+
+    //
+    // msg[g % 4] holds the words W[4*g .. 4*g+3],
+    // the schedule of the group g is:
+    //   W(g) = sha1msg2(sha1msg1(W(g-4), W(g-3)) ^ W(g-2), W(g-1))
+    //
+    __m128i msg[4];
+    __m128i e      = e0;
+    __m128i e_save = e0;
+
+    for (int g = 0; g < 20; g++)
+    {
+      if (g < 4)
+      {
+        msg[g] = _mm_shuffle_epi8(
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks + g * 16)),
+          byte_swap_mask);
+      }
+      else
+      {
+        msg[g & 3] = _mm_sha1msg2_epu32(
+          _mm_xor_si128(
+            _mm_sha1msg1_epu32(msg[g & 3], msg[(g + 1) & 3]),
+            msg[(g + 2) & 3]),
+          msg[(g + 3) & 3]);
+      }
+
+      e = g == 0
+        ? _mm_add_epi32(e0, msg[0])
+        : _mm_sha1nexte_epu32(e_save, msg[g & 3]);
+
+      e_save = abcd;
+      abcd   = MINI_SHA1_RNDS4(abcd, e, g);
+    }
+
+    e0   = _mm_sha1nexte_epu32(e_save, e0_save);
+    abcd = _mm_add_epi32(abcd, abcd_save);
+  }
+
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_shuffle_epi32(abcd, 0x1b));
+  state[4] = static_cast<uint32_t>(_mm_extract_epi32(e0, 3));
+}
+
+#undef MINI_SHA1_RNDS4
+
+#endif
+
+void
+sha1_compress(
+  uint32_t state[5],
+  const uint8_t* blocks,
+  size_t block_count
+  )
+{
+#if defined(MINI_SHA1_USE_SHANI)
+  static const bool use_shani = is_shani_supported();
+
+  if (use_shani)
+  {
+    sha1_compress_shani(state, blocks, block_count);
+    return;
+  }
+#endif
+
+  sha1_compress_generic(state, blocks, block_count);
+}
+
+}
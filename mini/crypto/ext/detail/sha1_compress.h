@@ -0,0 +1,17 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace mini::crypto::ext::detail {
+
+//
+// processes block_count 64-byte blocks.
+//
+void
+sha1_compress(
+  uint32_t state[5],
+  const uint8_t* blocks,
+  size_t block_count
+  );
+
+}
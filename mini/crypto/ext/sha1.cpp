@@ -0,0 +1,144 @@
+#include "sha1.h"
+#include "detail/sha1_compress.h"
+
+#include <mini/algorithm.h>
+#include <mini/memory.h>
+
+namespace mini::crypto::ext {
+
+//
+// constructors.
+//
+
+sha1::sha1(
+  void
+  )
+  : _state{ 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0 }
+  , _length(0)
+  , _buffer()
+{
+
+}
+
+sha1
+sha1::duplicate(
+  void
+  ) const
+{
+  return *this;
+}
+
+//
+// operations.
+//
+
+void
+sha1::update(
+  const byte_buffer_ref input
+  )
+{
+  const byte_type* data = input.get_buffer();
+  size_type size = input.get_size();
+
+  size_type buffered = static_cast<size_type>(_length % block_size_in_bytes);
+  _length += size;
+
+  //
+  // complete the partially filled block first.
+  //
+  if (buffered > 0)
+  {
+    const size_type to_copy = algorithm::min(size, block_size_in_bytes - buffered);
+    memory::copy(_buffer + buffered, data, to_copy);
+
+    data     += to_copy;
+    size     -= to_copy;
+    buffered += to_copy;
+
+    if (buffered < block_size_in_bytes)
+    {
+      return;
+    }
+
+    detail::sha1_compress(_state, _buffer, 1);
+  }
+
+  //
+  // whole blocks are compressed directly from the input.
+  //
+  const size_type block_count = size / block_size_in_bytes;
+
+  if (block_count > 0)
+  {
+    detail::sha1_compress(_state, data, block_count);
+
+    data += block_count * block_size_in_bytes;
+    size -= block_count * block_size_in_bytes;
+  }
+
+  memory::copy(_buffer, data, size);
+}
+
+byte_buffer
+sha1::compute(
+  const byte_buffer_ref input
+  )
+{
+  sha1 hash;
+  hash.update(input);
+  return hash.get();
+}
+
+//
+// accessors.
+//
+
+void
+sha1::get(
+  mutable_byte_buffer_ref output
+  ) const
+{
+  mini_assert(output.get_size() >= hash_size_in_bytes);
+
+  //
+  // pad a copy of the state, the running digest stays untouched.
+  //
+  uint32_t  state[5];
+  byte_type tail[block_size_in_bytes * 2] = { 0 };
+
+  memory::copy(state, _state, sizeof(state));
+
+  const size_type buffered  = static_cast<size_type>(_length % block_size_in_bytes);
+  const size_type tail_size = buffered < block_size_in_bytes - sizeof(uint64_t)
+    ? block_size_in_bytes
+    : block_size_in_bytes * 2;
+
+  memory::copy(tail, _buffer, buffered);
+  tail[buffered] = 0x80;
+
+  const uint64_t length_in_bits = _length * 8;
+
+  for (size_type i = 0; i < sizeof(uint64_t); i++)
+  {
+    tail[tail_size - 1 - i] = static_cast<byte_type>(length_in_bits >> (i * 8));
+  }
+
+  detail::sha1_compress(state, tail, tail_size / block_size_in_bytes);
+
+  for (size_type i = 0; i < hash_size_in_bytes; i++)
+  {
+    output[i] = static_cast<byte_type>(state[i / 4] >> (24 - (i % 4) * 8));
+  }
+}
+
+byte_buffer
+sha1::get(
+  void
+  ) const
+{
+  byte_buffer result(hash_size_in_bytes);
+  get(result);
+  return result;
+}
+
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include "../common.h"
+
+#include <mini/byte_buffer.h>
+
+namespace mini::crypto::ext {
+
+//
+// SHA-1 with the running state kept in the object.
+//
+// the object is a plain copyable value (no handles, no allocation),
+// so the snapshot of the running digest is a copy of the state.
+// get() finalizes a copy of the state, the running digest
+// can be updated afterwards.
+//
+// the compression uses the SHA extensions (SHA-NI)
+// when the cpu supports them.
+//
+
+class sha1
+{
+  public:
+    static constexpr size_type hash_size           = hash_algorithm_to_bit_size(hash_algorithm_type::sha1);
+    static constexpr size_type hash_size_in_bytes  = hash_size / 8;
+    static constexpr size_type block_size_in_bytes = 64;
+    static constexpr hash_algorithm_type hash_algorithm = hash_algorithm_type::sha1;
+
+    //
+    // constructors.
+    //
+
+    sha1(
+      void
+      );
+
+    sha1(
+      const sha1& other
+      ) = default;
+
+    //
+    // assign operators.
+    //
+
+    sha1&
+    operator=(
+      const sha1& other
+      ) = default;
+
+    sha1
+    duplicate(
+      void
+      ) const;
+
+    //
+    // operations.
+    //
+
+    void
+    update(
+      const byte_buffer_ref input
+      );
+
+    static byte_buffer
+    compute(
+      const byte_buffer_ref input
+      );
+
+    //
+    // accessors.
+    //
+
+    void
+    get(
+      mutable_byte_buffer_ref output
+      ) const;
+
+    byte_buffer
+    get(
+      void
+      ) const;
+
+  private:
+    uint32_t  _state[5];
+    uint64_t  _length;
+    byte_type _buffer[block_size_in_bytes];
+};
+
+}
@@ -3,6 +3,8 @@
 #include "capi/hmac.h"
 #ifdef MINI_OS_WINDOWS
 #include "cng/hmac.h"
+#else
+#include "openssl/hmac.h"
 #endif
 
 namespace mini::crypto {
@@ -0,0 +1,213 @@
+#pragma once
+#include "key.h"
+#include "../common.h"
+
+#include <mini/byte_buffer.h>
+
+#include <openssl/evp.h>
+
+namespace mini::crypto::openssl {
+
+//
+// AES
+// key.
+//
+
+template <
+  cipher_mode AES_MODE,
+  size_type KEY_SIZE
+>
+class aes_key
+  : public key
+{
+  MINI_MAKE_NONCOPYABLE(aes_key);
+
+  static_assert(
+    KEY_SIZE == 128 ||
+    KEY_SIZE == 192 ||
+    KEY_SIZE == 256,
+    "valid AES key sizes are: 128, 192, 256");
+
+  public:
+    static constexpr size_type   key_size          = KEY_SIZE;
+    static constexpr size_type   key_size_in_bytes = KEY_SIZE / 8;
+    static constexpr size_type   iv_size_in_bytes  = 16;
+    static constexpr cipher_mode mode              = AES_MODE;
+
+    aes_key(
+      void
+      );
+
+    aes_key(
+      const byte_buffer_ref key
+      );
+
+    aes_key(
+      aes_key&& other
+      );
+
+    aes_key&
+    operator=(
+      aes_key&& other
+      );
+
+    void
+    swap(
+      aes_key& other
+      );
+
+    //
+    // import.
+    //
+
+    void
+    import(
+      const byte_buffer_ref key
+      );
+
+    //
+    // getters.
+    //
+
+    byte_buffer_ref
+    get_key_buffer(
+      void
+      ) const;
+
+    byte_buffer_ref
+    get_iv(
+      void
+      ) const;
+
+    void
+    set_iv(
+      const byte_buffer_ref iv
+      );
+
+  private:
+    byte_type _key[key_size_in_bytes];
+    byte_type _iv[iv_size_in_bytes];
+};
+
+//
+// AES
+//
+// the cipher context keeps the chaining state
+// (the counter and the keystream offset in ctr mode)
+// between the calls, so the whole buffer is handed
+// to the EVP_EncryptUpdate() at once and the AES-NI
+// code path of the OpenSSL processes it in a single pass.
+//
+
+template <
+  cipher_mode AES_MODE,
+  size_type KEY_SIZE
+>
+class aes
+{
+  MINI_MAKE_NONCOPYABLE(aes);
+
+  public:
+    static constexpr size_type   key_size          = KEY_SIZE;
+    static constexpr size_type   key_size_in_bytes = KEY_SIZE / 8;
+    static constexpr cipher_mode mode              = AES_MODE;
+
+    using key = aes_key<AES_MODE, KEY_SIZE>;
+
+    aes(
+      void
+      ) = default;
+
+    aes(
+      key&& k
+      );
+
+    ~aes(
+      void
+      );
+
+    void
+    init(
+      key&& k
+      );
+
+    void
+    encrypt_inplace(
+      mutable_byte_buffer_ref buffer
+      );
+
+    void
+    encrypt(
+      const byte_buffer_ref input,
+      mutable_byte_buffer_ref output
+      );
+
+    byte_buffer
+    encrypt(
+      const byte_buffer_ref input
+      );
+
+    //
+    // in ctr mode the decryption shares
+    // the counter with the encryption.
+    //
+
+    void
+    decrypt_inplace(
+      mutable_byte_buffer_ref buffer
+      );
+
+    void
+    decrypt(
+      const byte_buffer_ref input,
+      mutable_byte_buffer_ref output
+      );
+
+    byte_buffer
+    decrypt(
+      const byte_buffer_ref input
+      );
+
+    static byte_buffer
+    encrypt(
+      key&& k,
+      const byte_buffer_ref input
+      );
+
+    static byte_buffer
+    decrypt(
+      key&& k,
+      const byte_buffer_ref input
+      );
+
+    //
+    // ctr mode only.
+    //
+
+    static byte_buffer
+    crypt(
+      key&& k,
+      const byte_buffer_ref input
+      );
+
+  private:
+    void
+    destroy(
+      void
+      );
+
+    static void
+    update(
+      EVP_CIPHER_CTX* context,
+      const byte_buffer_ref input,
+      mutable_byte_buffer_ref output
+      );
+
+    key _key;
+    EVP_CIPHER_CTX* _encrypt_context = nullptr;
+    EVP_CIPHER_CTX* _decrypt_context = nullptr;
+};
+
+}
+
+#include "aes.inl"
@@ -0,0 +1,433 @@
+#include "aes.h"
+
+namespace mini::crypto::openssl {
+
+namespace detail {
+
+  //
+  // map each value from cipher_mode to its
+  // corresponding EVP cipher.
+  //
+  template <
+    size_type KEY_SIZE
+  >
+  static const EVP_CIPHER*
+  get_aes_cipher(
+    cipher_mode mode
+    )
+  {
+    switch (mode)
+    {
+      case cipher_mode::cbc:
+        return
+          KEY_SIZE == 128 ? EVP_aes_128_cbc() :
+          KEY_SIZE == 192 ? EVP_aes_192_cbc() :
+                            EVP_aes_256_cbc();
+
+      case cipher_mode::ecb:
+        return
+          KEY_SIZE == 128 ? EVP_aes_128_ecb() :
+          KEY_SIZE == 192 ? EVP_aes_192_ecb() :
+                            EVP_aes_256_ecb();
+
+      case cipher_mode::ofb:
+        return
+          KEY_SIZE == 128 ? EVP_aes_128_ofb() :
+          KEY_SIZE == 192 ? EVP_aes_192_ofb() :
+                            EVP_aes_256_ofb();
+
+      case cipher_mode::cfb:
+        return
+          KEY_SIZE == 128 ? EVP_aes_128_cfb128() :
+          KEY_SIZE == 192 ? EVP_aes_192_cfb128() :
+                            EVP_aes_256_cfb128();
+
+      case cipher_mode::ctr:
+        return
+          KEY_SIZE == 128 ? EVP_aes_128_ctr() :
+          KEY_SIZE == 192 ? EVP_aes_192_ctr() :
+                            EVP_aes_256_ctr();
+
+      default:
+        //
+        // cts is not supported.
+        //
+        return nullptr;
+    }
+  }
+
+}
+
+//
+// AES
+// key.
+//
+
+template <
+  cipher_mode AES_MODE,
+  size_type KEY_SIZE
+>
+aes_key<AES_MODE, KEY_SIZE>::aes_key(
+  void
+  )
+  : _key()
+  , _iv()
+{
+
+}
+
+template <
+  cipher_mode AES_MODE,
+  size_type KEY_SIZE
+>
+aes_key<AES_MODE, KEY_SIZE>::aes_key(
+  const byte_buffer_ref key
+  )
+  : aes_key<AES_MODE, KEY_SIZE>()
+{
+  import(key);
+}
+
+template <
+  cipher_mode AES_MODE,
+  size_type KEY_SIZE
+>
+aes_key<AES_MODE, KEY_SIZE>::aes_key(
+  aes_key&& other
+  )
+  : aes_key<AES_MODE, KEY_SIZE>()
+{
+  swap(other);
+}
+
+template <
+  cipher_mode AES_MODE,
+  size_type KEY_SIZE
+>
+aes_key<AES_MODE, KEY_SIZE>&
+aes_key<AES_MODE, KEY_SIZE>::operator=(
+  aes_key&& other
+  )
+{
+  swap(other);
+  return *this;
+}
+
+template <
+  cipher_mode AES_MODE,
+  size_type KEY_SIZE
+>
+void
+aes_key<AES_MODE, KEY_SIZE>::swap(
+  aes_key& other
+  )
+{
+  key::swap(other);
+  mini::swap(_key, other._key);
+  mini::swap(_iv, other._iv);
+}
+
+template <
+  cipher_mode AES_MODE,
+  size_type KEY_SIZE
+>
+void
+aes_key<AES_MODE, KEY_SIZE>::import(
+  const byte_buffer_ref key
+  )
+{
+  mini_assert(key.get_size() >= key_size_in_bytes);
+
+  memory::copy(_key, key.get_buffer(), key_size_in_bytes);
+}
+
+template <
+  cipher_mode AES_MODE,
+  size_type KEY_SIZE
+>
+byte_buffer_ref
+aes_key<AES_MODE, KEY_SIZE>::get_key_buffer(
+  void
+  ) const
+{
+  return _key;
+}
+
+template <
+  cipher_mode AES_MODE,
+  size_type KEY_SIZE
+>
+byte_buffer_ref
+aes_key<AES_MODE, KEY_SIZE>::get_iv(
+  void
+  ) const
+{
+  return _iv;
+}
+
+template <
+  cipher_mode AES_MODE,
+  size_type KEY_SIZE
+>
+void
+aes_key<AES_MODE, KEY_SIZE>::set_iv(
+  const byte_buffer_ref iv
+  )
+{
+  iv.copy_to(_iv);
+}
+
+//
+// AES
+//
+
+template <
+  cipher_mode AES_MODE,
+  size_type KEY_SIZE
+>
+aes<AES_MODE, KEY_SIZE>::aes(
+  typename aes::key&& k
+  )
+{
+  init(std::move(k));
+}
+
+template <
+  cipher_mode AES_MODE,
+  size_type KEY_SIZE
+>
+aes<AES_MODE, KEY_SIZE>::~aes(
+  void
+  )
+{
+  destroy();
+}
+
+template <
+  cipher_mode AES_MODE,
+  size_type KEY_SIZE
+>
+void
+aes<AES_MODE, KEY_SIZE>::init(
+  typename aes::key&& k
+  )
+{
+  destroy();
+
+  _key = std::move(k);
+
+  const EVP_CIPHER* cipher = detail::get_aes_cipher<KEY_SIZE>(AES_MODE);
+  mini_assert(cipher != nullptr);
+
+  _encrypt_context = EVP_CIPHER_CTX_new();
+  EVP_EncryptInit_ex(
+    _encrypt_context,
+    cipher,
+    nullptr,
+    _key.get_key_buffer().get_buffer(),
+    _key.get_iv().get_buffer());
+  EVP_CIPHER_CTX_set_padding(_encrypt_context, 0);
+
+  //
+  // the keystream of the ctr mode is the same
+  // for both directions.
+  //
+  if (AES_MODE != cipher_mode::ctr)
+  {
+    _decrypt_context = EVP_CIPHER_CTX_new();
+    EVP_DecryptInit_ex(
+      _decrypt_context,
+      cipher,
+      nullptr,
+      _key.get_key_buffer().get_buffer(),
+      _key.get_iv().get_buffer());
+    EVP_CIPHER_CTX_set_padding(_decrypt_context, 0);
+  }
+}
+
+template <
+  cipher_mode AES_MODE,
+  size_type KEY_SIZE
+>
+void
+aes<AES_MODE, KEY_SIZE>::encrypt_inplace(
+  mutable_byte_buffer_ref buffer
+  )
+{
+  update(_encrypt_context, buffer, buffer);
+}
+
+template <
+  cipher_mode AES_MODE,
+  size_type KEY_SIZE
+>
+void
+aes<AES_MODE, KEY_SIZE>::encrypt(
+  const byte_buffer_ref input,
+  mutable_byte_buffer_ref output
+  )
+{
+  update(_encrypt_context, input, output);
+}
+
+template <
+  cipher_mode AES_MODE,
+  size_type KEY_SIZE
+>
+byte_buffer
+aes<AES_MODE, KEY_SIZE>::encrypt(
+  const byte_buffer_ref input
+  )
+{
+  byte_buffer result(input.get_size());
+  encrypt(input, result);
+
+  return result;
+}
+
+template <
+  cipher_mode AES_MODE,
+  size_type KEY_SIZE
+>
+void
+aes<AES_MODE, KEY_SIZE>::decrypt_inplace(
+  mutable_byte_buffer_ref buffer
+  )
+{
+  decrypt(buffer, buffer);
+}
+
+template <
+  cipher_mode AES_MODE,
+  size_type KEY_SIZE
+>
+void
+aes<AES_MODE, KEY_SIZE>::decrypt(
+  const byte_buffer_ref input,
+  mutable_byte_buffer_ref output
+  )
+{
+  update(
+    AES_MODE == cipher_mode::ctr
+      ? _encrypt_context
+      : _decrypt_context,
+    input,
+    output);
+}
+
+template <
+  cipher_mode AES_MODE,
+  size_type KEY_SIZE
+>
+byte_buffer
+aes<AES_MODE, KEY_SIZE>::decrypt(
+  const byte_buffer_ref input
+  )
+{
+  byte_buffer result(input.get_size());
+  decrypt(input, result);
+
+  return result;
+}
+
+template <
+  cipher_mode AES_MODE,
+  size_type KEY_SIZE
+>
+byte_buffer
+aes<AES_MODE, KEY_SIZE>::encrypt(
+  key&& k,
+  const byte_buffer_ref input
+  )
+{
+  return aes<AES_MODE, KEY_SIZE>(std::move(k)).encrypt(input);
+}
+
+template <
+  cipher_mode AES_MODE,
+  size_type KEY_SIZE
+>
+byte_buffer
+aes<AES_MODE, KEY_SIZE>::decrypt(
+  key&& k,
+  const byte_buffer_ref input
+  )
+{
+  return aes<AES_MODE, KEY_SIZE>(std::move(k)).decrypt(input);
+}
+
+template <
+  cipher_mode AES_MODE,
+  size_type KEY_SIZE
+>
+byte_buffer
+aes<AES_MODE, KEY_SIZE>::crypt(
+  key&& k,
+  const byte_buffer_ref input
+  )
+{
+  static_assert(AES_MODE == cipher_mode::ctr, "crypt() is available only in ctr mode");
+
+  return encrypt(std::move(k), input);
+}
+
+//
+// private methods.
+//
+
+template <
+  cipher_mode AES_MODE,
+  size_type KEY_SIZE
+>
+void
+aes<AES_MODE, KEY_SIZE>::destroy(
+  void
+  )
+{
+  if (_encrypt_context)
+  {
+    EVP_CIPHER_CTX_free(_encrypt_context);
+    _encrypt_context = nullptr;
+  }
+
+  if (_decrypt_context)
+  {
+    EVP_CIPHER_CTX_free(_decrypt_context);
+    _decrypt_context = nullptr;
+  }
+}
+
+template <
+  cipher_mode AES_MODE,
+  size_type KEY_SIZE
+>
+void
+aes<AES_MODE, KEY_SIZE>::update(
+  EVP_CIPHER_CTX* context,
+  const byte_buffer_ref input,
+  mutable_byte_buffer_ref output
+  )
+{
+  mini_assert(context != nullptr);
+  mini_assert(input.get_size() == output.get_size());
+
+  if (input.is_empty())
+  {
+    return;
+  }
+
+  //
+  // EVP_EncryptUpdate() and EVP_DecryptUpdate() are the same
+  // for the ciphers without padding, in-place operation
+  // is allowed.
+  //
+  int output_size = 0;
+  EVP_CipherUpdate(
+    context,
+    output.get_buffer(),
+    &output_size,
+    input.get_buffer(),
+    static_cast<int>(input.get_size()));
+}
+
+}
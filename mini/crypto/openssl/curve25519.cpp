@@ -0,0 +1,216 @@
+#include "curve25519.h"
+#include "../random.h"
+
+namespace mini::crypto::openssl {
+
+//
+// curve25519
+// public key.
+//
+
+curve25519_public_key::curve25519_public_key(
+  const byte_buffer_ref key
+  )
+{
+  import(key);
+}
+
+curve25519_public_key::curve25519_public_key(
+  curve25519_public_key&& other
+  )
+{
+  swap(other);
+}
+
+curve25519_public_key&
+curve25519_public_key::operator=(
+  curve25519_public_key&& other
+  )
+{
+  swap(other);
+  return *this;
+}
+
+void
+curve25519_public_key::swap(
+  curve25519_public_key& other
+  )
+{
+  key::swap(other);
+  mini::swap(_blob, other._blob);
+}
+
+//
+// import.
+//
+
+void
+curve25519_public_key::import(
+  const byte_buffer_ref key
+  )
+{
+  mini_assert(key.get_size() >= key_size_in_bytes);
+
+  destroy();
+
+  memory::copy(_blob.X, key.get_buffer(), key_size_in_bytes);
+
+  _key_handle = EVP_PKEY_new_raw_public_key(
+    EVP_PKEY_X25519,
+    nullptr,
+    _blob.X,
+    key_size_in_bytes);
+}
+
+//
+// getters.
+//
+
+byte_buffer
+curve25519_public_key::get_public_key_buffer(
+  void
+) const
+{
+  return _blob.X;
+}
+
+//
+// curve25519
+// private key.
+//
+
+curve25519_private_key::curve25519_private_key(
+  const byte_buffer_ref key
+  )
+{
+  import(key);
+}
+
+curve25519_private_key::curve25519_private_key(
+  curve25519_private_key&& other
+  )
+{
+  swap(other);
+}
+
+curve25519_private_key&
+curve25519_private_key::operator=(
+  curve25519_private_key&& other
+  )
+{
+  swap(other);
+  return *this;
+}
+
+void
+curve25519_private_key::swap(
+  curve25519_private_key& other
+  )
+{
+  key::swap(other);
+  mini::swap(_blob, other._blob);
+}
+
+//
+// import.
+//
+
+curve25519_private_key
+curve25519_private_key::generate(
+  void
+  )
+{
+  auto random_private_key = random_device.get_random_bytes(key_size_in_bytes);
+  random_private_key[0]  &= 248;
+  random_private_key[31] &= 127;
+  random_private_key[31] |= 64;
+
+  return curve25519_private_key(random_private_key);
+}
+
+void
+curve25519_private_key::import(
+  const byte_buffer_ref key
+  )
+{
+  mini_assert(key.get_size() >= key_size_in_bytes);
+
+  destroy();
+
+  memory::copy(_blob.d, key.get_buffer(), key_size_in_bytes);
+
+  //
+  // the public key is computed by the OpenSSL
+  // when the private key is imported.
+  //
+  _key_handle = EVP_PKEY_new_raw_private_key(
+    EVP_PKEY_X25519,
+    nullptr,
+    _blob.d,
+    key_size_in_bytes);
+
+  size_t public_key_size = key_size_in_bytes;
+  EVP_PKEY_get_raw_public_key(_key_handle, _blob.X, &public_key_size);
+}
+
+//
+// export.
+//
+
+curve25519_public_key
+curve25519_private_key::export_public_key(
+  void
+  ) const
+{
+  return curve25519_public_key(_blob.X);
+}
+
+//
+// getters.
+//
+
+byte_buffer_ref
+curve25519_private_key::get_public_key_buffer(
+  void
+  ) const
+{
+  return _blob.X;
+}
+
+byte_buffer_ref
+curve25519_private_key::get_private_key_buffer(
+  void
+  ) const
+{
+  return _blob.d;
+}
+
+byte_buffer
+curve25519_private_key::get_shared_secret(
+  const curve25519_public_key& other_public_key
+  ) const
+{
+  byte_buffer result(key_size_in_bytes);
+  size_t result_size = key_size_in_bytes;
+
+  EVP_PKEY_CTX* context = EVP_PKEY_CTX_new(_key_handle, nullptr);
+
+  //
+  // the derivation fails on the all-zero output
+  // (small order public key), the zeroed result
+  // won't pass the handshake verification.
+  //
+  if (!context ||
+      EVP_PKEY_derive_init(context) <= 0 ||
+      EVP_PKEY_derive_set_peer(context, other_public_key.get_handle()) <= 0 ||
+      EVP_PKEY_derive(context, result.get_buffer(), &result_size) <= 0)
+  {
+    memory::zero(result.get_buffer(), result.get_size());
+  }
+
+  EVP_PKEY_CTX_free(context);
+
+  return result;
+}
+
+}
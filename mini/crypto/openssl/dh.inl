@@ -0,0 +1,405 @@
+#include "dh.h"
+#include "../random.h"
+
+#include <openssl/bn.h>
+
+namespace mini::crypto::openssl {
+
+namespace detail {
+
+  //
+  // output = base ^ exponent mod modulus
+  // (big-endian, padded to the output size).
+  //
+  static inline bool
+  dh_mod_exp(
+    const byte_buffer_ref base,
+    const byte_buffer_ref exponent,
+    const byte_buffer_ref modulus,
+    mutable_byte_buffer_ref output
+    )
+  {
+    BN_CTX* context = BN_CTX_new();
+    BN_CTX_start(context);
+
+    BIGNUM* bn_base     = BN_CTX_get(context);
+    BIGNUM* bn_exponent = BN_CTX_get(context);
+    BIGNUM* bn_modulus  = BN_CTX_get(context);
+    BIGNUM* bn_result   = BN_CTX_get(context);
+    BIGNUM* bn_max      = BN_CTX_get(context);
+
+    bool result = false;
+
+    if (bn_max)
+    {
+      BN_bin2bn(base.get_buffer(),     static_cast<int>(base.get_size()),     bn_base);
+      BN_bin2bn(exponent.get_buffer(), static_cast<int>(exponent.get_size()), bn_exponent);
+      BN_bin2bn(modulus.get_buffer(),  static_cast<int>(modulus.get_size()),  bn_modulus);
+
+      //
+      // tor-spec.txt
+      // 5.2.
+      //
+      // Before computing g^xy, both parties MUST verify that the
+      // received g^x or g^y value is not degenerate; that is, it must
+      // be strictly greater than 1 and strictly less than p-1.
+      //
+      BN_copy(bn_max, bn_modulus);
+      BN_sub_word(bn_max, 1);
+
+      if (BN_cmp(bn_base, BN_value_one()) > 0 && BN_cmp(bn_base, bn_max) < 0)
+      {
+        BN_set_flags(bn_exponent, BN_FLG_CONSTTIME);
+
+        result =
+          BN_mod_exp(bn_result, bn_base, bn_exponent, bn_modulus, context) > 0 &&
+          BN_bn2binpad(bn_result, output.get_buffer(), static_cast<int>(output.get_size())) > 0;
+      }
+    }
+
+    BN_CTX_end(context);
+    BN_CTX_free(context);
+
+    return result;
+  }
+
+}
+
+//
+// DH
+// public key.
+//
+
+template <
+  size_type KEY_SIZE
+>
+dh_public_key<KEY_SIZE>::dh_public_key(
+  void
+  )
+  : _blob()
+{
+
+}
+
+template <
+  size_type KEY_SIZE
+>
+dh_public_key<KEY_SIZE>::dh_public_key(
+  const byte_buffer_ref generator,
+  const byte_buffer_ref modulus,
+  const byte_buffer_ref y
+  )
+  : dh_public_key<KEY_SIZE>()
+{
+  import(generator, modulus, y);
+}
+
+template <
+  size_type KEY_SIZE
+>
+dh_public_key<KEY_SIZE>::dh_public_key(
+  dh_public_key&& other
+  )
+  : dh_public_key<KEY_SIZE>()
+{
+  swap(other);
+}
+
+template <
+  size_type KEY_SIZE
+>
+dh_public_key<KEY_SIZE>&
+dh_public_key<KEY_SIZE>::operator=(
+  dh_public_key&& other
+  )
+{
+  swap(other);
+  return *this;
+}
+
+template <
+  size_type KEY_SIZE
+>
+void
+dh_public_key<KEY_SIZE>::swap(
+  dh_public_key& other
+  )
+{
+  key::swap(other);
+  mini::swap(_blob, other._blob);
+}
+
+//
+// import.
+//
+
+template <
+  size_type KEY_SIZE
+>
+void
+dh_public_key<KEY_SIZE>::import(
+  const byte_buffer_ref generator,
+  const byte_buffer_ref modulus,
+  const byte_buffer_ref y
+  )
+{
+  mutable_byte_buffer_ref(_blob.generator)
+    .slice((key_size_in_bytes) - generator.get_size())
+    .copy_from(generator);
+
+  mutable_byte_buffer_ref(_blob.prime)
+    .slice((key_size_in_bytes) - modulus.get_size())
+    .copy_from(modulus);
+
+  mutable_byte_buffer_ref(_blob.y)
+    .slice((key_size_in_bytes) - y.get_size())
+    .copy_from(y);
+}
+
+//
+// getters.
+//
+
+template <
+  size_type KEY_SIZE
+>
+byte_buffer_ref
+dh_public_key<KEY_SIZE>::get_generator(
+  void
+  ) const
+{
+  return _blob.generator;
+}
+
+template <
+  size_type KEY_SIZE
+>
+byte_buffer_ref
+dh_public_key<KEY_SIZE>::get_modulus(
+  void
+  ) const
+{
+  return _blob.prime;
+}
+
+template <
+  size_type KEY_SIZE
+>
+byte_buffer_ref
+dh_public_key<KEY_SIZE>::get_y(
+  void
+  ) const
+{
+  return _blob.y;
+}
+
+//
+// DH
+// private key.
+//
+
+template <
+  size_type KEY_SIZE
+>
+dh_private_key<KEY_SIZE>::dh_private_key(
+  void
+  )
+  : _blob()
+{
+
+}
+
+template <
+  size_type KEY_SIZE
+>
+dh_private_key<KEY_SIZE>::dh_private_key(
+  const byte_buffer_ref generator,
+  const byte_buffer_ref modulus,
+  const byte_buffer_ref exponent
+  )
+  : dh_private_key<KEY_SIZE>()
+{
+  import(generator, modulus, exponent);
+}
+
+template <
+  size_type KEY_SIZE
+>
+dh_private_key<KEY_SIZE>::dh_private_key(
+  dh_private_key&& other
+  )
+  : dh_private_key<KEY_SIZE>()
+{
+  swap(other);
+}
+
+template <
+  size_type KEY_SIZE
+>
+dh_private_key<KEY_SIZE>&
+dh_private_key<KEY_SIZE>::operator=(
+  dh_private_key&& other
+  )
+{
+  swap(other);
+  return *this;
+}
+
+template <
+  size_type KEY_SIZE
+>
+void
+dh_private_key<KEY_SIZE>::swap(
+  dh_private_key& other
+  )
+{
+  key::swap(other);
+  mini::swap(_blob, other._blob);
+}
+
+//
+// import.
+//
+
+template <
+  size_type KEY_SIZE
+>
+dh_private_key<KEY_SIZE>
+dh_private_key<KEY_SIZE>::generate(
+  const byte_buffer_ref generator,
+  const byte_buffer_ref modulus
+  )
+{
+  //
+  // generate private key.
+  //
+  return dh_private_key<KEY_SIZE>(
+    generator,
+    modulus,
+    random_device.get_random_bytes(key_size_in_bytes));
+}
+
+template <
+  size_type KEY_SIZE
+>
+void
+dh_private_key<KEY_SIZE>::import(
+  const byte_buffer_ref generator,
+  const byte_buffer_ref modulus,
+  const byte_buffer_ref exponent
+  )
+{
+  mutable_byte_buffer_ref(_blob.generator)
+    .slice((key_size_in_bytes) - generator.get_size())
+    .copy_from(generator);
+
+  mutable_byte_buffer_ref(_blob.prime)
+    .slice((key_size_in_bytes) - modulus.get_size())
+    .copy_from(modulus);
+
+  mutable_byte_buffer_ref(_blob.secret)
+    .slice((key_size_in_bytes) - exponent.get_size())
+    .copy_from(exponent);
+
+  //
+  // compute the "y" (public key).
+  //
+  detail::dh_mod_exp(_blob.generator, _blob.secret, _blob.prime, _blob.y);
+}
+
+//
+// export.
+//
+
+template <
+  size_type KEY_SIZE
+>
+dh_public_key<KEY_SIZE>
+dh_private_key<KEY_SIZE>::export_public_key(
+  void
+  ) const
+{
+  return dh_public_key<KEY_SIZE>(
+    get_generator(),
+    get_modulus(),
+    get_y());
+}
+
+//
+// getters.
+//
+
+template <
+  size_type KEY_SIZE
+>
+byte_buffer_ref
+dh_private_key<KEY_SIZE>::get_generator(
+  void
+  ) const
+{
+  return _blob.generator;
+}
+
+template <
+  size_type KEY_SIZE
+>
+byte_buffer_ref
+dh_private_key<KEY_SIZE>::get_modulus(
+  void
+  ) const
+{
+  return _blob.prime;
+}
+
+template <
+  size_type KEY_SIZE
+>
+byte_buffer_ref
+dh_private_key<KEY_SIZE>::get_exponent(
+  void
+  ) const
+{
+  return _blob.secret;
+}
+
+template <
+  size_type KEY_SIZE
+>
+byte_buffer_ref
+dh_private_key<KEY_SIZE>::get_y(
+  void
+  ) const
+{
+  return _blob.y;
+}
+
+template <
+  size_type KEY_SIZE
+>
+byte_buffer
+dh_private_key<KEY_SIZE>::get_shared_secret(
+  const dh_public_key<KEY_SIZE>& other_public_key
+  ) const
+{
+  return get_shared_secret(other_public_key.get_y());
+}
+
+template <
+  size_type KEY_SIZE
+>
+byte_buffer
+dh_private_key<KEY_SIZE>::get_shared_secret(
+  const byte_buffer_ref other_public_key_y
+  ) const
+{
+  byte_buffer result(key_size_in_bytes);
+
+  if (!detail::dh_mod_exp(other_public_key_y, _blob.secret, _blob.prime, result))
+  {
+    result.clear();
+  }
+
+  return result;
+}
+
+}
@@ -0,0 +1,141 @@
+#pragma once
+#include "../common.h"
+
+#include <mini/byte_buffer.h>
+
+#include <openssl/evp.h>
+
+namespace mini::crypto::openssl {
+
+template <
+  hash_algorithm_type HASH_ALGORITHM
+>
+class hash
+{
+  public:
+    static constexpr size_type hash_size          = hash_algorithm_to_bit_size(HASH_ALGORITHM);
+    static constexpr size_type hash_size_in_bytes = hash_size / 8;
+    static constexpr hash_algorithm_type hash_algorithm = HASH_ALGORITHM;
+
+    //
+    // constructors.
+    //
+
+    hash(
+      void
+      );
+
+    hash(
+      const hash& other
+      );
+
+    hash(
+      hash&& other
+      );
+
+    //
+    // destructor.
+    //
+
+    ~hash(
+      void
+      );
+
+    //
+    // assign operators.
+    //
+
+    hash&
+    operator=(
+      const hash& other
+      );
+
+    hash&
+    operator=(
+      hash&& other
+      );
+
+    hash
+    duplicate(
+      void
+      );
+
+    //
+    // swap.
+    //
+
+    void
+    swap(
+      hash& other
+      );
+
+    //
+    // operations.
+    //
+
+    void
+    update(
+      const byte_buffer_ref input
+      );
+
+    static byte_buffer
+    compute(
+      const byte_buffer_ref input
+      );
+
+    //
+    // accessors.
+    //
+
+    void
+    get(
+      mutable_byte_buffer_ref output
+      );
+
+    byte_buffer
+    get(
+      void
+      );
+
+  protected:
+    //
+    // keyed hash (hmac).
+    //
+    hash(
+      const byte_buffer_ref key
+      );
+
+    void
+    init(
+      void
+      );
+
+    void
+    init(
+      const byte_buffer_ref key
+      );
+
+    void
+    destroy(
+      void
+      );
+
+    void
+    duplicate_internal(
+      const hash& other
+      );
+
+  private:
+    EVP_MD_CTX* _md_context = nullptr;
+    EVP_MAC_CTX* _mac_context = nullptr;
+
+    //
+    // the digest is finalized by the first get().
+    //
+    byte_type _hash_value[hash_size_in_bytes];
+    bool _finalized = false;
+};
+
+}
+
+#include "hash.inl"
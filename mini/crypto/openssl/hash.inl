@@ -0,0 +1,340 @@
+#include "hash.h"
+
+#include <openssl/core_names.h>
+#include <openssl/params.h>
+
+namespace mini::crypto::openssl {
+
+namespace detail {
+
+  //
+  // map each value from hash_algorithm_type to its
+  // corresponding EVP digest.
+  //
+  static inline const EVP_MD*
+  get_hash_algorithm(
+    hash_algorithm_type hash_algorithm
+    )
+  {
+    switch (hash_algorithm)
+    {
+      case hash_algorithm_type::md5:    return EVP_md5();
+      case hash_algorithm_type::sha1:   return EVP_sha1();
+      case hash_algorithm_type::sha256: return EVP_sha256();
+      case hash_algorithm_type::sha512: return EVP_sha512();
+      default:                          return nullptr;
+    }
+  }
+
+  //
+  // EVP_MAC is fetched once, the fetch goes
+  // through the provider lookup.
+  //
+  static inline EVP_MAC*
+  get_hmac(
+    void
+    )
+  {
+    static EVP_MAC* hmac = EVP_MAC_fetch(nullptr, OSSL_MAC_NAME_HMAC, nullptr);
+    return hmac;
+  }
+
+}
+
+//
+// constructors.
+//
+
+template <
+  hash_algorithm_type HASH_ALGORITHM
+>
+hash<HASH_ALGORITHM>::hash(
+  void
+  )
+{
+  init();
+}
+
+template <
+  hash_algorithm_type HASH_ALGORITHM
+>
+hash<HASH_ALGORITHM>::hash(
+  const hash& other
+  )
+{
+  duplicate_internal(other);
+}
+
+template <
+  hash_algorithm_type HASH_ALGORITHM
+>
+hash<HASH_ALGORITHM>::hash(
+  hash&& other
+  )
+{
+  swap(other);
+}
+
+template <
+  hash_algorithm_type HASH_ALGORITHM
+>
+hash<HASH_ALGORITHM>::hash(
+  const byte_buffer_ref key
+  )
+{
+  init(key);
+}
+
+//
+// destructor.
+//
+
+template <
+  hash_algorithm_type HASH_ALGORITHM
+>
+hash<HASH_ALGORITHM>::~hash(
+  void
+  )
+{
+  destroy();
+}
+
+//
+// assign operators.
+//
+
+template <
+  hash_algorithm_type HASH_ALGORITHM
+>
+hash<HASH_ALGORITHM>&
+hash<HASH_ALGORITHM>::operator=(
+  const hash& other
+  )
+{
+  duplicate_internal(other);
+  return *this;
+}
+
+template <
+  hash_algorithm_type HASH_ALGORITHM
+>
+hash<HASH_ALGORITHM>&
+hash<HASH_ALGORITHM>::operator=(
+  hash&& other
+  )
+{
+  swap(other);
+  return *this;
+}
+
+template <
+  hash_algorithm_type HASH_ALGORITHM
+>
+hash<HASH_ALGORITHM>
+hash<HASH_ALGORITHM>::duplicate(
+  void
+  )
+{
+  return hash<HASH_ALGORITHM>(*this);
+}
+
+//
+// swap.
+//
+
+template <
+  hash_algorithm_type HASH_ALGORITHM
+>
+void
+hash<HASH_ALGORITHM>::swap(
+  hash& other
+  )
+{
+  mini::swap(_md_context, other._md_context);
+  mini::swap(_mac_context, other._mac_context);
+  mini::swap(_hash_value, other._hash_value);
+  mini::swap(_finalized, other._finalized);
+}
+
+//
+// operations.
+//
+
+template <
+  hash_algorithm_type HASH_ALGORITHM
+>
+void
+hash<HASH_ALGORITHM>::update(
+  const byte_buffer_ref input
+  )
+{
+  if (_finalized)
+  {
+    return;
+  }
+
+  if (_md_context)
+  {
+    EVP_DigestUpdate(_md_context, input.get_buffer(), input.get_size());
+  }
+  else if (_mac_context)
+  {
+    EVP_MAC_update(_mac_context, input.get_buffer(), input.get_size());
+  }
+}
+
+template <
+  hash_algorithm_type HASH_ALGORITHM
+>
+byte_buffer
+hash<HASH_ALGORITHM>::compute(
+  const byte_buffer_ref input
+  )
+{
+  byte_buffer result(hash_size_in_bytes);
+
+  EVP_Digest(
+    input.get_buffer(),
+    input.get_size(),
+    result.get_buffer(),
+    nullptr,
+    detail::get_hash_algorithm(HASH_ALGORITHM),
+    nullptr);
+
+  return result;
+}
+
+//
+// accessors.
+//
+
+template <
+  hash_algorithm_type HASH_ALGORITHM
+>
+void
+hash<HASH_ALGORITHM>::get(
+  mutable_byte_buffer_ref output
+  )
+{
+  mini_assert(output.get_size() >= hash_size_in_bytes);
+
+  if (!_finalized)
+  {
+    if (_md_context)
+    {
+      EVP_DigestFinal_ex(_md_context, _hash_value, nullptr);
+    }
+    else if (_mac_context)
+    {
+      size_t output_size;
+      EVP_MAC_final(_mac_context, _hash_value, &output_size, sizeof(_hash_value));
+    }
+
+    _finalized = true;
+  }
+
+  memory::copy(output.get_buffer(), _hash_value, hash_size_in_bytes);
+}
+
+template <
+  hash_algorithm_type HASH_ALGORITHM
+>
+byte_buffer
+hash<HASH_ALGORITHM>::get(
+  void
+  )
+{
+  byte_buffer result(hash_size_in_bytes);
+  get(result);
+
+  return result;
+}
+
+//
+// protected methods.
+//
+
+template <
+  hash_algorithm_type HASH_ALGORITHM
+>
+void
+hash<HASH_ALGORITHM>::init(
+  void
+  )
+{
+  destroy();
+
+  _md_context = EVP_MD_CTX_new();
+  EVP_DigestInit_ex(_md_context, detail::get_hash_algorithm(HASH_ALGORITHM), nullptr);
+}
+
+template <
+  hash_algorithm_type HASH_ALGORITHM
+>
+void
+hash<HASH_ALGORITHM>::init(
+  const byte_buffer_ref key
+  )
+{
+  destroy();
+
+  const OSSL_PARAM params[] = {
+    OSSL_PARAM_construct_utf8_string(
+      OSSL_MAC_PARAM_DIGEST,
+      const_cast<char*>(EVP_MD_get0_name(detail::get_hash_algorithm(HASH_ALGORITHM))),
+      0),
+    OSSL_PARAM_construct_end()
+  };
+
+  _mac_context = EVP_MAC_CTX_new(detail::get_hmac());
+  EVP_MAC_init(_mac_context, key.get_buffer(), key.get_size(), params);
+}
+
+template <
+  hash_algorithm_type HASH_ALGORITHM
+>
+void
+hash<HASH_ALGORITHM>::destroy(
+  void
+  )
+{
+  if (_md_context)
+  {
+    EVP_MD_CTX_free(_md_context);
+    _md_context = nullptr;
+  }
+
+  if (_mac_context)
+  {
+    EVP_MAC_CTX_free(_mac_context);
+    _mac_context = nullptr;
+  }
+
+  _finalized = false;
+}
+
+template <
+  hash_algorithm_type HASH_ALGORITHM
+>
+void
+hash<HASH_ALGORITHM>::duplicate_internal(
+  const hash& other
+  )
+{
+  destroy();
+
+  if (other._md_context)
+  {
+    _md_context = EVP_MD_CTX_new();
+    EVP_MD_CTX_copy_ex(_md_context, other._md_context);
+  }
+  else if (other._mac_context)
+  {
+    _mac_context = EVP_MAC_CTX_dup(other._mac_context);
+  }
+
+  memory::copy(_hash_value, other._hash_value, hash_size_in_bytes);
+  _finalized = other._finalized;
+}
+
+}
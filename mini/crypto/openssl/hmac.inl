@@ -0,0 +1,129 @@
+#include "hmac.h"
+
+#include <openssl/hmac.h>
+
+namespace mini::crypto::openssl {
+
+//
+// constructors.
+//
+
+template <
+  typename HASH_TYPE
+>
+hmac<HASH_TYPE>::hmac(
+  const byte_buffer_ref key
+  )
+  : HASH_TYPE(key)
+{
+
+}
+
+template <
+  typename HASH_TYPE
+>
+hmac<HASH_TYPE>::hmac(
+  const hmac& other
+  )
+  : HASH_TYPE(other)
+{
+
+}
+
+template <
+  typename HASH_TYPE
+>
+hmac<HASH_TYPE>::hmac(
+  hmac&& other
+  )
+  : HASH_TYPE(std::move(other))
+{
+
+}
+
+//
+// assign operators.
+//
+
+template <
+  typename HASH_TYPE
+>
+hmac<HASH_TYPE>&
+hmac<HASH_TYPE>::operator=(
+  const hmac& other
+  )
+{
+  HASH_TYPE::operator=(other);
+  return *this;
+}
+
+template <
+  typename HASH_TYPE
+>
+hmac<HASH_TYPE>&
+hmac<HASH_TYPE>::operator=(
+  hmac&& other
+  )
+{
+  swap(other);
+  return *this;
+}
+
+template <
+  typename HASH_TYPE
+>
+hmac<HASH_TYPE>
+hmac<HASH_TYPE>::duplicate(
+  void
+  )
+{
+  return hmac<HASH_TYPE>(*this);
+}
+
+//
+// swap.
+//
+
+template <
+  typename HASH_TYPE
+>
+void
+hmac<HASH_TYPE>::swap(
+  hmac& other
+  )
+{
+  HASH_TYPE::swap(other);
+}
+
+//
+// operations.
+//
+
+template <
+  typename HASH_TYPE
+>
+byte_buffer
+hmac<HASH_TYPE>::compute(
+  const byte_buffer_ref key,
+  const byte_buffer_ref input
+  )
+{
+  //
+  // one-shot HMAC() avoids the allocation
+  // of the EVP_MAC context.
+  //
+  byte_buffer result(hash_size_in_bytes);
+
+  HMAC(
+    detail::get_hash_algorithm(hash_algorithm),
+    key.get_buffer(),
+    static_cast<int>(key.get_size()),
+    input.get_buffer(),
+    input.get_size(),
+    result.get_buffer(),
+    nullptr);
+
+  return result;
+}
+
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include "../base/key.h"
+
+#include <mini/common.h>
+
+#include <openssl/evp.h>
+
+namespace mini::crypto::openssl {
+
+//
+// OpenSSL EVP key.
+//
+
+class key
+  : public base::key
+{
+  public:
+    ~key(
+      void
+      ) override
+    {
+      destroy();
+    }
+
+    void
+    destroy(
+      void
+      ) override
+    {
+      if (_key_handle)
+      {
+        EVP_PKEY_free(_key_handle);
+        _key_handle = nullptr;
+      }
+    }
+
+    EVP_PKEY*
+    get_handle(
+      void
+      ) const
+    {
+      return _key_handle;
+    }
+
+    operator bool(
+      void
+      ) const
+    {
+      return _key_handle != nullptr;
+    }
+
+  protected:
+    key(
+      void
+      ) = default;
+
+    void
+    swap(
+      key& other
+      )
+    {
+      mini::swap(_key_handle, other._key_handle);
+    }
+
+    EVP_PKEY* _key_handle = nullptr;
+};
+
+}
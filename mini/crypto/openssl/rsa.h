@@ -0,0 +1,159 @@
+#pragma once
+#include "key.h"
+#include "../common.h"
+
+#include <mini/byte_buffer.h>
+#include <mini/string.h>
+
+namespace mini::crypto::openssl {
+
+template <size_type KEY_SIZE> class rsa_public_key;
+template <size_type KEY_SIZE> class rsa_private_key;
+
+template <
+  size_type KEY_SIZE
+>
+class rsa_public_key
+  : public key
+{
+  MINI_MAKE_NONCOPYABLE(rsa_public_key);
+
+  public:
+    static constexpr size_type key_size          = KEY_SIZE;
+    static constexpr size_type key_size_in_bytes = KEY_SIZE / 8;
+
+    rsa_public_key(
+      void
+      ) = default;
+
+    rsa_public_key(
+      rsa_public_key&& other
+      );
+
+    rsa_public_key&
+    operator=(
+      rsa_public_key&& other
+      );
+
+    void
+    swap(
+      rsa_public_key& other
+      );
+
+    //
+    // import.
+    //
+
+    static rsa_public_key<KEY_SIZE>
+    make_from_der(
+      const byte_buffer_ref key
+      );
+
+    static rsa_public_key<KEY_SIZE>
+    make_from_pem(
+      const string_ref key
+      );
+
+    void
+    import_from_der(
+      const byte_buffer_ref key
+      );
+
+    void
+    import_from_pem(
+      const string_ref key
+      );
+
+    byte_buffer
+    encrypt(
+      const byte_buffer_ref input,
+      rsa_encryption_padding padding,
+      bool do_final
+      );
+};
+
+template <
+  size_type KEY_SIZE
+>
+class rsa_private_key
+  : public key
+{
+  MINI_MAKE_NONCOPYABLE(rsa_private_key);
+
+  public:
+    static constexpr size_type key_size          = KEY_SIZE;
+    static constexpr size_type key_size_in_bytes = KEY_SIZE / 8;
+
+    rsa_private_key(
+      void
+      ) = default;
+
+    rsa_private_key(
+      rsa_private_key&& other
+      );
+
+    rsa_private_key&
+    operator=(
+      rsa_private_key&& other
+      );
+
+    void
+    swap(
+      rsa_private_key& other
+      );
+
+    //
+    // import.
+    //
+
+    static rsa_private_key<KEY_SIZE>
+    make_from_der(
+      const byte_buffer_ref key
+      );
+
+    static rsa_private_key<KEY_SIZE>
+    make_from_pem(
+      const string_ref key
+      );
+
+    void
+    import_from_der(
+      const byte_buffer_ref key
+      );
+
+    void
+    import_from_pem(
+      const string_ref key
+      );
+
+    rsa_public_key<KEY_SIZE>
+    export_public_key(
+      void
+      ) const;
+
+    byte_buffer
+    decrypt(
+      const byte_buffer_ref input,
+      rsa_encryption_padding padding,
+      bool do_final
+      );
+};
+
+template <
+  size_type KEY_SIZE
+>
+class rsa
+{
+  MINI_MAKE_NONCOPYABLE(rsa);
+
+  public:
+    static constexpr size_type key_size          = KEY_SIZE;
+    static constexpr size_type key_size_in_bytes = KEY_SIZE / 8;
+
+    using public_key  = rsa_public_key<KEY_SIZE>;
+    using private_key = rsa_private_key<KEY_SIZE>;
+};
+
+}
+
+#include "rsa.inl"
@@ -0,0 +1,327 @@
+#include "rsa.h"
+#include "../base64.h" // for conversion between der & pem.
+
+#include <openssl/rsa.h>
+#include <openssl/x509.h>
+
+namespace mini::crypto::openssl {
+
+namespace detail {
+
+  //
+  // map each value from rsa_encryption_padding to its
+  // corresponding OpenSSL definition.
+  //
+  static constexpr int rsa_encryption_padding_map[] = {
+    RSA_PKCS1_PADDING,
+    RSA_PKCS1_OAEP_PADDING,
+  };
+
+  //
+  // EVP_PKEY_encrypt() & EVP_PKEY_decrypt() share the signature.
+  //
+  using rsa_init_function  = int (*)(EVP_PKEY_CTX*);
+  using rsa_crypt_function = int (*)(EVP_PKEY_CTX*, unsigned char*, size_t*, const unsigned char*, size_t);
+
+  static inline byte_buffer
+  rsa_crypt(
+    EVP_PKEY* key_handle,
+    rsa_init_function init_function,
+    rsa_crypt_function crypt_function,
+    const byte_buffer_ref input,
+    rsa_encryption_padding padding
+    )
+  {
+    byte_buffer result;
+
+    EVP_PKEY_CTX* context = EVP_PKEY_CTX_new(key_handle, nullptr);
+
+    if (!context)
+    {
+      return result;
+    }
+
+    size_t output_size = 0;
+
+    //
+    // the default OAEP digest & MGF1 digest are sha1.
+    //
+    if (init_function(context) > 0 &&
+        EVP_PKEY_CTX_set_rsa_padding(context, rsa_encryption_padding_map[static_cast<int>(padding)]) > 0 &&
+        crypt_function(context, nullptr, &output_size, input.get_buffer(), input.get_size()) > 0)
+    {
+      result.resize(output_size);
+
+      if (crypt_function(context, result.get_buffer(), &output_size, input.get_buffer(), input.get_size()) > 0)
+      {
+        result.resize(output_size);
+      }
+      else
+      {
+        result.clear();
+      }
+    }
+
+    EVP_PKEY_CTX_free(context);
+    return result;
+  }
+
+}
+
+//
+// RSA
+// public key.
+//
+
+template <
+  size_type KEY_SIZE
+>
+rsa_public_key<KEY_SIZE>::rsa_public_key(
+  rsa_public_key&& other
+  )
+{
+  swap(other);
+}
+
+template <
+  size_type KEY_SIZE
+>
+rsa_public_key<KEY_SIZE>&
+rsa_public_key<KEY_SIZE>::operator=(
+  rsa_public_key&& other
+  )
+{
+  swap(other);
+  return *this;
+}
+
+template <
+  size_type KEY_SIZE
+>
+void
+rsa_public_key<KEY_SIZE>::swap(
+  rsa_public_key& other
+  )
+{
+  key::swap(other);
+}
+
+//
+// import.
+//
+
+template <
+  size_type KEY_SIZE
+>
+rsa_public_key<KEY_SIZE>
+rsa_public_key<KEY_SIZE>::make_from_der(
+  const byte_buffer_ref key
+  )
+{
+  rsa_public_key<KEY_SIZE> result;
+  result.import_from_der(key);
+  return result;
+}
+
+template <
+  size_type KEY_SIZE
+>
+rsa_public_key<KEY_SIZE>
+rsa_public_key<KEY_SIZE>::make_from_pem(
+  const string_ref key
+  )
+{
+  return make_from_der(base64::decode(key));
+}
+
+template <
+  size_type KEY_SIZE
+>
+void
+rsa_public_key<KEY_SIZE>::import_from_der(
+  const byte_buffer_ref key
+  )
+{
+  destroy();
+
+  //
+  // PKCS#1 RSAPublicKey.
+  //
+  const unsigned char* der = key.get_buffer();
+  _key_handle = d2i_PublicKey(EVP_PKEY_RSA, nullptr, &der, static_cast<long>(key.get_size()));
+}
+
+template <
+  size_type KEY_SIZE
+>
+void
+rsa_public_key<KEY_SIZE>::import_from_pem(
+  const string_ref key
+  )
+{
+  import_from_der(base64::decode(key));
+}
+
+template <
+  size_type KEY_SIZE
+>
+byte_buffer
+rsa_public_key<KEY_SIZE>::encrypt(
+  const byte_buffer_ref input,
+  rsa_encryption_padding padding,
+  bool /*do_final*/
+  )
+{
+  mini_assert(_key_handle != nullptr);
+
+  return detail::rsa_crypt(
+    _key_handle,
+    &EVP_PKEY_encrypt_init,
+    &EVP_PKEY_encrypt,
+    input,
+    padding);
+}
+
+//
+// RSA
+// private key.
+//
+
+template <
+  size_type KEY_SIZE
+>
+rsa_private_key<KEY_SIZE>::rsa_private_key(
+  rsa_private_key&& other
+  )
+{
+  swap(other);
+}
+
+template <
+  size_type KEY_SIZE
+>
+rsa_private_key<KEY_SIZE>&
+rsa_private_key<KEY_SIZE>::operator=(
+  rsa_private_key&& other
+  )
+{
+  swap(other);
+  return *this;
+}
+
+template <
+  size_type KEY_SIZE
+>
+void
+rsa_private_key<KEY_SIZE>::swap(
+  rsa_private_key& other
+  )
+{
+  key::swap(other);
+}
+
+//
+// import.
+//
+
+template <
+  size_type KEY_SIZE
+>
+rsa_private_key<KEY_SIZE>
+rsa_private_key<KEY_SIZE>::make_from_der(
+  const byte_buffer_ref key
+  )
+{
+  rsa_private_key<KEY_SIZE> result;
+  result.import_from_der(key);
+  return result;
+}
+
+template <
+  size_type KEY_SIZE
+>
+rsa_private_key<KEY_SIZE>
+rsa_private_key<KEY_SIZE>::make_from_pem(
+  const string_ref key
+  )
+{
+  return make_from_der(base64::decode(key));
+}
+
+template <
+  size_type KEY_SIZE
+>
+void
+rsa_private_key<KEY_SIZE>::import_from_der(
+  const byte_buffer_ref key
+  )
+{
+  destroy();
+
+  //
+  // PKCS#1 RSAPrivateKey.
+  //
+  const unsigned char* der = key.get_buffer();
+  _key_handle = d2i_PrivateKey(EVP_PKEY_RSA, nullptr, &der, static_cast<long>(key.get_size()));
+}
+
+template <
+  size_type KEY_SIZE
+>
+void
+rsa_private_key<KEY_SIZE>::import_from_pem(
+  const string_ref key
+  )
+{
+  import_from_der(base64::decode(key));
+}
+
+//
+// export.
+//
+
+template <
+  size_type KEY_SIZE
+>
+rsa_public_key<KEY_SIZE>
+rsa_private_key<KEY_SIZE>::export_public_key(
+  void
+  ) const
+{
+  mini_assert(_key_handle != nullptr);
+
+  unsigned char* der = nullptr;
+  const int der_size = i2d_PublicKey(_key_handle, &der);
+
+  rsa_public_key<KEY_SIZE> result;
+
+  if (der_size > 0)
+  {
+    result.import_from_der(byte_buffer_ref(der, der + der_size));
+    OPENSSL_free(der);
+  }
+
+  return result;
+}
+
+template <
+  size_type KEY_SIZE
+>
+byte_buffer
+rsa_private_key<KEY_SIZE>::decrypt(
+  const byte_buffer_ref input,
+  rsa_encryption_padding padding,
+  bool /*do_final*/
+  )
+{
+  mini_assert(_key_handle != nullptr);
+
+  return detail::rsa_crypt(
+    _key_handle,
+    &EVP_PKEY_decrypt_init,
+    &EVP_PKEY_decrypt,
+    input,
+    padding);
+}
+
+}
@@ -2,6 +2,9 @@
 #include "common.h"
 #include "capi/rsa.h"
 #include "cng/rsa.h"
+#ifndef MINI_OS_WINDOWS
+#include "openssl/rsa.h"
+#endif
 
 namespace mini::crypto {
 
@@ -3,6 +3,8 @@
 #include "capi/hash.h"
 #ifdef MINI_OS_WINDOWS
 #include "cng/hash.h"
+#else
+#include "openssl/hash.h"
 #endif
 
 namespace mini::crypto {
@@ -56,7 +56,12 @@ struct hash_impl<
     const T& value
     ) const
   {
-    return reinterpret_cast<size_type>(value);
+    //
+    // the lowest bits are always zero due to the alignment,
+    // mix in the higher ones so the hashset buckets are used.
+    //
+    const size_type address = reinterpret_cast<size_type>(value);
+    return address ^ (address >> 4);
   }
 };
 
@@ -94,7 +99,12 @@ struct hash_impl<
     T* const& value
     ) const
   {
-    return reinterpret_cast<size_type>(value);
+    //
+    // the lowest bits are always zero due to the alignment,
+    // mix in the higher ones so the hashset buckets are used.
+    //
+    const size_type address = reinterpret_cast<size_type>(value);
+    return address ^ (address >> 4);
   }
 };
 
@@ -113,7 +123,12 @@ struct hash_impl<
     T* const& value
     ) const
   {
-    return reinterpret_cast<size_type>(value);
+    //
+    // the lowest bits are always zero due to the alignment,
+    // mix in the higher ones so the hashset buckets are used.
+    //
+    const size_type address = reinterpret_cast<size_type>(value);
+    return address ^ (address >> 4);
   }
 };
 
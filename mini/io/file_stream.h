@@ -172,7 +172,7 @@ class file_stream
       // File mode
       if (_mode == file_mode::create || _mode == file_mode::create_new)
         flags |= O_CREAT | O_TRUNC;
-      else if (_mode == file_mode::open_or_create)
+      else if (_mode == file_mode::open_or_create || _mode == file_mode::append)
         flags |= O_CREAT;
       else if (_mode == file_mode::truncate)
         flags |= O_TRUNC;
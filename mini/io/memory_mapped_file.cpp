@@ -0,0 +1,155 @@
+#include "memory_mapped_file.h"
+
+#ifndef MINI_OS_WINDOWS
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace mini::io {
+
+memory_mapped_file::memory_mapped_file(
+  const string_ref path
+  )
+{
+  open(path);
+}
+
+memory_mapped_file::~memory_mapped_file(
+  void
+  )
+{
+  close();
+}
+
+bool
+memory_mapped_file::open(
+  const string_ref path
+  )
+{
+  close();
+
+#ifdef MINI_OS_WINDOWS
+  _file_handle = CreateFile(
+    path.get_buffer(),
+    GENERIC_READ,
+    FILE_SHARE_READ,
+    NULL,
+    OPEN_EXISTING,
+    FILE_FLAG_RANDOM_ACCESS,
+    NULL);
+
+  if (_file_handle == INVALID_HANDLE_VALUE)
+  {
+    return false;
+  }
+
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(_file_handle, &file_size) || file_size.QuadPart == 0)
+  {
+    close();
+    return false;
+  }
+
+  _mapping_handle = CreateFileMapping(_file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+
+  if (!_mapping_handle)
+  {
+    close();
+    return false;
+  }
+
+  _view = MapViewOfFile(_mapping_handle, FILE_MAP_READ, 0, 0, 0);
+  _size = static_cast<size_type>(file_size.QuadPart);
+#else
+  _file_descriptor = ::open(path.get_buffer(), O_RDONLY | O_CLOEXEC);
+
+  if (_file_descriptor == -1)
+  {
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(_file_descriptor, &st) != 0 || st.st_size == 0)
+  {
+    close();
+    return false;
+  }
+
+  _view = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, _file_descriptor, 0);
+  _size = static_cast<size_type>(st.st_size);
+
+  if (_view == MAP_FAILED)
+  {
+    _view = nullptr;
+  }
+#endif
+
+  if (!_view)
+  {
+    close();
+    return false;
+  }
+
+  return true;
+}
+
+void
+memory_mapped_file::close(
+  void
+  )
+{
+#ifdef MINI_OS_WINDOWS
+  if (_view)
+  {
+    UnmapViewOfFile(_view);
+  }
+
+  if (_mapping_handle)
+  {
+    CloseHandle(_mapping_handle);
+    _mapping_handle = NULL;
+  }
+
+  if (_file_handle != INVALID_HANDLE_VALUE)
+  {
+    CloseHandle(_file_handle);
+    _file_handle = INVALID_HANDLE_VALUE;
+  }
+#else
+  if (_view)
+  {
+    munmap(_view, _size);
+  }
+
+  if (_file_descriptor != -1)
+  {
+    ::close(_file_descriptor);
+    _file_descriptor = -1;
+  }
+#endif
+
+  _view = nullptr;
+  _size = 0;
+}
+
+bool
+memory_mapped_file::is_open(
+  void
+  ) const
+{
+  return _view != nullptr;
+}
+
+byte_buffer_ref
+memory_mapped_file::get_buffer(
+  void
+  ) const
+{
+  const byte_type* view = static_cast<const byte_type*>(_view);
+
+  return byte_buffer_ref(view, view + _size);
+}
+
+}
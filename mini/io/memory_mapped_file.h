@@ -0,0 +1,68 @@
+#pragma once
+#include <mini/common.h>
+#include <mini/string_ref.h>
+#include <mini/byte_buffer_ref.h>
+
+#ifdef MINI_OS_WINDOWS
+#include <windows.h>
+#endif
+
+namespace mini::io {
+
+//
+// read-only view of the whole file.
+//
+
+class memory_mapped_file
+{
+  MINI_MAKE_NONCOPYABLE(memory_mapped_file);
+
+  public:
+    memory_mapped_file(
+      void
+      ) = default;
+
+    memory_mapped_file(
+      const string_ref path
+      );
+
+    ~memory_mapped_file(
+      void
+      );
+
+    bool
+    open(
+      const string_ref path
+      );
+
+    void
+    close(
+      void
+      );
+
+    bool
+    is_open(
+      void
+      ) const;
+
+    //
+    // valid until close().
+    //
+    byte_buffer_ref
+    get_buffer(
+      void
+      ) const;
+
+  private:
+#ifdef MINI_OS_WINDOWS
+    HANDLE _file_handle = INVALID_HANDLE_VALUE;
+    HANDLE _mapping_handle = NULL;
+#else
+    int _file_descriptor = -1;
+#endif
+
+    void* _view = nullptr;
+    size_type _size = 0;
+};
+
+}
@@ -17,6 +17,13 @@ class stream
     //
     static constexpr size_type error  = (size_type)-1;
 
+    //
+    // this value is returned by non-blocking reads
+    // when there are no data available right now,
+    // and by non-blocking writes when nothing can be written.
+    //
+    static constexpr size_type would_block = (size_type)-2;
+
     static bool
     success(
       size_type return_value
@@ -24,7 +31,8 @@ class stream
     {
       return
         return_value != closed &&
-        return_value != error;
+        return_value != error &&
+        return_value != would_block;
     }
 
     enum seek_origin
@@ -8,6 +8,15 @@
 # include <ntddk.h>
 #endif
 
+//
+// SSE2 is part of the x64 baseline, the kernel mode
+// code doesn't touch the vector registers.
+//
+#if !defined(MINI_MODE_KERNEL) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+# define MINI_MEMORY_USE_SSE2
+# include <emmintrin.h>
+#endif
+
 namespace mini::memory {
 
 namespace detail {
@@ -169,6 +178,58 @@ move(
   return memmove(destination, source, size);
 }
 
+void*
+exclusive_or(
+  void* destination,
+  const void* source,
+  size_t size
+  )
+{
+  byte_type* destination_bytes = reinterpret_cast<byte_type*>(destination);
+  const byte_type* source_bytes = reinterpret_cast<const byte_type*>(source);
+
+  size_t i = 0;
+
+#if defined(MINI_MEMORY_USE_SSE2)
+  for (; i + 4 * sizeof(__m128i) <= size; i += 4 * sizeof(__m128i))
+  {
+    __m128i* d = reinterpret_cast<__m128i*>(destination_bytes + i);
+    const __m128i* s = reinterpret_cast<const __m128i*>(source_bytes + i);
+
+    _mm_storeu_si128(d + 0, _mm_xor_si128(_mm_loadu_si128(d + 0), _mm_loadu_si128(s + 0)));
+    _mm_storeu_si128(d + 1, _mm_xor_si128(_mm_loadu_si128(d + 1), _mm_loadu_si128(s + 1)));
+    _mm_storeu_si128(d + 2, _mm_xor_si128(_mm_loadu_si128(d + 2), _mm_loadu_si128(s + 2)));
+    _mm_storeu_si128(d + 3, _mm_xor_si128(_mm_loadu_si128(d + 3), _mm_loadu_si128(s + 3)));
+  }
+
+  for (; i + sizeof(__m128i) <= size; i += sizeof(__m128i))
+  {
+    __m128i* d = reinterpret_cast<__m128i*>(destination_bytes + i);
+    const __m128i* s = reinterpret_cast<const __m128i*>(source_bytes + i);
+
+    _mm_storeu_si128(d, _mm_xor_si128(_mm_loadu_si128(d), _mm_loadu_si128(s)));
+  }
+#endif
+
+  for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+  {
+    uint64_t d;
+    uint64_t s;
+    memcpy(&d, destination_bytes + i, sizeof(d));
+    memcpy(&s, source_bytes + i, sizeof(s));
+
+    d ^= s;
+    memcpy(destination_bytes + i, &d, sizeof(d));
+  }
+
+  for (; i < size; i++)
+  {
+    destination_bytes[i] ^= source_bytes[i];
+  }
+
+  return destination;
+}
+
 int
 compare(
   const void* lhs,
@@ -47,6 +47,16 @@ move(
   size_t size
   );
 
+//
+// destination[i] ^= source[i]
+//
+void*
+exclusive_or(
+  void* destination,
+  const void* source,
+  size_t size
+  );
+
 int
 compare(
   const void* lhs,
@@ -3,6 +3,7 @@
 #ifndef MINI_OS_WINDOWS
 
 #include <mini/logger.h>
+#include <mini/memory.h>
 
 namespace mini::net::detail {
 
@@ -24,10 +25,13 @@ ssl_context::ssl_context(
   )
   : _ssl_ctx(nullptr)
   , _ssl(nullptr)
+  , _read_bio(nullptr)
+  , _write_bio(nullptr)
   , _socket(nullptr)
   , _closed(true)
   , _payload_recv(new byte_type[max_record_size])
   , _payload_recv_size(0)
+  , _pending_output_offset(0)
 {
   _init_openssl();
 }
@@ -71,11 +75,19 @@ ssl_context::initialize(
     return -1;
   }
 
-  // Configurer le mode BIO personnalisé
-  BIO* bio = BIO_new(BIO_s_mem());
-  if (!bio)
+  //
+  // OpenSSL doesn't touch the socket, the encrypted data
+  // are passed through separate read/write memory BIOs.
+  //
+  _read_bio = BIO_new(BIO_s_mem());
+  _write_bio = BIO_new(BIO_s_mem());
+  if (!_read_bio || !_write_bio)
   {
     mini_warning("BIO_new failed");
+    BIO_free(_read_bio);
+    BIO_free(_write_bio);
+    _read_bio = nullptr;
+    _write_bio = nullptr;
     SSL_free(_ssl);
     _ssl = nullptr;
     SSL_CTX_free(_ssl_ctx);
@@ -83,8 +95,12 @@ ssl_context::initialize(
     return -1;
   }
 
-  SSL_set_bio(_ssl, bio, bio);
-  
+  //
+  // the SSL object takes the ownership of the BIOs.
+  //
+  SSL_set_bio(_ssl, _read_bio, _write_bio);
+  SSL_set_connect_state(_ssl);
+
   return 0;
 }
 
@@ -97,6 +113,8 @@ ssl_context::destroy(
   {
     SSL_free(_ssl);
     _ssl = nullptr;
+    _read_bio = nullptr;
+    _write_bio = nullptr;
   }
 
   if (_ssl_ctx)
@@ -126,22 +144,45 @@ ssl_context::handshake(
     return -1;
   }
 
-  // Effectuer la poignée de main SSL
-  int result = SSL_connect(_ssl);
-  if (result != 1)
+  for (;;)
   {
-    int ssl_error = SSL_get_error(_ssl, result);
-    mini_warning("SSL_connect failed with error: %d", ssl_error);
-    return -1;
-  }
+    int result;
+    int ssl_error;
 
-  // Vérifier le certificat
-  if (SSL_get_verify_result(_ssl) != X509_V_OK)
-  {
-    mini_warning("Certificate verification failed");
-    // On continue quand même, car Tor n'utilise pas de certificats standards
+    mini_lock(_ssl_mutex)
+    {
+      result = SSL_do_handshake(_ssl);
+      ssl_error = SSL_get_error(_ssl, result);
+    }
+
+    if (!flush_output())
+    {
+      return -1;
+    }
+
+    if (result == 1)
+    {
+      break;
+    }
+
+    if (ssl_error != SSL_ERROR_WANT_READ)
+    {
+      mini_warning("SSL_do_handshake failed with error: %d", ssl_error);
+      return -1;
+    }
+
+    if (!io::stream::success(fill_input()))
+    {
+      mini_warning("ssl_context::handshake() connection closed");
+      return -1;
+    }
   }
 
+  //
+  // tor relays use self-signed certificates,
+  // the identity is verified by the link handshake.
+  //
+
   return 0;
 }
 
@@ -155,14 +196,13 @@ ssl_context::disconnect(
     return -1;
   }
 
-  int result = SSL_shutdown(_ssl);
-  if (result < 0)
+  mini_lock(_ssl_mutex)
   {
-    int ssl_error = SSL_get_error(_ssl, result);
-    mini_warning("SSL_shutdown failed with error: %d", ssl_error);
-    return -1;
+    SSL_shutdown(_ssl);
   }
 
+  flush_output();
+
   destroy();
   return 0;
 }
@@ -177,26 +217,32 @@ ssl_context::write(
     return 0;
   }
 
-  int bytes_written = SSL_write(_ssl, buffer.get_buffer(), (int)buffer.get_size());
-  if (bytes_written <= 0)
-  {
-    int ssl_error = SSL_get_error(_ssl, bytes_written);
-    mini_warning("SSL_write failed with error: %d", ssl_error);
-    return 0;
-  }
+  int bytes_written;
 
-  // Récupérer les données du BIO et les envoyer via le socket
-  char bio_buffer[max_record_size];
-  int pending = BIO_ctrl_pending(SSL_get_wbio(_ssl));
-  if (pending > 0)
+  mini_lock(_ssl_mutex)
   {
-    int read = BIO_read(SSL_get_wbio(_ssl), bio_buffer, pending);
-    if (read > 0)
+    //
+    // memory BIO never blocks, SSL_write()
+    // encrypts the whole buffer at once.
+    //
+    bytes_written = SSL_write(_ssl, buffer.get_buffer(), (int)buffer.get_size());
+    if (bytes_written <= 0)
     {
-      return _socket->write(bio_buffer, read);
+      int ssl_error = SSL_get_error(_ssl, bytes_written);
+      mini_warning("SSL_write failed with error: %d", ssl_error);
+      return 0;
     }
   }
 
+  //
+  // the reader isn't blocked while
+  // the records are being sent.
+  //
+  if (!flush_output())
+  {
+    return 0;
+  }
+
   return bytes_written;
 }
 
@@ -210,38 +256,169 @@ ssl_context::read(
     return 0;
   }
 
-  // Lire les données du socket et les mettre dans le BIO
-  size_type bytes_read = _socket->read(_payload_recv, max_record_size);
-  if (bytes_read > 0)
+  for (;;)
   {
-    BIO_write(SSL_get_rbio(_ssl), _payload_recv, (int)bytes_read);
+    int ssl_bytes_read;
+    int ssl_error;
+
+    //
+    // return the already decrypted data first.
+    //
+    mini_lock(_ssl_mutex)
+    {
+      //
+      // if the peer requests a key update or renegotiation,
+      // the answer stays in the write BIO, it is written
+      // by the next write() or flush(). the reader
+      // (possibly the reactor thread) never blocks on the socket write.
+      //
+      ssl_bytes_read = SSL_read(_ssl, buffer.get_buffer(), (int)buffer.get_size());
+      ssl_error = SSL_get_error(_ssl, ssl_bytes_read);
+    }
+
+    if (ssl_bytes_read > 0)
+    {
+      return ssl_bytes_read;
+    }
+
+    if (ssl_error != SSL_ERROR_WANT_READ)
+    {
+      if (ssl_error != SSL_ERROR_ZERO_RETURN)
+      {
+        mini_warning("SSL_read failed with error: %d", ssl_error);
+      }
+
+      _closed = true;
+      return 0;
+    }
+
+    //
+    // incomplete record, read more from the socket.
+    //
+    const size_type bytes_read = fill_input();
+
+    if (bytes_read == io::stream::would_block)
+    {
+      return io::stream::would_block;
+    }
+
+    if (!io::stream::success(bytes_read))
+    {
+      _closed = true;
+      return 0;
+    }
   }
-  else if (bytes_read == 0)
+}
+
+bool
+ssl_context::flush(
+  void
+  )
+{
+  if (!is_valid())
   {
-    // Connection fermée
-    _closed = true;
-    return 0;
+    return false;
   }
 
-  // Lire les données déchiffrées
-  int ssl_bytes_read = SSL_read(_ssl, buffer.get_buffer(), (int)buffer.get_size());
-  if (ssl_bytes_read <= 0)
+  return flush_output();
+}
+
+bool
+ssl_context::has_pending_output(
+  void
+  )
+{
+  mini_lock(_output_mutex)
   {
-    int ssl_error = SSL_get_error(_ssl, ssl_bytes_read);
-    if (ssl_error == SSL_ERROR_WANT_READ)
+    if (_pending_output_offset < _pending_output.get_size())
     {
-      // Besoin de plus de données
-      return 0;
+      return true;
     }
-    else
+
+    mini_lock(_ssl_mutex)
     {
-      mini_warning("SSL_read failed with error: %d", ssl_error);
-      _closed = true;
-      return 0;
+      return _write_bio && BIO_ctrl_pending(_write_bio) > 0;
+    }
+  }
+}
+
+bool
+ssl_context::flush_output(
+  void
+  )
+{
+  mini_lock(_output_mutex)
+  {
+    //
+    // take everything pending at once,
+    // the records are copied out of the BIO
+    // so the socket write is done without the _ssl_mutex.
+    // they are appended behind the records
+    // a non-blocking socket haven't accepted yet.
+    //
+    mini_lock(_ssl_mutex)
+    {
+      char* pending_data = nullptr;
+      const long pending_size = _write_bio
+        ? BIO_get_mem_data(_write_bio, &pending_data)
+        : 0;
+
+      if (pending_size > 0)
+      {
+        _pending_output.add_many(byte_buffer_ref(
+          reinterpret_cast<const byte_type*>(pending_data),
+          reinterpret_cast<const byte_type*>(pending_data) + pending_size));
+
+        (void)BIO_reset(_write_bio);
+      }
+    }
+
+    while (_pending_output_offset < _pending_output.get_size())
+    {
+      const size_type bytes_written = _socket->write(
+        _pending_output.get_buffer() + _pending_output_offset,
+        _pending_output.get_size() - _pending_output_offset);
+
+      //
+      // the rest is written by the next flush.
+      //
+      if (bytes_written == io::stream::would_block)
+      {
+        return true;
+      }
+
+      if (!io::stream::success(bytes_written))
+      {
+        _closed = true;
+        return false;
+      }
+
+      _pending_output_offset += bytes_written;
+    }
+
+    _pending_output.clear();
+    _pending_output_offset = 0;
+  }
+
+  return true;
+}
+
+size_type
+ssl_context::fill_input(
+  void
+  )
+{
+  const size_type bytes_read = _socket->read(_payload_recv, max_record_size);
+
+  if (io::stream::success(bytes_read))
+  {
+    mini_lock(_ssl_mutex)
+    {
+      BIO_write(_read_bio, _payload_recv, (int)bytes_read);
     }
   }
 
-  return ssl_bytes_read;
+  return bytes_read;
 }
 
 size_type
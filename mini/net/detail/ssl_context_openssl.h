@@ -2,6 +2,7 @@
 #include <mini/net/tcp_socket.h>
 #include <mini/byte_buffer.h>
 #include <mini/ptr.h>
+#include <mini/threading/mutex.h>
 
 #ifndef MINI_OS_WINDOWS
 
@@ -61,6 +62,26 @@ class ssl_context
       mutable_byte_buffer_ref buffer
       );
 
+    //
+    // writes the TLS records produced so far
+    // (e.g. by SSL_read() answering a key update)
+    // to the socket.
+    //
+    bool
+    flush(
+      void
+      );
+
+    //
+    // true if SSL_read() produced records
+    // which haven't been written yet, or if
+    // a non-blocking socket didn't accept all of them.
+    //
+    bool
+    has_pending_output(
+      void
+      );
+
     size_type
     get_max_message_size(
       void
@@ -75,15 +96,52 @@ class ssl_context
     static bool _openssl_initialized;
     static void _init_openssl();
 
+    //
+    // moves the TLS records produced by OpenSSL
+    // from the write BIO to the socket.
+    // must not be called under the _ssl_mutex.
+    //
+    bool
+    flush_output(
+      void
+      );
+
+    //
+    // reads once from the socket into the read BIO.
+    //
+    size_type
+    fill_input(
+      void
+      );
+
     SSL_CTX* _ssl_ctx;
     SSL* _ssl;
+    BIO* _read_bio;
+    BIO* _write_bio;
     io::stream* _socket;
     string _target_name;
     bool _closed;
-    
-    // Buffer pour la lecture
+
+    //
+    // buffer for the encrypted data.
+    //
     byte_type* const _payload_recv;
     size_type _payload_recv_size;
+
+    //
+    // SSL object can't be used from multiple threads at once.
+    // the socket reads and writes are performed outside of the lock.
+    //
+    threading::mutex _ssl_mutex;
+
+    //
+    // keeps the records in order when several threads
+    // write to the socket, guards the _pending_output.
+    // the records before the offset are written already.
+    //
+    threading::mutex _output_mutex;
+    byte_buffer _pending_output;
+    size_type _pending_output_offset;
 };
 
 }
@@ -0,0 +1,458 @@
+#include "reactor.h"
+
+#ifdef MINI_OS_LINUX
+
+#include <mini/logger.h>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <errno.h>
+
+namespace mini::net {
+
+thread_local reactor::registration* reactor::_current_registration = nullptr;
+
+reactor::reactor(
+  size_type thread_count
+  )
+  : _thread_count(thread_count)
+{
+
+}
+
+reactor::~reactor(
+  void
+  )
+{
+  stop();
+}
+
+reactor&
+reactor::get_default(
+  void
+  )
+{
+  static reactor default_reactor;
+  return default_reactor;
+}
+
+bool
+reactor::add(
+  int fd,
+  function<void()> on_ready
+  )
+{
+  return add_registration(fd, std::move(on_ready), false);
+}
+
+void
+reactor::request_write(
+  int fd
+  )
+{
+  mini_lock(_registration_map_mutex)
+  {
+    auto it = _registration_map.find(fd);
+
+    if (it == _registration_map.end())
+    {
+      return;
+    }
+
+    registration* current_registration = it->second;
+
+    if (current_registration->write_requested)
+    {
+      return;
+    }
+
+    current_registration->write_requested = true;
+
+    //
+    // the running callback re-arms the socket
+    // itself when it returns.
+    //
+    if (!current_registration->dispatching)
+    {
+      arm(current_registration, EPOLL_CTL_MOD);
+    }
+  }
+}
+
+int
+reactor::add_timer(
+  function<void()> on_expired
+  )
+{
+  const int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+  if (fd == -1)
+  {
+    mini_warning("reactor::add_timer() !! timerfd_create failed with error: %d", errno);
+    return -1;
+  }
+
+  if (!add_registration(fd, std::move(on_expired), true))
+  {
+    ::close(fd);
+    return -1;
+  }
+
+  return fd;
+}
+
+void
+reactor::set_timer(
+  int fd,
+  timeout_type timeout
+  )
+{
+  itimerspec timer_value = {};
+  timer_value.it_value.tv_sec = timeout / 1000;
+  timer_value.it_value.tv_nsec = (timeout % 1000) * 1000 * 1000;
+
+  timerfd_settime(fd, 0, &timer_value, nullptr);
+}
+
+void
+reactor::remove(
+  int fd
+  )
+{
+  registration* removed_registration = nullptr;
+
+  mini_lock(_registration_map_mutex)
+  {
+    auto it = _registration_map.find(fd);
+
+    if (it == _registration_map.end())
+    {
+      return;
+    }
+
+    removed_registration = it->second;
+    removed_registration->removed = true;
+
+    _registration_map.remove(it);
+    epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+
+    //
+    // removed from within its own callback,
+    // the dispatcher deletes it once the callback returns.
+    //
+    if (removed_registration == _current_registration)
+    {
+      removed_registration->removed_by_callback = true;
+      return;
+    }
+
+    //
+    // the timer is closed only after the callback returns,
+    // its fd number can't be reused before.
+    //
+  }
+
+  //
+  // wait for the callback running in other thread.
+  // the dispatcher signals the event while holding the lock,
+  // taking the lock here makes sure it doesn't touch it anymore.
+  //
+  removed_registration->idle_event.wait();
+
+  mini_lock(_registration_map_mutex)
+  {
+    if (removed_registration->is_timer)
+    {
+      ::close(removed_registration->fd);
+    }
+
+    delete removed_registration;
+  }
+}
+
+void
+reactor::start(
+  void
+  )
+{
+  if (_epoll_fd != -1)
+  {
+    return;
+  }
+
+  _epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  _stop_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+  //
+  // the stop event wakes all the threads at once (level-triggered).
+  //
+  epoll_event ev = {};
+  ev.events = EPOLLIN;
+  ev.data.u64 = make_token(_stop_fd, 0);
+  epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, _stop_fd, &ev);
+
+  for (size_type i = 0; i < _thread_count; i++)
+  {
+    ptr<threading::thread_function> thread(new threading::thread_function(
+      [this]() { dispatch_loop(); }));
+
+    thread->start();
+    _thread_list.add(std::move(thread));
+  }
+
+  mini_debug("reactor::start() [threads: %u]", static_cast<uint32_t>(_thread_count));
+}
+
+void
+reactor::stop(
+  void
+  )
+{
+  if (_epoll_fd == -1)
+  {
+    return;
+  }
+
+  const uint64_t value = 1;
+  (void)write(_stop_fd, &value, sizeof(value));
+
+  for (auto& thread : _thread_list)
+  {
+    thread->join();
+  }
+
+  _thread_list.clear();
+
+  for (auto& item : _registration_map)
+  {
+    if (item.second->is_timer)
+    {
+      ::close(item.second->fd);
+    }
+
+    delete item.second;
+  }
+
+  _registration_map.clear();
+
+  ::close(_stop_fd);
+  ::close(_epoll_fd);
+
+  _stop_fd = -1;
+  _epoll_fd = -1;
+}
+
+void
+reactor::dispatch_loop(
+  void
+  )
+{
+  static constexpr int max_events = 16;
+  epoll_event events[max_events];
+
+  for (;;)
+  {
+    const int event_count = epoll_wait(_epoll_fd, events, max_events, -1);
+
+    if (event_count == -1)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+
+      mini_error("reactor::dispatch_loop() !! epoll_wait failed with error: %d", errno);
+      break;
+    }
+
+    for (int i = 0; i < event_count; i++)
+    {
+      if (events[i].data.u64 == make_token(_stop_fd, 0))
+      {
+        return;
+      }
+
+      dispatch(events[i].data.u64);
+    }
+  }
+}
+
+void
+reactor::dispatch(
+  uint64_t token
+  )
+{
+  const int fd = static_cast<int>(token & 0xffffffff);
+  const uint32_t generation = static_cast<uint32_t>(token >> 32);
+
+  registration* current_registration;
+
+  mini_lock(_registration_map_mutex)
+  {
+    auto it = _registration_map.find(fd);
+
+    //
+    // removed in the meantime, or the fd number
+    // belongs to a new registration already.
+    //
+    if (it == _registration_map.end() ||
+        it->second->generation != generation)
+    {
+      return;
+    }
+
+    current_registration = it->second;
+
+    //
+    // request_write() might have re-armed the socket
+    // before the previous event was dispatched,
+    // the running callback is executed once more instead.
+    //
+    if (current_registration->dispatching)
+    {
+      current_registration->dispatch_again = true;
+      return;
+    }
+
+    current_registration->dispatching = true;
+    current_registration->idle_event.reset();
+  }
+
+  for (;;)
+  {
+    if (current_registration->is_timer)
+    {
+      uint64_t expiration_count;
+      (void)read(fd, &expiration_count, sizeof(expiration_count));
+    }
+
+    _current_registration = current_registration;
+    current_registration->on_ready();
+    _current_registration = nullptr;
+
+    mini_lock(_registration_map_mutex)
+    {
+      //
+      // the callback removed its own socket.
+      //
+      if (current_registration->removed_by_callback)
+      {
+        if (current_registration->is_timer)
+        {
+          ::close(fd);
+        }
+
+        delete current_registration;
+        return;
+      }
+
+      if (current_registration->dispatch_again && !current_registration->removed)
+      {
+        current_registration->dispatch_again = false;
+        continue;
+      }
+
+      current_registration->dispatching = false;
+
+      if (!current_registration->removed)
+      {
+        arm(current_registration, EPOLL_CTL_MOD);
+      }
+
+      current_registration->idle_event.set();
+      return;
+    }
+  }
+}
+
+uint64_t
+reactor::make_token(
+  int fd,
+  uint32_t generation
+  )
+{
+  return (static_cast<uint64_t>(generation) << 32) | static_cast<uint32_t>(fd);
+}
+
+bool
+reactor::add_registration(
+  int fd,
+  function<void()> on_ready,
+  bool is_timer
+  )
+{
+  registration* new_registration = new registration {
+    fd,
+    0,
+    std::move(on_ready),
+    threading::event(threading::reset_type::manual_reset, true),
+    is_timer,
+    false,
+    false,
+    false,
+    false,
+    false
+  };
+
+  mini_lock(_registration_map_mutex)
+  {
+    start();
+
+    new_registration->generation = _next_generation++;
+
+    //
+    // 0 is used by the stop event.
+    //
+    if (_next_generation == 0)
+    {
+      _next_generation = 1;
+    }
+
+    _registration_map.insert(fd, new_registration);
+
+    if (!arm(new_registration, EPOLL_CTL_ADD))
+    {
+      mini_warning("reactor::add() !! epoll_ctl failed with error: %d", errno);
+
+      _registration_map.remove(_registration_map.find(fd));
+      delete new_registration;
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool
+reactor::arm(
+  registration* armed_registration,
+  int operation
+  )
+{
+  //
+  // the socket is disarmed after each notification,
+  // so the callback never runs concurrently.
+  //
+  epoll_event ev = {};
+  ev.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+  ev.data.u64 = make_token(armed_registration->fd, armed_registration->generation);
+
+  if (armed_registration->write_requested)
+  {
+    ev.events |= EPOLLOUT;
+  }
+
+  //
+  // the write is requested again by the callback
+  // if it couldn't write everything.
+  //
+  armed_registration->write_requested = false;
+
+  return epoll_ctl(_epoll_fd, operation, armed_registration->fd, &ev) != -1;
+}
+
+}
+
+#endif // MINI_OS_LINUX
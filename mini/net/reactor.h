@@ -0,0 +1,177 @@
+#pragma once
+#include <mini/common.h>
+
+#ifdef MINI_OS_LINUX
+
+#include <mini/ptr.h>
+#include <mini/function.h>
+#include <mini/collections/hashmap.h>
+#include <mini/collections/list.h>
+#include <mini/threading/thread_function.h>
+#include <mini/threading/event.h>
+#include <mini/threading/mutex.h>
+
+namespace mini::net {
+
+//
+// dispatches the readiness of many sockets
+// to a small fixed pool of threads (epoll).
+//
+// the callback of a socket is never executed
+// by more than one thread at a time, the socket
+// is re-armed only after the callback returns.
+// the callback is expected to read until
+// the socket would block, and to write
+// whatever is queued if the write was requested.
+//
+
+class reactor
+{
+  MINI_MAKE_NONCOPYABLE(reactor);
+
+  public:
+    static constexpr size_type thread_count_default = 4;
+
+    reactor(
+      size_type thread_count = thread_count_default
+      );
+
+    ~reactor(
+      void
+      );
+
+    //
+    // the reactor shared by all the connections,
+    // the threads are started on its first use.
+    //
+    static reactor&
+    get_default(
+      void
+      );
+
+    bool
+    add(
+      int fd,
+      function<void()> on_ready
+      );
+
+    //
+    // the callback is executed once the socket becomes
+    // writable as well (once per request).
+    // may be called from any thread.
+    //
+    void
+    request_write(
+      int fd
+      );
+
+    //
+    // creates a one-shot timer dispatched like a socket,
+    // see set_timer(). the timer is destroyed by remove().
+    // returns -1 on failure.
+    //
+    int
+    add_timer(
+      function<void()> on_expired
+      );
+
+    //
+    // (re)starts the timer, 0 stops it.
+    //
+    void
+    set_timer(
+      int fd,
+      timeout_type timeout
+      );
+
+    //
+    // when called outside of the callback, waits
+    // until the running callback of this socket returns.
+    // may be called from within the callback itself.
+    //
+    void
+    remove(
+      int fd
+      );
+
+  private:
+    struct registration
+    {
+      int fd;
+
+      //
+      // distinguishes the registrations of a reused fd number,
+      // an event of the closed socket which is already
+      // returned by epoll_wait() is dropped.
+      //
+      uint32_t generation;
+
+      function<void()> on_ready;
+      threading::event idle_event;
+      bool is_timer;
+      bool write_requested;
+      bool dispatching;
+      bool dispatch_again;
+      bool removed;
+      bool removed_by_callback;
+    };
+
+    static uint64_t
+    make_token(
+      int fd,
+      uint32_t generation
+      );
+
+    bool
+    add_registration(
+      int fd,
+      function<void()> on_ready,
+      bool is_timer
+      );
+
+    //
+    // re-enables the notifications of the socket,
+    // must be called under the _registration_map_mutex.
+    //
+    bool
+    arm(
+      registration* armed_registration,
+      int operation
+      );
+
+    void
+    start(
+      void
+      );
+
+    void
+    stop(
+      void
+      );
+
+    void
+    dispatch_loop(
+      void
+      );
+
+    void
+    dispatch(
+      uint64_t token
+      );
+
+    static thread_local registration* _current_registration;
+
+    int _epoll_fd = -1;
+    int _stop_fd = -1;
+
+    size_type _thread_count;
+    collections::list<ptr<threading::thread_function>> _thread_list;
+
+    collections::hashmap<int, registration*> _registration_map;
+    threading::mutex _registration_map_mutex;
+    uint32_t _next_generation = 1;
+};
+
+}
+
+#endif // MINI_OS_LINUX
@@ -85,7 +85,15 @@ ssl_socket::seek(
 void
 ssl_socket::flush()
 {
+  _ssl_stream.flush();
+}
 
+bool
+ssl_socket::has_pending_output(
+  void
+  )
+{
+  return _ssl_stream.has_pending_output();
 }
 
 size_type
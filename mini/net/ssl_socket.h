@@ -70,6 +70,15 @@ class ssl_socket
       void
       ) const override;
 
+    //
+    // true if the TLS layer has records waiting
+    // for flush() (e.g. an answer to the key update).
+    //
+    bool
+    has_pending_output(
+      void
+      );
+
     tcp_socket&
     get_underlying_socket(
       void
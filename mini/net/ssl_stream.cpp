@@ -100,7 +100,24 @@ ssl_stream::seek(
 void
 ssl_stream::flush()
 {
+#ifndef MINI_OS_WINDOWS
+  if (_context)
+  {
+    _context->flush();
+  }
+#endif
+}
 
+bool
+ssl_stream::has_pending_output(
+  void
+  )
+{
+#ifdef MINI_OS_WINDOWS
+  return false;
+#else
+  return _context && _context->has_pending_output();
+#endif
 }
 
 size_type
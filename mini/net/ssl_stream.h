@@ -66,6 +66,11 @@ class ssl_stream
       void
       ) const override;
 
+    bool
+    has_pending_output(
+      void
+      );
+
     io::stream&
     get_underlying_stream(
       void
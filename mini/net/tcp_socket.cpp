@@ -211,6 +211,30 @@ tcp_socket::is_connected(
   return _socket != INVALID_SOCKET;
 }
 
+SOCKET
+tcp_socket::get_native_handle(
+  void
+  ) const
+{
+  return _socket;
+}
+
+void
+tcp_socket::set_blocking_read(
+  bool blocking_read
+  )
+{
+  _blocking_read = blocking_read;
+}
+
+void
+tcp_socket::set_blocking_write(
+  bool blocking_write
+  )
+{
+  _blocking_write = blocking_write;
+}
+
 size_type
 tcp_socket::read_impl(
   void* buffer,
@@ -225,7 +249,25 @@ tcp_socket::read_impl(
     return 0;
   }
 
-  size_type result = (size_type)recv(_socket, (char*)buffer, (int)size, 0);
+#ifdef MINI_OS_WINDOWS
+  const int flags = 0;
+#else
+  const int flags = _blocking_read ? 0 : MSG_DONTWAIT;
+#endif
+
+  const int recv_result = (int)recv(_socket, (char*)buffer, (int)size, flags);
+
+#ifndef MINI_OS_WINDOWS
+  //
+  // nothing to read right now.
+  //
+  if (recv_result == SOCKET_ERROR && (errno == EAGAIN || errno == EWOULDBLOCK))
+  {
+    return would_block;
+  }
+#endif
+
+  size_type result = (size_type)recv_result;
 
   //
   // close & invalidate socket when we've received 0 bytes.
@@ -260,7 +302,25 @@ tcp_socket::write_impl(
     return 0;
   }
 
-  size_type result = (size_type)send(_socket, (const char*)buffer, (int)size, 0);
+#ifdef MINI_OS_WINDOWS
+  const int flags = 0;
+#else
+  const int flags = _blocking_write ? 0 : MSG_DONTWAIT;
+#endif
+
+  const int send_result = (int)send(_socket, (const char*)buffer, (int)size, flags);
+
+#ifndef MINI_OS_WINDOWS
+  //
+  // the send buffer of the socket is full.
+  //
+  if (send_result == SOCKET_ERROR && (errno == EAGAIN || errno == EWOULDBLOCK))
+  {
+    return would_block;
+  }
+#endif
+
+  size_type result = (size_type)send_result;
 
   //
   // invalidate socket when we've encountered an error.
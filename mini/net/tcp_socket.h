@@ -113,6 +113,30 @@ class tcp_socket
       void
       ) const;
 
+    SOCKET
+    get_native_handle(
+      void
+      ) const;
+
+    //
+    // when disabled, read() returns io::stream::would_block
+    // instead of waiting for the data (not supported on Windows).
+    //
+    void
+    set_blocking_read(
+      bool blocking_read
+      );
+
+    //
+    // when disabled, write() writes only what fits
+    // into the send buffer of the socket, or returns
+    // io::stream::would_block (not supported on Windows).
+    //
+    void
+    set_blocking_write(
+      bool blocking_write
+      );
+
   private:
     size_type
     read_impl(
@@ -131,6 +155,8 @@ class tcp_socket
 
     SOCKET _socket = INVALID_SOCKET;
     uint16_t _port = 0;
+    bool _blocking_read = true;
+    bool _blocking_write = true;
 };
 
 }
\ No newline at end of file
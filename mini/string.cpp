@@ -432,8 +432,15 @@ string::clear(
   void
   )
 {
-  _buffer.clear();
-  _buffer[0] = '\0';
+  //
+  // nothing to clear if the buffer hasn't been allocated yet.
+  //
+  if (_buffer.is_empty())
+  {
+    return;
+  }
+
+  resize(0);
 }
 
 
@@ -450,7 +457,14 @@ string::format(
   va_start(args, format);
 
 #if defined(MINI_MODE_KERNEL) || defined(MINI_OS_LINUX)
-  int chars = vsnprintf(nullptr, 0, format.get_buffer(), args);
+  //
+  // the size computation consumes its own copy
+  // of the arguments.
+  //
+  va_list size_args;
+  va_copy(size_args, args);
+  int chars = vsnprintf(nullptr, 0, format.get_buffer(), size_args);
+  va_end(size_args);
 #else
   int chars = _vscprintf(format.get_buffer(), args);
 #endif
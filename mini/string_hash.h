@@ -78,6 +78,15 @@ class string_hash
 
     }
 
+    constexpr string_hash(
+      const char* value,
+      size_type size
+      )
+      : _hash(detail::fnv1a<uint32_t>::hash(value, size, detail::fnv1a<uint32_t>::default_offset_basis))
+    {
+
+    }
+
     constexpr uint32_t
     get_hash() const
     {
@@ -0,0 +1,127 @@
+#include "alias_table.h"
+
+#include <mini/crypto/random.h>
+
+namespace mini::tor {
+
+void
+alias_table::build(
+  const buffer_ref<uint64_t> weights
+  )
+{
+  clear();
+
+  const size_type count = weights.get_size();
+
+  uint64_t total_weight = 0;
+  for (auto weight : weights)
+  {
+    total_weight += weight;
+  }
+
+  if (total_weight == 0)
+  {
+    return;
+  }
+
+  //
+  // scale the weights so the average is 1.
+  //
+  collections::list<double> probability_list;
+  collections::list<uint32_t> small_list;
+  collections::list<uint32_t> large_list;
+
+  probability_list.reserve(count);
+  small_list.reserve(count);
+  large_list.reserve(count);
+
+  for (size_type i = 0; i < count; i++)
+  {
+    probability_list.add(static_cast<double>(weights[i]) * count / total_weight);
+
+    if (probability_list[i] < 1.0)
+    {
+      small_list.add(static_cast<uint32_t>(i));
+    }
+    else
+    {
+      large_list.add(static_cast<uint32_t>(i));
+    }
+  }
+
+  _threshold_list.resize(count);
+  _alias_list.resize(count);
+
+  //
+  // fill each underfull column with the rest
+  // taken from an overfull one.
+  //
+  while (!small_list.is_empty() && !large_list.is_empty())
+  {
+    const uint32_t small_index = small_list.top();
+    const uint32_t large_index = large_list.top();
+    small_list.pop();
+
+    _threshold_list[small_index] = static_cast<uint64_t>(probability_list[small_index] * 0x100000000ull);
+    _alias_list[small_index] = large_index;
+
+    probability_list[large_index] -= 1.0 - probability_list[small_index];
+
+    if (probability_list[large_index] < 1.0)
+    {
+      large_list.pop();
+      small_list.add(large_index);
+    }
+  }
+
+  //
+  // the rest is full (up to the rounding errors).
+  //
+  for (auto index : small_list)
+  {
+    _threshold_list[index] = 0x100000000ull;
+    _alias_list[index] = index;
+  }
+
+  for (auto index : large_list)
+  {
+    _threshold_list[index] = 0x100000000ull;
+    _alias_list[index] = index;
+  }
+}
+
+void
+alias_table::clear(
+  void
+  )
+{
+  _threshold_list.clear();
+  _alias_list.clear();
+}
+
+bool
+alias_table::is_empty(
+  void
+  ) const
+{
+  return _threshold_list.is_empty();
+}
+
+size_type
+alias_table::pick(
+  void
+  ) const
+{
+  //
+  // the lower half selects the column,
+  // the upper half decides between the item and its alias.
+  //
+  const uint64_t random_value = crypto::random_device.get_random<uint64_t>();
+  const size_type index = static_cast<size_type>((random_value & 0xffffffff) % _threshold_list.get_size());
+
+  return (random_value >> 32) < _threshold_list[index]
+    ? index
+    : _alias_list[index];
+}
+
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <mini/common.h>
+#include <mini/buffer_ref.h>
+#include <mini/collections/list.h>
+
+namespace mini::tor {
+
+//
+// Walker's alias method (Vose's variant).
+// picks an index with the probability proportional
+// to its weight in O(1) using single random number.
+//
+
+class alias_table
+{
+  public:
+    void
+    build(
+      const buffer_ref<uint64_t> weights
+      );
+
+    void
+    clear(
+      void
+      );
+
+    //
+    // true if there is nothing to pick
+    // (no items or all the weights are zero).
+    //
+    bool
+    is_empty(
+      void
+      ) const;
+
+    size_type
+    pick(
+      void
+      ) const;
+
+  private:
+    //
+    // the item is kept if the random 32-bit number
+    // is lower than its threshold, otherwise its alias
+    // is picked.
+    //
+    collections::list<uint64_t> _threshold_list;
+    collections::list<uint32_t> _alias_list;
+};
+
+}
@@ -19,9 +19,8 @@ cell::cell(
   )
   : _circuit_id(circuit_id)
   , _command(command)
-  , _payload(payload)
 {
-
+  set_payload(payload);
 }
 
 void
@@ -32,6 +31,8 @@ cell::swap(
   mini::swap(_circuit_id, other._circuit_id);
   mini::swap(_command, other._command);
   mini::swap(_payload, other._payload);
+  mini::swap(_payload_size, other._payload_size);
+  mini::swap(_variable_payload, other._variable_payload);
   mini::swap(_is_valid, other._is_valid);
 }
 
@@ -72,7 +73,19 @@ cell::get_payload(
   void
   ) const
 {
-  return _payload;
+  return _payload_size > payload_size
+    ? byte_buffer_ref(_variable_payload)
+    : byte_buffer_ref(_payload.get_buffer(), _payload.get_buffer() + _payload_size);
+}
+
+mutable_byte_buffer_ref
+cell::get_mutable_payload(
+  void
+  )
+{
+  return _payload_size > payload_size
+    ? mutable_byte_buffer_ref(_variable_payload)
+    : mutable_byte_buffer_ref(_payload.get_buffer(), _payload.get_buffer() + _payload_size);
 }
 
 void
@@ -80,45 +93,78 @@ cell::set_payload(
   const byte_buffer_ref payload
   )
 {
-  _payload = payload;
+  if (payload.get_size() > payload_size)
+  {
+    _variable_payload = byte_buffer(payload);
+    _payload_size = payload.get_size();
+    return;
+  }
+
+  //
+  // the payload might be a part of our own buffer.
+  //
+  memory::move(_payload.get_buffer(), payload.get_buffer(), payload.get_size());
+  _payload_size = payload.get_size();
 }
 
-byte_buffer
-cell::get_bytes(
-  protocol_version_type protocol_version
-  ) const
+void
+cell::set_payload_size(
+  size_type payload_size
+  )
 {
-  byte_buffer cell_bytes;
-
-  if (is_variable_length_cell_command(_command))
+  if (payload_size > cell::payload_size)
   {
-    cell_bytes.resize(
-      //
-      // circuit id.
-      //
-      (protocol_version < 4 ? sizeof(circuit_id_v3_type) : sizeof(circuit_id_type)) +
-
-      //
-      // cell command.
-      //
-      sizeof(cell_command) +
-
-      //
-      // payload size (16 bits).
-      //
-      sizeof(payload_size_type) +
-
-      //
-      // payload.
-      //
-      _payload.get_size());
+    _variable_payload.resize(payload_size);
   }
-  else
+
+  _payload_size = payload_size;
+}
+
+size_type
+cell::get_size_in_bytes(
+  protocol_version_type protocol_version
+  ) const
+{
+  if (!is_variable_length_cell_command(_command))
   {
-    cell_bytes.resize(cell::size);
+    return cell::size;
   }
 
-  io::memory_stream cell_stream(cell_bytes);
+  return
+    //
+    // circuit id.
+    //
+    (protocol_version < 4 ? sizeof(circuit_id_v3_type) : sizeof(circuit_id_type)) +
+
+    //
+    // cell command.
+    //
+    sizeof(cell_command) +
+
+    //
+    // payload size (16 bits).
+    //
+    sizeof(payload_size_type) +
+
+    //
+    // payload.
+    //
+    _payload_size;
+}
+
+size_type
+cell::write_bytes(
+  protocol_version_type protocol_version,
+  mutable_byte_buffer_ref output
+  ) const
+{
+  const size_type cell_size = get_size_in_bytes(protocol_version);
+  mini_assert(output.get_size() >= cell_size);
+
+  //
+  // fixed-size cells are padded with zeros.
+  //
+  io::memory_stream cell_stream(output.slice(0, cell_size));
   io::stream_wrapper cell_buffer(cell_stream, endianness::big_endian);
 
   //
@@ -142,10 +188,24 @@ cell::get_bytes(
 
   if (is_variable_length_cell_command(_command))
   {
-    cell_buffer.write(static_cast<payload_size_type>(_payload.get_size()));
+    cell_buffer.write(static_cast<payload_size_type>(_payload_size));
   }
 
-  cell_buffer.write(_payload);
+  cell_buffer.write(get_payload());
+
+  const size_type bytes_written = cell_stream.get_position();
+  memory::zero(output.get_buffer() + bytes_written, cell_size - bytes_written);
+
+  return cell_size;
+}
+
+byte_buffer
+cell::get_bytes(
+  protocol_version_type protocol_version
+  ) const
+{
+  byte_buffer cell_bytes(get_size_in_bytes(protocol_version));
+  write_bytes(protocol_version, cell_bytes);
 
   return cell_bytes;
 }
@@ -173,7 +233,7 @@ cell::is_recognized(
   //   && _payload[2] == 0;
   //
 
-  return *reinterpret_cast<const uint16_t*>(&_payload[1]) == 0x0000;
+  return *reinterpret_cast<const uint16_t*>(&get_payload()[1]) == 0x0000;
 }
 
 bool
@@ -2,6 +2,7 @@
 #include "common.h"
 
 #include <mini/byte_buffer.h>
+#include <mini/stack_buffer.h>
 #include <mini/io/stream.h>
 
 namespace mini::tor {
@@ -168,11 +169,40 @@ class cell
       void
       ) const;
 
+    mutable_byte_buffer_ref
+    get_mutable_payload(
+      void
+      );
+
     void
     set_payload(
       const byte_buffer_ref payload
       );
 
+    //
+    // the content of the payload is left uninitialized
+    // (except for the variable-length cells larger than payload_size).
+    //
+    void
+    set_payload_size(
+      size_type payload_size
+      );
+
+    size_type
+    get_size_in_bytes(
+      protocol_version_type protocol_version
+      ) const;
+
+    //
+    // serializes the cell into the output buffer,
+    // which must be at least get_size_in_bytes() long.
+    //
+    size_type
+    write_bytes(
+      protocol_version_type protocol_version,
+      mutable_byte_buffer_ref output
+      ) const;
+
     byte_buffer
     get_bytes(
       protocol_version_type protocol_version
@@ -201,7 +231,17 @@ class cell
   protected:
     circuit_id_type _circuit_id = 0;
     cell_command _command = (cell_command)0;
-    byte_buffer _payload;
+
+    //
+    // the payload is stored inline, so the cells can be created,
+    // received and encrypted without touching the heap.
+    // only the variable-length cells larger than payload_size
+    // (such as CERTS) are stored in _variable_payload.
+    //
+    stack_byte_buffer<payload_size> _payload;
+    size_type _payload_size = 0;
+    byte_buffer _variable_payload;
+
     bool _is_valid = false;
 };
 
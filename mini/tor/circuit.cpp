@@ -11,13 +11,18 @@
 
 #include <mini/crypto/base16.h>
 
+#include <atomic>
+
 namespace mini::tor {
 
+thread_local tor_stream* circuit::_current_stream = nullptr;
+
 circuit::circuit(
   tor_socket& tor_socket
   )
   : _tor_socket(tor_socket)
   , _circuit_id(get_next_circuit_id())
+  , _stream_dispatch_done_event(threading::reset_type::manual_reset, true)
 {
   //
   // set MSB (most significant bit).
@@ -31,6 +36,12 @@ circuit::~circuit(
 {
   send_destroy_cell();
   destroy();
+
+  //
+  // the circuit might have been destroyed by a cell
+  // which is still being dispatched to it.
+  //
+  _tor_socket.remove_circuit(this);
 }
 
 tor_socket&
@@ -76,7 +87,8 @@ circuit::get_final_circuit_node(
 tor_stream*
 circuit::create_stream(
   const string_ref host,
-  uint16_t port
+  uint16_t port,
+  timeout_type timeout
   )
 {
   //
@@ -99,84 +111,79 @@ circuit::create_stream(
   //
   // send RELAY_BEGIN cell.
   //
-  const tor_stream_id_type stream_id = get_next_stream_id();
-
-  tor_stream* stream = new tor_stream(stream_id, this);
-  _stream_map.insert(stream_id, stream);
+  tor_stream* stream = create_stream_object();
+  const tor_stream_id_type stream_id = stream->get_stream_id();
 
   mini_debug("circuit::create_stream() [url: %s, stream: %u, status: creating]", host_port.get_buffer(), stream_id);
-  set_state(state::connecting);
-  {
-    send_relay_cell(stream_id, cell_command::relay_begin, relay_data_bytes);
-  }
+  send_relay_cell(stream_id, cell_command::relay_begin, relay_data_bytes);
 
-  if (mini_wait_success(wait_for_state(state::ready)))
+  if (stream->wait_for_connected(timeout))
   {
     mini_debug("circuit::create_stream() [url: %s, stream: %u, status: created]", host_port.get_buffer(), stream_id);
-  }
-  else
-  {
-    mini_error("circuit::create_stream() [is_ready() == false]");
+    return stream;
   }
 
+  mini_error("circuit::create_stream() [url: %s, stream: %u, status: failed]", host_port.get_buffer(), stream_id);
+
   //
-  // if the circuit has been destroyed,
-  // the stream has been destroyed as well,
-  // so we don't need to delete it here.
+  // if the exit refused the stream or the circuit
+  // has been destroyed, the stream is already removed
+  // from the stream map, otherwise the destructor
+  // sends RELAY_END and removes it. either way,
+  // a late cell handler is done with it by now.
   //
-
-  return is_ready()
-    ? stream
-    : nullptr;
+  delete stream;
+  return nullptr;
 }
 
 tor_stream*
 circuit::create_onion_stream(
   const string_ref onion,
-  uint16_t port
+  uint16_t port,
+  timeout_type timeout
   )
 {
+  //
+  // the rendezvous with this hidden service
+  // has been completed on this circuit already.
+  //
+  if (is_rendezvous_completed() && _rendezvous_onion.equals(onion))
+  {
+    return create_stream(onion, port, timeout);
+  }
+
   hidden_service hidden_service_connector(this, onion);
 
-  return hidden_service_connector.connect()
-    ? create_stream(onion, port)
-    : nullptr;
+  if (!hidden_service_connector.connect())
+  {
+    return nullptr;
+  }
+
+  _rendezvous_onion = onion;
+  return create_stream(onion, port, timeout);
 }
 
 tor_stream*
 circuit::create_dir_stream(
-  void
+  timeout_type timeout
   )
 {
-  const tor_stream_id_type stream_id = get_next_stream_id();
-
-  tor_stream* stream = new tor_stream(stream_id, this);
-  _stream_map.insert(stream_id, stream);
+  tor_stream* stream = create_stream_object();
+  const tor_stream_id_type stream_id = stream->get_stream_id();
 
   mini_debug("circuit::create_dir_stream() [stream: %u, state: connecting]", stream_id);
-  set_state(state::connecting);
-  {
-    send_relay_cell(stream_id, cell_command::relay_begin_dir);
-  }
+  send_relay_cell(stream_id, cell_command::relay_begin_dir);
 
-  if (mini_wait_success(wait_for_state(state::ready)))
+  if (stream->wait_for_connected(timeout))
   {
     mini_debug("circuit::create_dir_stream() [stream: %u, state: connected]", stream_id);
-  }
-  else
-  {
-    mini_error("circuit::create_dir_stream() [is_ready() == false]");
+    return stream;
   }
 
-  //
-  // if the circuit has been destroyed,
-  // the stream has been destroyed as well,
-  // so we don't need to delete it here.
-  //
+  mini_error("circuit::create_dir_stream() [stream: %u, state: failed]", stream_id);
 
-  return is_ready()
-    ? stream
-    : nullptr;
+  delete stream;
+  return nullptr;
 }
 
 void
@@ -231,6 +238,12 @@ circuit::destroy(
 
   mini_debug("circuit::destroy()");
 
+  //
+  // stop the dispatch of incoming cells first,
+  // the cell handlers use the nodes released below.
+  //
+  _tor_socket.remove_circuit(this);
+
   if (_extend_node)
   {
     delete _extend_node;
@@ -238,7 +251,6 @@ circuit::destroy(
   }
 
   close_streams();
-  _tor_socket.remove_circuit(this);
 }
 
 bool
@@ -249,6 +261,43 @@ circuit::is_destroyed(
   return get_state() == state::destroyed;
 }
 
+void
+circuit::cancel(
+  void
+  )
+{
+  if (_cancelled.exchange(true))
+  {
+    return;
+  }
+
+  mini_debug("circuit::cancel() [circuit: %u]", _circuit_id & 0x7FFFFFFF);
+
+  //
+  // the DESTROY cell carries only the circuit id,
+  // it doesn't touch the circuit nodes.
+  //
+  send_destroy_cell();
+
+  _state.cancel_all_waits();
+
+  mini_lock(_stream_map_mutex)
+  {
+    for (auto&& stream_entry : _stream_map)
+    {
+      stream_entry.second->cancel_waits();
+    }
+  }
+}
+
+bool
+circuit::is_cancelled(
+  void
+  ) const
+{
+  return _cancelled;
+}
+
 bool
 circuit::is_ready(
   void
@@ -262,11 +311,14 @@ circuit::get_stream_by_id(
   tor_stream_id_type stream_id
   )
 {
-  tor_stream** stream = _stream_map.find(stream_id);
+  mini_lock(_stream_map_mutex)
+  {
+    auto it = _stream_map.find(stream_id);
 
-  return stream
-    ? *stream
-    : nullptr;
+    return it != _stream_map.end()
+      ? it->second
+      : nullptr;
+  }
 }
 
 void
@@ -500,12 +552,27 @@ circuit::close_streams(
   //
   // destroy each stream in this circuit.
   //
-  while (!_stream_map.is_empty())
+  for (;;)
   {
+    tor_stream* stream = nullptr;
+
+    mini_lock(_stream_map_mutex)
+    {
+      if (_stream_map.is_empty() == false)
+      {
+        stream = _stream_map.begin()->second;
+      }
+    }
+
+    if (!stream)
+    {
+      break;
+    }
+
     //
     // this call removes the stream from our stream map.
     //
-    send_relay_end_cell(_stream_map.last_value());
+    send_relay_end_cell(stream);
   }
 
   _node_list.clear();
@@ -573,8 +640,20 @@ circuit::rendezvous_introduce(
   mini_debug("circuit::rendezvous_introduce() [or: %s, state: introducing]", introduction_point->get_name().get_buffer());
   set_state(state::rendezvous_introducing);
 
-  mini_debug("circuit::rendezvous_introduce() [or: %s, state: completing]", introduction_point->get_name().get_buffer());
-  rendezvous_circuit->set_state(state::rendezvous_completing);
+  //
+  // the rendezvous handshake may be shared
+  // by the introductions running in parallel.
+  //
+  if (!rendezvous_circuit->_extend_node)
+  {
+    mini_debug("circuit::rendezvous_introduce() [or: %s, state: completing]", introduction_point->get_name().get_buffer());
+
+    rendezvous_circuit->_extend_node = rendezvous_circuit->create_circuit_node(introduction_point, circuit_node_type::introduction_point);
+    rendezvous_circuit->set_state(state::rendezvous_completing);
+  }
+
+  circuit_node* rendezvous_node = rendezvous_circuit->_extend_node;
+
   {
     //
     // payload of the RELAY_COMMAND_INTRODUCE1
@@ -613,8 +692,6 @@ circuit::rendezvous_introduce(
     io::memory_stream handshake_stream(handshake_bytes);
     io::stream_wrapper handshake_buffer(handshake_stream, endianness::big_endian);
 
-    rendezvous_circuit->_extend_node = create_circuit_node(introduction_point, circuit_node_type::introduction_point);
-
     handshake_buffer.write(static_cast<uint8_t>(2));
     handshake_buffer.write(swap_endianness(introducee->get_ip_address().to_int()));
     handshake_buffer.write(introducee->get_or_port());
@@ -622,7 +699,7 @@ circuit::rendezvous_introduce(
     handshake_buffer.write(static_cast<payload_size_type>(introducee->get_onion_key().get_size()));
     handshake_buffer.write(introducee->get_onion_key());
     handshake_buffer.write(rendezvous_cookie);
-    handshake_buffer.write(rendezvous_circuit->_extend_node->get_key_agreement().get_public_key());
+    handshake_buffer.write(rendezvous_node->get_key_agreement().get_public_key());
 
     auto handshake_encrypted = hybrid_encryption::encrypt(
       handshake_bytes,
@@ -699,11 +776,28 @@ circuit::encrypt(
   relay_cell&& cell
   )
 {
-  for (int i = (int)_node_list.get_size() - 1; i >= 0; i--)
+  mini_assert(!_node_list.is_empty());
+
+  //
+  // the last node builds the payload (innermost layer).
+  //
+  _node_list[_node_list.get_size() - 1]->build_forward_cell(cell);
+
+  //
+  // the layers commute (ctr mode), so the keystreams
+  // of all hops are combined first and the payload
+  // is encrypted in a single pass.
+  //
+  stack_byte_buffer<cell::payload_size> keystream;
+  memory::zero(keystream.get_buffer(), keystream.get_size());
+
+  for (auto&& node : _node_list)
   {
-    _node_list[i]->encrypt_forward_cell(cell);
+    node->xor_forward_keystream(keystream);
   }
 
+  memory::exclusive_or(cell.get_mutable_payload().get_buffer(), keystream.get_buffer(), keystream.get_size());
+
   return cell;
 }
 
@@ -712,9 +806,35 @@ circuit::decrypt(
   cell& cell
   )
 {
+  mini_assert(cell.get_payload().get_size() == cell::payload_size);
+
+  mutable_byte_buffer_ref payload = cell.get_mutable_payload();
+
+  //
+  // keystreams of the layers which aren't
+  // removed from the payload yet.
+  //
+  stack_byte_buffer<cell::payload_size> keystream;
+  memory::zero(keystream.get_buffer(), keystream.get_size());
+
   for (auto&& node : _node_list)
   {
-    if (node->decrypt_backward_cell(cell))
+    node->xor_backward_keystream(keystream);
+
+    //
+    // peek at the 'recognized' field of this layer,
+    // the payload is touched only when it is zero.
+    //
+    if ((payload[1] ^ keystream[1]) != 0 ||
+        (payload[2] ^ keystream[2]) != 0)
+    {
+      continue;
+    }
+
+    memory::exclusive_or(payload.get_buffer(), keystream.get_buffer(), keystream.get_size());
+    memory::zero(keystream.get_buffer(), keystream.get_size());
+
+    if (node->verify_backward_cell(cell))
     {
       return relay_cell(node.get(), cell);
     }
@@ -810,12 +930,14 @@ circuit::send_relay_end_cell(
     cell_command::relay_end,
     { 6 }); // reason
 
+  remove_stream(stream);
+
   //
   // signal destroy.
+  // the owner may delete the stream once it sees
+  // the state, it must not be in use anymore.
   //
   stream->set_state(tor_stream::state::destroyed);
-
-  _stream_map.remove(stream->get_stream_id());
 }
 
 void
@@ -913,8 +1035,15 @@ circuit::handle_cell(
           break;
 
         case cell_command::relay_command_rendezvous2:
-          handle_relay_extended_cell(decrypted_relay_cell);
-          set_state(state::rendezvous_completed);
+          //
+          // only the first one completes the rendezvous
+          // when several introductions were sent.
+          //
+          if (_extend_node)
+          {
+            handle_relay_extended_cell(decrypted_relay_cell);
+            set_state(state::rendezvous_completed);
+          }
           break;
 
         case cell_command::relay_command_rendezvous_established:
@@ -1111,7 +1240,7 @@ circuit::handle_relay_data_cell(
     send_relay_sendme_cell(nullptr);
   }
 
-  if (tor_stream* stream = get_stream_by_id(cell.get_stream_id()))
+  if (tor_stream* stream = acquire_stream(cell.get_stream_id()))
   {
     stream->append_to_recv_buffer(cell.get_relay_payload());
 
@@ -1123,6 +1252,8 @@ circuit::handle_relay_data_cell(
     {
       send_relay_sendme_cell(stream);
     }
+
+    release_stream();
   }
 }
 
@@ -1137,9 +1268,10 @@ circuit::handle_relay_sendme_cell(
   }
   else
   {
-    if (tor_stream* stream = get_stream_by_id(cell.get_stream_id()))
+    if (tor_stream* stream = acquire_stream(cell.get_stream_id()))
     {
       stream->increment_package_window();
+      release_stream();
     }
   }
 }
@@ -1149,12 +1281,15 @@ circuit::handle_relay_connected_cell(
   relay_cell& cell
   )
 {
-  if (tor_stream* stream = get_stream_by_id(cell.get_stream_id()))
+  //
+  // only the stream is connected,
+  // the circuit state is left untouched.
+  //
+  if (tor_stream* stream = acquire_stream(cell.get_stream_id()))
   {
     stream->set_state(tor_stream::state::ready);
+    release_stream();
   }
-
-  set_state(state::ready);
 }
 
 void
@@ -1197,12 +1332,18 @@ circuit::handle_relay_end_cell(
   relay_cell& cell
   )
 {
-  if (tor_stream* stream = get_stream_by_id(cell.get_stream_id()))
+  if (tor_stream* stream = acquire_stream(cell.get_stream_id()))
   {
     mini_debug("circuit::handle_relay_end_cell() [stream: %u, reason: %u]", cell.get_stream_id(), cell.get_relay_payload()[0]);
 
+    //
+    // the owner may delete the stream once it sees
+    // the state, the stream is released right afterwards
+    // and not touched anymore.
+    //
+    remove_stream(stream);
     stream->set_state(tor_stream::state::destroyed);
-    _stream_map.remove(cell.get_stream_id());
+    release_stream();
   }
 }
 
@@ -1211,18 +1352,103 @@ circuit::get_next_circuit_id(
   void
   )
 {
-  static volatile circuit_id_type next_circuit_id = 1;
+  static std::atomic<circuit_id_type> next_circuit_id = 1;
   return next_circuit_id++;
 }
 
 
-tor_stream_id_type
-circuit::get_next_stream_id(
+tor_stream*
+circuit::create_stream_object(
   void
   )
 {
-  static volatile tor_stream_id_type next_stream_id = 1;
-  return next_stream_id++;
+  mini_lock(_stream_map_mutex)
+  {
+    //
+    // stream ids are local to the circuit.
+    // skip 0 (reserved for control cells)
+    // and ids which are still in use.
+    //
+    do
+    {
+      _next_stream_id++;
+    } while (_next_stream_id == 0 || _stream_map.contains(_next_stream_id));
+
+    tor_stream* stream = new tor_stream(_next_stream_id, this);
+    _stream_map.insert(_next_stream_id, stream);
+
+    return stream;
+  }
+}
+
+void
+circuit::remove_stream(
+  tor_stream* stream
+  )
+{
+  bool is_dispatching;
+
+  mini_lock(_stream_map_mutex)
+  {
+    auto it = _stream_map.find(stream->get_stream_id());
+
+    if (it != _stream_map.end() && it->second == stream)
+    {
+      _stream_map.remove(it);
+    }
+
+    //
+    // the stream may be removed from its own cell handler,
+    // there is nothing to wait for in that case.
+    //
+    is_dispatching =
+      _dispatching_stream == stream &&
+      _current_stream != stream;
+  }
+
+  if (is_dispatching)
+  {
+    _stream_dispatch_done_event.wait();
+  }
+}
+
+tor_stream*
+circuit::acquire_stream(
+  tor_stream_id_type stream_id
+  )
+{
+  mini_lock(_stream_map_mutex)
+  {
+    auto it = _stream_map.find(stream_id);
+
+    if (it == _stream_map.end())
+    {
+      return nullptr;
+    }
+
+    //
+    // the cells of a circuit are handled
+    // by one thread at a time.
+    //
+    _dispatching_stream = it->second;
+    _stream_dispatch_done_event.reset();
+    _current_stream = it->second;
+
+    return it->second;
+  }
+}
+
+void
+circuit::release_stream(
+  void
+  )
+{
+  mini_lock(_stream_map_mutex)
+  {
+    _dispatching_stream = nullptr;
+    _stream_dispatch_done_event.set();
+    _current_stream = nullptr;
+  }
 }
 
 circuit::state
@@ -3,8 +3,11 @@
 #include "tor_stream.h"
 #include "relay_cell.h"
 
+#include <mini/collections/hashmap.h>
 #include <mini/threading/locked_value.h>
 
+#include <atomic>
+
 namespace mini::tor {
 
 using circuit_node_list = collections::list<ptr<circuit_node>>;
@@ -47,21 +50,28 @@ class circuit
       void
       );
 
+    //
+    // streams are connected independently of each other,
+    // any number of them may be connecting at the same time.
+    //
+
     tor_stream*
     create_stream(
       const string_ref host,
-      uint16_t port
+      uint16_t port,
+      timeout_type timeout = tor_stream::connect_timeout_default
       );
 
     tor_stream*
     create_onion_stream(
       const string_ref onion,
-      uint16_t port
+      uint16_t port,
+      timeout_type timeout = tor_stream::connect_timeout_default
       );
 
     tor_stream*
     create_dir_stream(
-      void
+      timeout_type timeout = tor_stream::connect_timeout_default
       );
 
     void
@@ -86,6 +96,21 @@ class circuit
       void
       ) const;
 
+    //
+    // can be called from any thread. asks the relay to tear
+    // the circuit down and wakes the threads waiting on it,
+    // the circuit is destroyed by the thread which owns it.
+    //
+    void
+    cancel(
+      void
+      );
+
+    bool
+    is_cancelled(
+      void
+      ) const;
+
     bool
     is_ready(
       void
@@ -101,7 +126,7 @@ class circuit
     friend class tor_socket;
     friend class hidden_service;
 
-    using tor_stream_map = collections::pair_list<tor_stream_id_type, tor_stream*>;
+    using tor_stream_map = collections::hashmap<tor_stream_id_type, tor_stream*>;
 
     enum class state
     {
@@ -287,8 +312,32 @@ class circuit
       void
       );
 
-    tor_stream_id_type
-    get_next_stream_id(
+    tor_stream*
+    create_stream_object(
+      void
+      );
+
+    //
+    // removes the stream from the stream map and waits
+    // until no cell handler uses it.
+    // afterwards the stream can be safely deleted.
+    //
+    void
+    remove_stream(
+      tor_stream* stream
+      );
+
+    //
+    // looks the stream up for a cell handler,
+    // remove_stream() waits until release_stream() is called.
+    //
+    tor_stream*
+    acquire_stream(
+      tor_stream_id_type stream_id
+      );
+
+    void
+    release_stream(
       void
       );
 
@@ -312,11 +361,29 @@ class circuit
     circuit_id_type _circuit_id;
 
     threading::locked_value<state> _state;
+    std::atomic<bool> _cancelled = false;
 
     tor_stream_map _stream_map;
+    tor_stream_id_type _next_stream_id = 0;
+    threading::mutex _stream_map_mutex;
+
+    //
+    // the stream a cell handler is using, guarded by
+    // _stream_map_mutex. the event is set while
+    // no cell handler uses a stream.
+    //
+    tor_stream* _dispatching_stream = nullptr;
+    threading::event _stream_dispatch_done_event;
+    static thread_local tor_stream* _current_stream;
 
     circuit_node* _extend_node = nullptr;
     circuit_node_list _node_list;
+
+    //
+    // hidden service this circuit has completed
+    // the rendezvous with.
+    //
+    string _rendezvous_onion;
 };
 
 }
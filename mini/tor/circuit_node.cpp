@@ -122,19 +122,35 @@ circuit_node::has_valid_crypto_state(
 }
 
 void
-circuit_node::encrypt_forward_cell(
+circuit_node::build_forward_cell(
   relay_cell& cell
   )
 {
-  _crypto_state->encrypt_forward_cell(cell);
+  _crypto_state->build_forward_cell(cell);
+}
+
+void
+circuit_node::xor_forward_keystream(
+  mutable_byte_buffer_ref keystream
+  )
+{
+  _crypto_state->xor_forward_keystream(keystream);
+}
+
+void
+circuit_node::xor_backward_keystream(
+  mutable_byte_buffer_ref keystream
+  )
+{
+  _crypto_state->xor_backward_keystream(keystream);
 }
 
 bool
-circuit_node::decrypt_backward_cell(
+circuit_node::verify_backward_cell(
   cell& cell
   )
 {
-  return _crypto_state->decrypt_backward_cell(cell);
+  return _crypto_state->verify_backward_cell(cell);
 }
 
 void
@@ -58,13 +58,27 @@ class circuit_node
       void
       ) const;
 
+    //
+    // onion layers.
+    //
+
     void
-    encrypt_forward_cell(
+    build_forward_cell(
       relay_cell& cell
       );
 
+    void
+    xor_forward_keystream(
+      mutable_byte_buffer_ref keystream
+      );
+
+    void
+    xor_backward_keystream(
+      mutable_byte_buffer_ref keystream
+      );
+
     bool
-    decrypt_backward_cell(
+    verify_backward_cell(
       cell& cell
       );
 
@@ -16,11 +16,11 @@ circuit_node_crypto_state::circuit_node_crypto_state(
   io::memory_stream key_material_stream(key_material);
   io::stream_wrapper key_material_buffer(key_material_stream);
 
-  stack_byte_buffer<crypto::sha1::hash_size_in_bytes> df;
+  stack_byte_buffer<crypto::ext::sha1::hash_size_in_bytes> df;
   key_material_buffer.read(df);
   _forward_digest.update(df);
 
-  stack_byte_buffer<crypto::sha1::hash_size_in_bytes> db;
+  stack_byte_buffer<crypto::ext::sha1::hash_size_in_bytes> db;
   key_material_buffer.read(db);
   _backward_digest.update(db);
 
@@ -34,14 +34,20 @@ circuit_node_crypto_state::circuit_node_crypto_state(
 }
 
 void
-circuit_node_crypto_state::encrypt_forward_cell(
+circuit_node_crypto_state::build_forward_cell(
   relay_cell& cell
   )
 {
-  byte_buffer relay_payload_bytes(cell::payload_size);
-
+  //
+  // the payload is built in place.
+  //
   if (cell.get_payload().is_empty())
   {
+    cell.set_payload_size(cell::payload_size);
+
+    mutable_byte_buffer_ref relay_payload_bytes = cell.get_mutable_payload();
+    memory::zero(relay_payload_bytes.get_buffer(), relay_payload_bytes.get_size());
+
     io::memory_stream relay_payload_stream(relay_payload_bytes);
     io::stream_wrapper relay_payload_buffer(relay_payload_stream, endianness::big_endian);
 
@@ -54,67 +60,75 @@ circuit_node_crypto_state::encrypt_forward_cell(
 
     //
     // update digest field in the payload
+    // (get() doesn't finalize the running digest).
     //
     _forward_digest.update(relay_payload_bytes);
-    auto digest = _forward_digest.duplicate().get();
+
+    stack_byte_buffer<crypto::ext::sha1::hash_size_in_bytes> digest;
+    _forward_digest.get(digest);
     memory::copy(&relay_payload_bytes[5], &digest[0], sizeof(uint32_t));
   }
-  else
-  {
-    relay_payload_bytes.insert_many(cell.get_payload(), 0);
-  }
 
-  //
-  // encrypt the payload
-  //
-  auto encrypted_payload = _forward_cipher.encrypt(relay_payload_bytes);
-  mini_assert(encrypted_payload.get_size() == cell::payload_size);
+  mini_assert(cell.get_payload().get_size() == cell::payload_size);
+}
 
+void
+circuit_node_crypto_state::xor_forward_keystream(
+  mutable_byte_buffer_ref keystream
+  )
+{
   //
-  // set the payload
+  // ctr mode: encryption XORs the keystream into the buffer.
   //
-  cell.set_payload(encrypted_payload);
+  _forward_cipher.encrypt_inplace(keystream);
+}
+
+void
+circuit_node_crypto_state::xor_backward_keystream(
+  mutable_byte_buffer_ref keystream
+  )
+{
+  _backward_cipher.decrypt_inplace(keystream);
 }
 
 bool
-circuit_node_crypto_state::decrypt_backward_cell(
+circuit_node_crypto_state::verify_backward_cell(
   cell& cell
   )
 {
   mini_assert(cell.get_payload().get_size() == cell::payload_size);
-  auto decrypted_payload = _backward_cipher.decrypt(cell.get_payload());
 
-  mini_assert(decrypted_payload.get_size() == cell::payload_size);
-  cell.set_payload(decrypted_payload);
+  mutable_byte_buffer_ref payload = cell.get_mutable_payload();
 
   //
-  // check if this is a cell for us.
+  // the digest is computed with the digest field zeroed,
+  // it is restored afterwards.
   //
-  if (cell.is_recognized())
-  {
-    //
-    // remove the digest from the payload
-    //
-    byte_buffer payload_without_digest(cell.get_payload());
-    memory::zero(payload_without_digest.get_buffer() + 5, sizeof(uint32_t));
+  stack_byte_buffer<sizeof(uint32_t)> payload_digest;
+  memory::copy(payload_digest.get_buffer(), payload.get_buffer() + 5, sizeof(uint32_t));
+  memory::zero(payload.get_buffer() + 5, sizeof(uint32_t));
 
-    stack_byte_buffer<sizeof(uint32_t)> payload_digest;
-    memory::copy(payload_digest.get_buffer(), cell.get_payload().get_buffer() + 5, sizeof(uint32_t));
-
-    auto backward_digest_clone = _backward_digest.duplicate();
-    backward_digest_clone.update(payload_without_digest);
+  //
+  // the snapshot of the running digest is a plain copy
+  // of the state, it becomes the running digest if the
+  // cell is recognized.
+  //
+  auto backward_digest_clone = _backward_digest;
+  backward_digest_clone.update(payload);
 
-    auto digest = backward_digest_clone.get();
+  stack_byte_buffer<crypto::ext::sha1::hash_size_in_bytes> digest;
+  backward_digest_clone.get(digest);
 
-    if (memory::equal(payload_digest.get_buffer(), &digest[0], sizeof(payload_digest)))
-    {
-      _backward_digest.update(payload_without_digest);
+  const bool digest_matches = memory::equal(payload_digest.get_buffer(), &digest[0], sizeof(payload_digest));
 
-      return true;
-    }
+  if (digest_matches)
+  {
+    _backward_digest = backward_digest_clone;
   }
 
-  return false;
+  memory::copy(payload.get_buffer() + 5, payload_digest.get_buffer(), sizeof(uint32_t));
+
+  return digest_matches;
 }
 
 }
@@ -3,7 +3,7 @@
 
 #include <mini/byte_buffer.h>
 #include <mini/crypto/aes.h>
-#include <mini/crypto/sha1.h>
+#include <mini/crypto/ext/sha1.h>
 
 namespace mini::tor {
 
@@ -22,13 +22,38 @@ class circuit_node_crypto_state
       void
       ) = default;
 
+    //
+    // the onion layers of all hops are applied in a single pass
+    // over the payload (see circuit::encrypt() & circuit::decrypt()).
+    // the keystreams of the hops are XORed into a shared
+    // accumulator and the accumulator is XORed into the payload.
+    //
+
+    //
+    // builds the relay payload and its running digest
+    // (the innermost layer of the outgoing cell).
+    //
     void
-    encrypt_forward_cell(
+    build_forward_cell(
       relay_cell& cell
       );
 
+    void
+    xor_forward_keystream(
+      mutable_byte_buffer_ref keystream
+      );
+
+    void
+    xor_backward_keystream(
+      mutable_byte_buffer_ref keystream
+      );
+
+    //
+    // checks the digest of the recognized cell
+    // with all the layers up to this hop removed.
+    //
     bool
-    decrypt_backward_cell(
+    verify_backward_cell(
       cell& cell
       );
 
@@ -38,8 +63,8 @@ class circuit_node_crypto_state
     aes_ctr_128 _forward_cipher;
     aes_ctr_128 _backward_cipher;
 
-    crypto::sha1 _forward_digest;
-    crypto::sha1 _backward_digest;
+    crypto::ext::sha1 _forward_digest;
+    crypto::ext::sha1 _backward_digest;
 };
 
 }
@@ -0,0 +1,426 @@
+#include "circuit_pool.h"
+#include "circuit.h"
+#include "tor_socket.h"
+
+#include <mini/logger.h>
+
+namespace mini::tor {
+
+circuit_pool::circuit_pool(
+  tor_socket& socket,
+  consensus& consensus,
+  const options& pool_options
+  )
+  : _socket(socket)
+  , _consensus(consensus)
+  , _options(pool_options)
+  , _refill_event(threading::reset_type::manual_reset, true)
+  , _stop_event(threading::reset_type::manual_reset, false)
+{
+
+}
+
+circuit_pool::~circuit_pool(
+  void
+  )
+{
+  stop();
+}
+
+void
+circuit_pool::start(
+  void
+  )
+{
+  if (!_builder_threads.is_empty())
+  {
+    return;
+  }
+
+  mini_lock(_mutex)
+  {
+    _stop = false;
+    _stop_event.reset();
+    _refill_event.set();
+  }
+
+  for (size_type i = 0; i < _options.builder_thread_count; i++)
+  {
+    ptr<threading::thread_function> thread(new threading::thread_function([this]() {
+      builder_loop();
+    }));
+
+    thread->start();
+    _builder_threads.add(std::move(thread));
+  }
+}
+
+void
+circuit_pool::stop(
+  void
+  )
+{
+  mini_lock(_mutex)
+  {
+    _stop = true;
+    _stop_event.set();
+    _refill_event.set();
+  }
+
+  for (auto& thread : _builder_threads)
+  {
+    thread->join();
+  }
+
+  _builder_threads.clear();
+
+  for (auto&& entry : _general_circuits)
+  {
+    delete entry.instance;
+  }
+
+  for (auto&& entry : _internal_circuits)
+  {
+    delete entry.instance;
+  }
+
+  _general_circuits.clear();
+  _internal_circuits.clear();
+}
+
+circuit*
+circuit_pool::get_general_circuit(
+  void
+  )
+{
+  return get_circuit(purpose::general);
+}
+
+circuit*
+circuit_pool::get_internal_circuit(
+  void
+  )
+{
+  return get_circuit(purpose::internal);
+}
+
+const circuit_pool::options&
+circuit_pool::get_options(
+  void
+  ) const
+{
+  return _options;
+}
+
+circuit*
+circuit_pool::get_circuit(
+  purpose circuit_purpose
+  )
+{
+  circuit* result = nullptr;
+  collections::list<circuit*> stale_circuits;
+
+  mini_lock(_mutex)
+  {
+    pooled_circuit_list& circuits = get_circuit_list(circuit_purpose);
+
+    while (!circuits.is_empty())
+    {
+      const pooled_circuit entry = circuits.top();
+      circuits.pop();
+
+      if (is_usable(entry))
+      {
+        result = entry.instance;
+        break;
+      }
+
+      stale_circuits.add(entry.instance);
+    }
+
+    //
+    // wake up the builders to replace the taken circuit.
+    //
+    _refill_event.set();
+  }
+
+  for (auto stale_circuit : stale_circuits)
+  {
+    delete stale_circuit;
+  }
+
+  mini_debug(
+    "circuit_pool::get_circuit() [purpose: %s, circuit: %u]",
+    circuit_purpose == purpose::general ? "general" : "internal",
+    result ? result->get_circuit_id() & 0x7FFFFFFF : 0);
+
+  return result;
+}
+
+void
+circuit_pool::builder_loop(
+  void
+  )
+{
+  for (;;)
+  {
+    bool has_work = false;
+    purpose circuit_purpose = purpose::general;
+    collections::list<circuit*> stale_circuits;
+
+    mini_lock(_mutex)
+    {
+      if (_stop)
+      {
+        break;
+      }
+
+      collect_stale_circuits(_general_circuits, stale_circuits);
+      collect_stale_circuits(_internal_circuits, stale_circuits);
+
+      if (_general_circuits.get_size() + _general_build_count < _options.general_circuit_count)
+      {
+        circuit_purpose = purpose::general;
+        has_work = true;
+      }
+      else if (_internal_circuits.get_size() + _internal_build_count < _options.internal_circuit_count)
+      {
+        circuit_purpose = purpose::internal;
+        has_work = true;
+      }
+
+      if (has_work)
+      {
+        get_build_count(circuit_purpose)++;
+      }
+      else
+      {
+        //
+        // reset under the lock, so the wake up
+        // from get_circuit() isn't lost.
+        //
+        _refill_event.reset();
+      }
+    }
+
+    for (auto stale_circuit : stale_circuits)
+    {
+      delete stale_circuit;
+    }
+
+    if (!has_work)
+    {
+      _refill_event.wait(refill_check_interval);
+      continue;
+    }
+
+    circuit* new_circuit = build_circuit(circuit_purpose);
+
+    mini_lock(_mutex)
+    {
+      get_build_count(circuit_purpose)--;
+
+      if (new_circuit)
+      {
+        get_circuit_list(circuit_purpose).add({ new_circuit, time::timestamp() });
+      }
+    }
+
+    if (!new_circuit)
+    {
+      _stop_event.wait(build_retry_delay);
+    }
+  }
+}
+
+circuit*
+circuit_pool::build_circuit(
+  purpose circuit_purpose
+  )
+{
+  if (!_socket.is_ready())
+  {
+    return nullptr;
+  }
+
+  const size_type hop_count = circuit_purpose == purpose::general
+    ? _options.general_hop_count
+    : _options.internal_hop_count;
+
+  //
+  // the first hop is the onion router
+  // the socket is connected to.
+  //
+  onion_router_set forbidden_onion_routers;
+  forbidden_onion_routers.insert(_socket.get_onion_router());
+
+  onion_router_list path;
+
+  const bool exit_policy_in_microdescriptor =
+    _consensus.get_flavor() == consensus::flavor::microdesc;
+
+  for (size_type hop = 1; hop < hop_count; hop++)
+  {
+    const bool is_exit = circuit_purpose == purpose::general && hop == (hop_count - 1);
+
+    consensus::search_criteria criteria = {
+      {},                                 // allowed_dir_ports
+      {},                                 // allowed_or_ports
+      forbidden_onion_routers,
+      onion_router::status_flag::fast    |
+      onion_router::status_flag::running |
+      onion_router::status_flag::valid,
+      consensus::path_position::middle,
+      {},                                 // allowed_exit_ports
+    };
+
+    if (is_exit)
+    {
+      criteria.flags |= onion_router::status_flag::exit;
+      criteria.position = consensus::path_position::exit;
+
+      //
+      // the microdesc flavored consensus doesn't carry
+      // the exit policy summaries, the exit is checked
+      // once its microdescriptor is fetched.
+      //
+      if (!exit_policy_in_microdescriptor)
+      {
+        criteria.allowed_exit_ports = _options.predicted_ports;
+      }
+    }
+
+    onion_router* router = nullptr;
+
+    for (size_type attempt = 0; attempt < max_exit_selection_attempts; attempt++)
+    {
+      router = _consensus.get_random_onion_router_by_criteria(criteria);
+
+      if (!router || !is_exit || !exit_policy_in_microdescriptor)
+      {
+        break;
+      }
+
+      _consensus.prefetch_descriptors({ router });
+
+      if (allows_predicted_ports(router))
+      {
+        break;
+      }
+
+      criteria.forbidden_onion_routers.insert(router);
+      router = nullptr;
+    }
+
+    if (!router)
+    {
+      mini_warning("circuit_pool::build_circuit() [no onion router for hop #%u]", static_cast<uint32_t>(hop + 1));
+      return nullptr;
+    }
+
+    forbidden_onion_routers.insert(router);
+    path.add(router);
+  }
+
+  _consensus.prefetch_descriptors(path);
+
+  circuit* new_circuit = _socket.create_circuit();
+
+  if (!new_circuit)
+  {
+    return nullptr;
+  }
+
+  for (auto router : path)
+  {
+    const size_type previous_hop_count = new_circuit->get_circuit_node_list_size();
+
+    new_circuit->extend(router);
+
+    if (new_circuit->get_circuit_node_list_size() != (previous_hop_count + 1))
+    {
+      mini_debug(
+        "circuit_pool::build_circuit() [failed to extend to '%s']",
+        router->get_name().get_buffer());
+
+      delete new_circuit;
+      return nullptr;
+    }
+  }
+
+  mini_debug(
+    "circuit_pool::build_circuit() [purpose: %s, circuit: %u, hops: %u]",
+    circuit_purpose == purpose::general ? "general" : "internal",
+    new_circuit->get_circuit_id() & 0x7FFFFFFF,
+    static_cast<uint32_t>(new_circuit->get_circuit_node_list_size()));
+
+  return new_circuit;
+}
+
+bool
+circuit_pool::allows_predicted_ports(
+  const onion_router* router
+  ) const
+{
+  for (auto port : _options.predicted_ports)
+  {
+    if (!router->allows_exit_port(port))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool
+circuit_pool::is_usable(
+  const pooled_circuit& entry
+  ) const
+{
+  return
+    !entry.instance->is_destroyed() &&
+    time::timestamp() - entry.built_at < static_cast<timestamp_type>(_options.max_circuit_age);
+}
+
+void
+circuit_pool::collect_stale_circuits(
+  pooled_circuit_list& circuits,
+  collections::list<circuit*>& stale_circuits
+  )
+{
+  for (size_type i = 0; i < circuits.get_size(); )
+  {
+    if (is_usable(circuits[i]))
+    {
+      i++;
+    }
+    else
+    {
+      stale_circuits.add(circuits[i].instance);
+      circuits.remove_at(i);
+    }
+  }
+}
+
+circuit_pool::pooled_circuit_list&
+circuit_pool::get_circuit_list(
+  purpose circuit_purpose
+  )
+{
+  return circuit_purpose == purpose::general
+    ? _general_circuits
+    : _internal_circuits;
+}
+
+size_type&
+circuit_pool::get_build_count(
+  purpose circuit_purpose
+  )
+{
+  return circuit_purpose == purpose::general
+    ? _general_build_count
+    : _internal_build_count;
+}
+
+}
@@ -0,0 +1,190 @@
+#pragma once
+#include "consensus.h"
+
+#include <mini/ptr.h>
+#include <mini/collections/list.h>
+#include <mini/threading/event.h>
+#include <mini/threading/mutex.h>
+#include <mini/threading/thread_function.h>
+
+namespace mini::tor {
+
+class circuit;
+class tor_socket;
+
+//
+// keeps prebuilt circuits on the connected tor socket,
+// so the requests don't wait for the circuit to be built.
+//
+// general circuits end at an exit node which accepts
+// all the predicted ports. internal circuits end at
+// a middle node and are extended to the target
+// (hidden service directory, introduction point) by the caller.
+//
+// the pool is refilled by the builder threads,
+// the circuits are handed out from the back of the list.
+//
+
+class circuit_pool
+{
+  MINI_MAKE_NONCOPYABLE(circuit_pool);
+
+  public:
+    enum class purpose
+    {
+      general,
+      internal,
+    };
+
+    struct options
+    {
+      size_type general_circuit_count = 2;
+      size_type general_hop_count = 3;
+
+      size_type internal_circuit_count = 2;
+      size_type internal_hop_count = 2;
+
+      //
+      // ports the exit node of the general circuits must accept.
+      //
+      collections::list<uint16_t> predicted_ports = { 80, 443 };
+
+      //
+      // the prebuilt circuits older than this are thrown away.
+      //
+      timeout_type max_circuit_age = 10 * 60 * 1000;
+
+      size_type builder_thread_count = 2;
+    };
+
+    circuit_pool(
+      tor_socket& socket,
+      consensus& consensus,
+      const options& pool_options
+      );
+
+    ~circuit_pool(
+      void
+      );
+
+    void
+    start(
+      void
+      );
+
+    void
+    stop(
+      void
+      );
+
+    //
+    // returns nullptr if no circuit is ready.
+    // the caller owns the returned circuit.
+    //
+    circuit*
+    get_general_circuit(
+      void
+      );
+
+    circuit*
+    get_internal_circuit(
+      void
+      );
+
+    const options&
+    get_options(
+      void
+      ) const;
+
+  private:
+    //
+    // how often the idle builders check for the expired circuits.
+    //
+    static constexpr timeout_type refill_check_interval = 1000;
+
+    //
+    // how long the builder waits after a failed build.
+    //
+    static constexpr timeout_type build_retry_delay = 1000;
+
+    //
+    // how many exits are tried when the exit policy
+    // is known only after the microdescriptor is fetched.
+    //
+    static constexpr size_type max_exit_selection_attempts = 8;
+
+    struct pooled_circuit
+    {
+      circuit* instance;
+      timestamp_type built_at;
+    };
+
+    using pooled_circuit_list = collections::list<pooled_circuit>;
+
+    circuit*
+    get_circuit(
+      purpose circuit_purpose
+      );
+
+    void
+    builder_loop(
+      void
+      );
+
+    circuit*
+    build_circuit(
+      purpose circuit_purpose
+      );
+
+    bool
+    allows_predicted_ports(
+      const onion_router* router
+      ) const;
+
+    bool
+    is_usable(
+      const pooled_circuit& entry
+      ) const;
+
+    //
+    // moves the expired and destroyed circuits
+    // to the stale list. must be called under the lock.
+    //
+    void
+    collect_stale_circuits(
+      pooled_circuit_list& circuits,
+      collections::list<circuit*>& stale_circuits
+      );
+
+    pooled_circuit_list&
+    get_circuit_list(
+      purpose circuit_purpose
+      );
+
+    size_type&
+    get_build_count(
+      purpose circuit_purpose
+      );
+
+    tor_socket& _socket;
+    consensus& _consensus;
+    options _options;
+
+    pooled_circuit_list _general_circuits;
+    pooled_circuit_list _internal_circuits;
+
+    //
+    // circuits being built by the builder threads.
+    //
+    size_type _general_build_count = 0;
+    size_type _internal_build_count = 0;
+
+    threading::mutex _mutex;
+    threading::event _refill_event;
+    threading::event _stop_event;
+    bool _stop = false;
+
+    collections::list<ptr<threading::thread_function>> _builder_threads;
+};
+
+}
@@ -1,10 +1,16 @@
 #include "consensus.h"
+#include "consensus_cache.h"
 #include "parsers/consensus_parser.h"
+#include "parsers/microdescriptor_parser.h"
+#include "parsers/onion_router_descriptor_parser.h"
 
+#include <mini/ptr.h>
 #include <mini/logger.h>
 #include <mini/io/file.h>
 #include <mini/net/http.h>
 #include <mini/crypto/random.h>
+#include <mini/threading/mutex.h>
+#include <mini/threading/thread_function.h>
 
 namespace mini::tor {
 
@@ -65,6 +71,15 @@ consensus::consensus(
   create(cached_consensus_path, force_download);
 }
 
+consensus::consensus(
+  content_tag,
+  const string_ref consensus_content,
+  bool reject_invalid
+  )
+{
+  parse_consensus(consensus_content, reject_invalid);
+}
+
 consensus::~consensus(
   void
   )
@@ -81,6 +96,25 @@ consensus::create(
   string consensus_content;
   bool have_valid_consensus = false;
 
+  //
+  // the binary snapshot of the cached consensus
+  // is loaded without parsing.
+  //
+  const string cache_path = !cached_consensus_path.is_empty()
+    ? string(cached_consensus_path) + ".bin"
+    : string();
+
+  if (!force_download && !cache_path.is_empty())
+  {
+    if (consensus_cache::load(*this, cache_path))
+    {
+      mini_debug("consensus::create() [loaded from cache: %s]", cache_path.get_buffer());
+
+      _descriptor_cache.open(*this, string(cached_consensus_path) + ".descriptors");
+      return;
+    }
+  }
+
   //
   // if no path to the cached consensus file
   // was provided, we have to download it.
@@ -145,6 +179,16 @@ consensus::create(
   {
     io::file::write_from_string(cached_consensus_path, consensus_content);
   }
+
+  //
+  // the next start doesn't need to parse it again.
+  //
+  if (!cache_path.is_empty())
+  {
+    consensus_cache::save(*this, cache_path);
+
+    _descriptor_cache.open(*this, string(cached_consensus_path) + ".descriptors");
+  }
 }
 
 void
@@ -163,17 +207,11 @@ consensus::get_onion_router_by_name(
   const string_ref name
   ) const
 {
-  for (auto&& pair : _onion_router_map)
-  {
-    auto router = pair.second;
-
-    if (name == router->get_name())
-    {
-      return router;
-    }
-  }
+  auto it = _onion_router_name_map.find(name);
 
-  return nullptr;
+  return it != _onion_router_name_map.end()
+    ? it->second
+    : nullptr;
 }
 
 onion_router*
@@ -181,7 +219,19 @@ consensus::get_onion_router_by_identity_fingerprint(
   const byte_buffer_ref identity_fingerprint
   )
 {
-  return _onion_router_map[identity_fingerprint];
+  auto it = _onion_router_map.find(identity_fingerprint);
+
+  return it != _onion_router_map.end()
+    ? it->second
+    : nullptr;
+}
+
+const onion_router_list&
+consensus::get_hsdir_ring(
+  void
+  ) const
+{
+  return _hsdir_ring;
 }
 
 onion_router_list
@@ -191,70 +241,289 @@ consensus::get_onion_routers_by_criteria(
 {
   onion_router_list result;
 
-  for (auto&& pair : _onion_router_map)
+  for (auto router : get_onion_router_index(criteria.flags))
   {
-    auto router = pair.second;
+    if (matches_criteria(router, criteria))
+    {
+      result.add(router);
+    }
+  }
+
+  return result;
+}
 
-    if (!criteria.allowed_dir_ports.is_empty())
+onion_router*
+consensus::get_random_onion_router_by_criteria(
+  const search_criteria& criteria
+  ) const
+{
+  if (criteria.position != path_position::any)
+  {
+    if (onion_router* router = get_random_weighted_onion_router_by_criteria(criteria))
+    {
+      return router;
+    }
+
+    //
+    // no bandwidth information, fall back
+    // to the uniform selection.
+    //
+  }
+
+  const onion_router_list& candidates = get_onion_router_index(criteria.flags);
+
+  if (candidates.is_empty())
+  {
+    return nullptr;
+  }
+
+  //
+  // most of the candidates usually match,
+  // so try to pick one directly first.
+  //
+  for (size_type i = 0; i < random_pick_try_count; i++)
+  {
+    onion_router* router = candidates[crypto::random_device.get_random(candidates.get_size())];
+
+    if (matches_criteria(router, criteria))
     {
-      if (criteria.allowed_dir_ports.index_of(router->get_dir_port()) == collections::list<uint16_t>::not_found)
+      return router;
+    }
+  }
+
+  //
+  // only few of them match, count them
+  // and pick the random one in the second pass.
+  //
+  size_type match_count = 0;
+  for (auto router : candidates)
+  {
+    if (matches_criteria(router, criteria))
+    {
+      match_count++;
+    }
+  }
+
+  if (match_count == 0)
+  {
+    return nullptr;
+  }
+
+  size_type random_index = crypto::random_device.get_random(match_count);
+  for (auto router : candidates)
+  {
+    if (matches_criteria(router, criteria) && random_index-- == 0)
+    {
+      return router;
+    }
+  }
+
+  return nullptr;
+}
+
+int32_t
+consensus::get_bandwidth_weight(
+  bandwidth_weight weight
+  ) const
+{
+  return _bandwidth_weights[static_cast<size_type>(weight)];
+}
+
+string
+consensus::get_onion_router_descriptor(
+  const byte_buffer_ref identity_fingerprint
+  )
+{
+  return download_from_random_router("/tor/server/fp/" + crypto::base16::encode(identity_fingerprint));
+}
+
+consensus::flavor
+consensus::get_flavor(
+  void
+  ) const
+{
+  return _flavor;
+}
+
+void
+consensus::prefetch_descriptors(
+  const onion_router_list& routers
+  )
+{
+  //
+  // the circuit pool builds the circuits from multiple threads.
+  // each onion router is fetched by the first thread which asks
+  // for it, the others wait only for the onion routers they need.
+  // the downloads are performed outside of the lock.
+  //
+  const bool microdesc_flavor = _flavor == flavor::microdesc;
+
+  prefetch_request* own_request = nullptr;
+  collections::list<prefetch_request*> awaited_requests;
+
+  onion_router_list pending_routers;
+  pending_routers.reserve(routers.get_size());
+
+  mini_lock(_prefetch_mutex)
+  {
+    for (auto router : routers)
+    {
+      if (router->is_descriptor_fetched())
       {
         continue;
       }
-    }
 
-    if (!criteria.allowed_or_ports.is_empty())
-    {
-      if (criteria.allowed_or_ports.index_of(router->get_or_port()) == collections::list<uint16_t>::not_found)
+      if (microdesc_flavor && router->get_microdescriptor_digest().is_empty())
       {
         continue;
       }
-    }
 
-    if (!criteria.forbidden_onion_routers.is_empty())
-    {
-      if (criteria.forbidden_onion_routers.index_of(router) != onion_router_list::not_found)
+      //
+      // being fetched by another thread.
+      //
+      auto it = _prefetch_in_flight.find(router);
+
+      if (it != _prefetch_in_flight.end())
       {
+        prefetch_request* request = it->second;
+
+        if (!awaited_requests.contains(request))
+        {
+          request->reference_count++;
+          awaited_requests.add(request);
+        }
+
         continue;
       }
+
+      if (!own_request)
+      {
+        own_request = new prefetch_request();
+      }
+
+      _prefetch_in_flight.insert(router, own_request);
+      pending_routers.add(router);
     }
+  }
+
+  if (own_request)
+  {
+    fetch_descriptors(pending_routers);
 
-    if (criteria.flags != onion_router::status_flag::none)
+    mini_lock(_prefetch_mutex)
     {
-      if ((router->get_flags() & criteria.flags) != criteria.flags)
+      for (auto router : pending_routers)
       {
-        continue;
+        _prefetch_in_flight.remove(_prefetch_in_flight.find(router));
       }
     }
 
-    result.add(router);
+    own_request->done_event.set();
+    release_prefetch_request(own_request);
   }
 
-  return result;
+  for (auto request : awaited_requests)
+  {
+    request->done_event.wait();
+    release_prefetch_request(request);
+  }
 }
 
-onion_router*
-consensus::get_random_onion_router_by_criteria(
-  const search_criteria& criteria
-  ) const
+void
+consensus::fetch_descriptors(
+  const onion_router_list& routers
+  )
 {
-  auto routers = get_onion_routers_by_criteria(criteria);
+  const size_type batch_size = _flavor == flavor::microdesc
+    ? microdescriptor_batch_size
+    : descriptor_batch_size;
 
-  // Vérifier que la liste n'est pas vide avant de générer un index aléatoire
-  const size_type random_index = routers.get_size() > 0 ? 
-    crypto::random_device.get_random(routers.get_size()) : 0;
+  const size_type batch_count = (routers.get_size() + batch_size - 1) / batch_size;
 
-  return !routers.is_empty()
-    ? routers[random_index]
-    : nullptr;
+  auto fetch_batch = [&](size_type batch_index) {
+    const size_type first = batch_index * batch_size;
+    const size_type last = algorithm::min(first + batch_size, routers.get_size());
+
+    onion_router_list batch;
+    batch.add_many(buffer_ref<onion_router*>(
+      routers.get_buffer() + first,
+      routers.get_buffer() + last));
+
+    fetch_descriptor_batch(batch);
+  };
+
+  if (batch_count <= 1)
+  {
+    if (batch_count == 1)
+    {
+      fetch_batch(0);
+    }
+
+    return;
+  }
+
+  //
+  // each thread takes the next batch and downloads it
+  // from a random directory.
+  //
+  size_type next_batch_index = 0;
+  threading::mutex next_batch_index_mutex;
+
+  collections::list<ptr<threading::thread_function>> thread_list;
+  const size_type thread_count = algorithm::min(batch_count, max_parallel_download_count);
+
+  for (size_type i = 0; i < thread_count; i++)
+  {
+    ptr<threading::thread_function> thread(new threading::thread_function([&]() {
+      for (;;)
+      {
+        size_type batch_index;
+
+        mini_lock(next_batch_index_mutex)
+        {
+          batch_index = next_batch_index++;
+        }
+
+        if (batch_index >= batch_count)
+        {
+          break;
+        }
+
+        fetch_batch(batch_index);
+      }
+    }));
+
+    thread->start();
+    thread_list.add(std::move(thread));
+  }
+
+  for (auto& thread : thread_list)
+  {
+    thread->join();
+  }
+
+  mini_debug(
+    "consensus::fetch_descriptors() [routers: %u, batches: %u]",
+    static_cast<uint32_t>(routers.get_size()),
+    static_cast<uint32_t>(batch_count));
 }
 
-string
-consensus::get_onion_router_descriptor(
-  const byte_buffer_ref identity_fingerprint
+void
+consensus::release_prefetch_request(
+  prefetch_request* request
   )
 {
-  return download_from_random_router("/tor/server/fp/" + crypto::base16::encode(identity_fingerprint));
+  bool unreferenced;
+
+  mini_lock(_prefetch_mutex)
+  {
+    unreferenced = --request->reference_count == 0;
+  }
+
+  if (unreferenced)
+  {
+    delete request;
+  }
 }
 
 //
@@ -355,7 +624,7 @@ consensus::download_from_random_router_impl(
   else
   {
     auto router = get_random_onion_router_by_criteria({
-      _allowed_dir_ports, {}, {}, _allowed_dir_flags
+      _allowed_dir_ports, {}, {}, _allowed_dir_flags, path_position::any, {}
     });
 
     ip = router->get_ip_address();
@@ -371,22 +640,361 @@ consensus::download_from_random_router_impl(
   return net::http::client::get(ip.to_string(), port, path);
 }
 
+void
+consensus::fetch_descriptor_batch(
+  const onion_router_list& routers
+  )
+{
+  if (_flavor == flavor::microdesc)
+  {
+    fetch_microdescriptor_batch(routers);
+    return;
+  }
+
+  //
+  // "/tor/server/fp/<F1>+<F2>+...", where the fingerprints
+  // are base16 encoded.
+  //
+  string path = "/tor/server/fp/";
+
+  for (size_type i = 0; i < routers.get_size(); i++)
+  {
+    if (i > 0)
+    {
+      path += "+";
+    }
+
+    path += crypto::base16::encode(routers[i]->get_identity_fingerprint());
+  }
+
+  onion_router_descriptor_parser parser;
+  const size_type fetched_count = parser.parse(routers, download_from_random_router(path));
+
+  _descriptor_cache.append(routers);
+
+  mini_debug(
+    "consensus::fetch_descriptors() [fetched: %u/%u]",
+    static_cast<uint32_t>(fetched_count),
+    static_cast<uint32_t>(routers.get_size()));
+}
+
+void
+consensus::fetch_microdescriptor_batch(
+  const onion_router_list& routers
+  )
+{
+  //
+  // "/tor/micro/d/<D1>-<D2>-...", where the digests
+  // are base64 encoded without the trailing "=".
+  //
+  string path = "/tor/micro/d/";
+
+  for (size_type i = 0; i < routers.get_size(); i++)
+  {
+    if (i > 0)
+    {
+      path += "-";
+    }
+
+    const string digest = crypto::base64::encode(routers[i]->get_microdescriptor_digest());
+    const size_type padding = digest.index_of("=");
+
+    path += padding == string::not_found
+      ? string_ref(digest)
+      : digest.substring(0, padding);
+  }
+
+  microdescriptor_parser parser;
+  const size_type fetched_count = parser.parse(routers, download_from_random_router(path));
+
+  _descriptor_cache.append(routers);
+
+  mini_debug(
+    "consensus::fetch_microdescriptors() [fetched: %u/%u]",
+    static_cast<uint32_t>(fetched_count),
+    static_cast<uint32_t>(routers.get_size()));
+}
+
 void
 consensus::parse_consensus(
   const string_ref consensus_content,
   bool reject_invalid
   )
 {
-  //
-  // clear the map first.
-  //
-  _onion_router_map.clear();
+  reset_onion_routers();
 
   //
   // parse the consensus document.
   //
   consensus_parser parser;
   parser.parse(*this, consensus_content, reject_invalid);
+
+  build_onion_router_index();
+}
+
+void
+consensus::reset_onion_routers(
+  void
+  )
+{
+  //
+  // clear the maps first.
+  //
+  destroy();
+  _onion_router_map.clear();
+  _onion_router_name_map.clear();
+  _flavor = flavor::ns;
+
+  //
+  // consensus without the "bandwidth-weights"
+  // weights all positions equally.
+  //
+  for (auto& bandwidth_weight : _bandwidth_weights)
+  {
+    bandwidth_weight = bandwidth_weight_scale;
+  }
+}
+
+void
+consensus::build_onion_router_index(
+  void
+  )
+{
+  _onion_router_list.clear();
+  _hsdir_ring.clear();
+
+  for (auto& flag_index : _onion_router_flag_index)
+  {
+    flag_index.clear();
+  }
+
+  _onion_router_list.reserve(_onion_router_map.get_size());
+
+  for (auto&& pair : _onion_router_map)
+  {
+    auto router = pair.second;
+    const uint16_t router_flags = router->get_flags();
+
+    _onion_router_list.add(router);
+
+    for (size_type flag_bit = 0; flag_bit < status_flag_count; flag_bit++)
+    {
+      if (router_flags & (1 << flag_bit))
+      {
+        _onion_router_flag_index[flag_bit].add(router);
+      }
+    }
+
+    if (router->get_flags() & onion_router::status_flag::hsdir)
+    {
+      _hsdir_ring.add(router);
+    }
+  }
+
+  //
+  // the hidden service directories are looked up
+  // by the binary search on the ring.
+  //
+  algorithm::sort(_hsdir_ring.begin(), _hsdir_ring.end(), [](onion_router* lhs, onion_router* rhs) {
+    return lhs->get_identity_fingerprint().compare(rhs->get_identity_fingerprint()) < 0;
+  });
+
+  //
+  // weighted selection tables for each position.
+  //
+  collections::list<uint64_t> weight_list;
+  weight_list.reserve(_onion_router_list.get_size());
+
+  for (size_type position = 0; position < path_position_count; position++)
+  {
+    _onion_router_alias_table[position].clear();
+
+    if (static_cast<path_position>(position) == path_position::any)
+    {
+      continue;
+    }
+
+    weight_list.clear();
+
+    for (auto router : _onion_router_list)
+    {
+      weight_list.add(get_weighted_bandwidth(router, static_cast<path_position>(position)));
+    }
+
+    _onion_router_alias_table[position].build(weight_list);
+  }
+}
+
+const onion_router_list&
+consensus::get_onion_router_index(
+  onion_router::status_flags flags
+  ) const
+{
+  const onion_router_list* result = &_onion_router_list;
+  const uint16_t requested_flags = flags;
+
+  for (size_type flag_bit = 0; flag_bit < status_flag_count; flag_bit++)
+  {
+    if ((requested_flags & (1 << flag_bit)) &&
+        _onion_router_flag_index[flag_bit].get_size() < result->get_size())
+    {
+      result = &_onion_router_flag_index[flag_bit];
+    }
+  }
+
+  return *result;
+}
+
+bool
+consensus::matches_criteria(
+  const onion_router* router,
+  const search_criteria& criteria
+  )
+{
+  if (criteria.flags != onion_router::status_flag::none)
+  {
+    if ((router->get_flags() & criteria.flags) != criteria.flags)
+    {
+      return false;
+    }
+  }
+
+  if (!criteria.allowed_dir_ports.is_empty())
+  {
+    if (criteria.allowed_dir_ports.index_of(router->get_dir_port()) == collections::list<uint16_t>::not_found)
+    {
+      return false;
+    }
+  }
+
+  if (!criteria.allowed_or_ports.is_empty())
+  {
+    if (criteria.allowed_or_ports.index_of(router->get_or_port()) == collections::list<uint16_t>::not_found)
+    {
+      return false;
+    }
+  }
+
+  if (!criteria.forbidden_onion_routers.is_empty())
+  {
+    if (criteria.forbidden_onion_routers.contains(const_cast<onion_router*>(router)))
+    {
+      return false;
+    }
+  }
+
+  for (auto port : criteria.allowed_exit_ports)
+  {
+    if (!router->allows_exit_port(port))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+uint64_t
+consensus::get_weighted_bandwidth(
+  const onion_router* router,
+  path_position position
+  ) const
+{
+  //
+  // the bandwidth of the router is multiplied by the weight
+  // of the position, which depends on whether the router
+  // is a guard, an exit, both (D) or none (M).
+  //
+  const bool is_guard = router->get_flags() & onion_router::status_flag::guard;
+  const bool is_exit =
+    (router->get_flags() & onion_router::status_flag::exit) &&
+    !(router->get_flags() & onion_router::status_flag::bad_exit);
+
+  static constexpr bandwidth_weight no_weight = static_cast<bandwidth_weight>(bandwidth_weight_count);
+
+  //
+  // indexed by [position][is_guard][is_exit].
+  //
+  static constexpr bandwidth_weight weight_table[path_position_count][2][2] = {
+    { { no_weight,             no_weight             }, { no_weight,             no_weight             } }, // any
+    { { bandwidth_weight::wgm, no_weight             }, { bandwidth_weight::wgg, bandwidth_weight::wgd } }, // guard
+    { { bandwidth_weight::wmm, bandwidth_weight::wme }, { bandwidth_weight::wmg, bandwidth_weight::wmd } }, // middle
+    { { bandwidth_weight::wem, bandwidth_weight::wee }, { bandwidth_weight::weg, bandwidth_weight::wed } }, // exit
+  };
+
+  const bandwidth_weight weight = weight_table[static_cast<size_type>(position)][is_guard][is_exit];
+
+  if (weight == no_weight)
+  {
+    return 0;
+  }
+
+  return static_cast<uint64_t>(router->get_bandwidth()) * get_bandwidth_weight(weight);
+}
+
+onion_router*
+consensus::get_random_weighted_onion_router_by_criteria(
+  const search_criteria& criteria
+  ) const
+{
+  const alias_table& table = _onion_router_alias_table[static_cast<size_type>(criteria.position)];
+
+  if (table.is_empty())
+  {
+    return nullptr;
+  }
+
+  //
+  // the alias table covers all the onion routers,
+  // pick until one matches the criteria.
+  //
+  for (size_type i = 0; i < random_pick_try_count; i++)
+  {
+    onion_router* router = _onion_router_list[table.pick()];
+
+    if (matches_criteria(router, criteria))
+    {
+      return router;
+    }
+  }
+
+  //
+  // only few of them match, sum their weights
+  // and pick the random one in the second pass.
+  //
+  const onion_router_list& candidates = get_onion_router_index(criteria.flags);
+
+  uint64_t total_weight = 0;
+  for (auto router : candidates)
+  {
+    if (matches_criteria(router, criteria))
+    {
+      total_weight += get_weighted_bandwidth(router, criteria.position);
+    }
+  }
+
+  if (total_weight == 0)
+  {
+    return nullptr;
+  }
+
+  uint64_t random_weight = crypto::random_device.get_random<uint64_t>() % total_weight;
+  for (auto router : candidates)
+  {
+    if (matches_criteria(router, criteria))
+    {
+      const uint64_t weight = get_weighted_bandwidth(router, criteria.position);
+
+      if (random_weight < weight)
+      {
+        return router;
+      }
+
+      random_weight -= weight;
+    }
+  }
+
+  return nullptr;
 }
 
 }
@@ -1,29 +1,102 @@
 #pragma once
 #include "onion_router.h"
+#include "alias_table.h"
+#include "descriptor_cache.h"
 
 #include <mini/time.h>
+#include <mini/threading/mutex.h>
+#include <mini/threading/event.h>
 #include <mini/stack_buffer.h>
-#include <mini/collections/pair_list.h>
+#include <mini/collections/hashmap.h>
 
 namespace mini::tor {
 
 class consensus
 {
   public:
+    //
+    // position of the onion router in the circuit.
+    // determines the bandwidth weights used for the selection,
+    // 'any' selects uniformly.
+    //
+    enum class path_position
+    {
+      any,
+      guard,
+      middle,
+      exit,
+    };
+
+    static constexpr size_type path_position_count = 4;
+
+    //
+    // dir-spec.txt
+    // 3.4.1.
+    //
+    // "bandwidth-weights" [At most once]
+    //
+    enum class bandwidth_weight
+    {
+      wbd, wbe, wbg, wbm,
+      wdb,
+      web, wed, wee, weg, wem,
+      wgb, wgd, wgg, wgm,
+      wmb, wmd, wme, wmg, wmm,
+    };
+
+    static constexpr size_type bandwidth_weight_count = 19;
+
+    //
+    // the weights are fractions of this value.
+    //
+    static constexpr int32_t bandwidth_weight_scale = 10000;
+
+    //
+    // dir-spec.txt
+    // 3.9.2.
+    //
+    // the microdesc flavored consensus references
+    // microdescriptors instead of the server descriptors.
+    //
+    enum class flavor
+    {
+      ns,
+      microdesc,
+    };
+
     struct search_criteria
     {
       collections::list<uint16_t> allowed_dir_ports;
       collections::list<uint16_t> allowed_or_ports;
-      onion_router_list forbidden_onion_routers;
+      onion_router_set forbidden_onion_routers;
       onion_router::status_flags flags;
+      path_position position = path_position::any;
+
+      //
+      // the exit policy summary must accept all of them.
+      //
+      collections::list<uint16_t> allowed_exit_ports;
     };
 
+    //
+    // selects the constructor which only parses
+    // the given consensus document, nothing is
+    // downloaded or cached.
+    //
+    struct content_tag {};
+
   public:
     consensus(
       const string_ref cached_consensus_path = nullptr,
       bool force_download = false
       );
 
+    consensus(
+      content_tag,
+      const string_ref consensus_content,
+      bool reject_invalid = false
+      );
+
     ~consensus(
       void
       );
@@ -53,6 +126,15 @@ class consensus
       const byte_buffer_ref identity_fingerprint
       );
 
+    //
+    // onion routers with the hsdir flag,
+    // sorted by the identity fingerprint.
+    //
+    const onion_router_list&
+    get_hsdir_ring(
+      void
+      ) const;
+
     onion_router_list
     get_onion_routers_by_criteria(
       const search_criteria& criteria
@@ -63,11 +145,32 @@ class consensus
       const search_criteria& criteria
       ) const;
 
+    int32_t
+    get_bandwidth_weight(
+      bandwidth_weight weight
+      ) const;
+
     string
     get_onion_router_descriptor(
       const byte_buffer_ref identity_fingerprint
       );
 
+    flavor
+    get_flavor(
+      void
+      ) const;
+
+    //
+    // fetches the descriptors (or the microdescriptors)
+    // of the onion routers, which haven't been fetched yet.
+    // many onion routers are requested at once and the batches
+    // are downloaded in parallel from the different directories.
+    //
+    void
+    prefetch_descriptors(
+      const onion_router_list& routers
+      );
+
     //
     // directories
     //
@@ -110,6 +213,7 @@ class consensus
 
   private:
     friend struct consensus_parser;
+    friend struct consensus_cache;
 
     string
     download_from_random_router_impl(
@@ -123,6 +227,95 @@ class consensus
       bool reject_invalid
       );
 
+    //
+    // clears the maps before they're filled
+    // by the parser or from the cache.
+    //
+    void
+    reset_onion_routers(
+      void
+      );
+
+    void
+    build_onion_router_index(
+      void
+      );
+
+    //
+    // returns the candidates for the requested flags:
+    // the onion routers having the rarest of them set,
+    // or all onion routers if no flag is requested.
+    // the caller filters out the routers lacking the other flags.
+    //
+    const onion_router_list&
+    get_onion_router_index(
+      onion_router::status_flags flags
+      ) const;
+
+    static bool
+    matches_criteria(
+      const onion_router* router,
+      const search_criteria& criteria
+      );
+
+    //
+    // dir-spec.txt
+    // 3.8.3.
+    //
+    uint64_t
+    get_weighted_bandwidth(
+      const onion_router* router,
+      path_position position
+      ) const;
+
+    onion_router*
+    get_random_weighted_onion_router_by_criteria(
+      const search_criteria& criteria
+      ) const;
+
+    //
+    // downloads the descriptors in batches,
+    // no other thread fetches these onion routers.
+    //
+    void
+    fetch_descriptors(
+      const onion_router_list& routers
+      );
+
+    void
+    fetch_descriptor_batch(
+      const onion_router_list& routers
+      );
+
+    void
+    fetch_microdescriptor_batch(
+      const onion_router_list& routers
+      );
+
+    //
+    // number of fingerprints in a single "/tor/server/fp/" request
+    // and number of digests in a single "/tor/micro/d/" request.
+    //
+    static constexpr size_type descriptor_batch_size = 64;
+    static constexpr size_type microdescriptor_batch_size = 64;
+
+    //
+    // number of the directories downloading at once.
+    //
+    static constexpr size_type max_parallel_download_count = 4;
+
+    //
+    // number of random picks tried before
+    // get_random_onion_router_by_criteria() falls back
+    // to counting all the matching onion routers.
+    //
+    static constexpr size_type random_pick_try_count = 16;
+
+    //
+    // number of bits in the onion_router::status_flag.
+    //
+    static constexpr size_type status_flag_count = 13;
+
     onion_router::status_flags _allowed_dir_flags =
       onion_router::status_flag::fast    |
       onion_router::status_flag::valid   |
@@ -132,8 +325,56 @@ class consensus
     collections::list<uint16_t> _allowed_dir_ports;
     size_type _max_try_count = 3;
 
-    collections::pair_list<byte_buffer, onion_router*> _onion_router_map;
+    //
+    // the keys reference the fingerprint and the name
+    // owned by the onion router itself.
+    // the onion routers are owned by the first map.
+    //
+    collections::hashmap<byte_buffer_ref, onion_router*> _onion_router_map;
+    collections::hashmap<string_ref, onion_router*> _onion_router_name_map;
+
+    //
+    // all onion routers and the onion routers
+    // having the particular flag set (indexed by the flag bit).
+    //
+    onion_router_list _onion_router_list;
+    onion_router_list _onion_router_flag_index[status_flag_count];
+    onion_router_list _hsdir_ring;
+
+    //
+    // weighted selection over _onion_router_list,
+    // indexed by the path_position (except 'any').
+    //
+    alias_table _onion_router_alias_table[path_position_count];
+
+    int32_t _bandwidth_weights[bandwidth_weight_count];
     time _valid_until;
+    flavor _flavor = flavor::ns;
+
+    //
+    // the fetched descriptors are kept
+    // next to the cached consensus.
+    //
+    descriptor_cache _descriptor_cache;
+
+    //
+    // onion routers claimed by a prefetch_descriptors() call.
+    // the request is shared by the thread which fetches
+    // the onion routers and the threads waiting for them.
+    //
+    struct prefetch_request
+    {
+      threading::event done_event;
+      size_type reference_count = 1;
+    };
+
+    void
+    release_prefetch_request(
+      prefetch_request* request
+      );
+
+    collections::hashmap<onion_router*, prefetch_request*> _prefetch_in_flight;
+    threading::mutex _prefetch_mutex;
 };
 
 }
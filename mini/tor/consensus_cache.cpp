@@ -0,0 +1,272 @@
+#include "consensus_cache.h"
+
+#include <mini/logger.h>
+#include <mini/algorithm.h>
+#include <mini/io/file_stream.h>
+#include <mini/io/memory_mapped_file.h>
+
+namespace mini::tor {
+
+bool
+consensus_cache::load(
+  consensus& consensus,
+  const string_ref path,
+  bool reject_invalid
+  )
+{
+  io::memory_mapped_file file;
+
+  if (!file.open(path))
+  {
+    return false;
+  }
+
+  const byte_buffer_ref data = file.get_buffer();
+
+  if (data.get_size() < sizeof(header))
+  {
+    mini_warning("consensus_cache::load() [truncated header]");
+    return false;
+  }
+
+  header h;
+  memory::copy(&h, data.get_buffer(), sizeof(h));
+
+  if (h.magic != magic ||
+      h.version != version ||
+      h.header_size != sizeof(header) ||
+      h.record_size != sizeof(router_record))
+  {
+    mini_warning("consensus_cache::load() [unsupported format]");
+    return false;
+  }
+
+  const size_type expected_size =
+    sizeof(header) +
+    static_cast<size_type>(h.router_count) * sizeof(router_record) +
+    h.string_table_size;
+
+  if (data.get_size() != expected_size)
+  {
+    mini_warning("consensus_cache::load() [size mismatch]");
+    return false;
+  }
+
+  const byte_buffer_ref body = data.slice(sizeof(header));
+
+  if (compute_checksum(body) != h.checksum)
+  {
+    mini_warning("consensus_cache::load() [checksum mismatch]");
+    return false;
+  }
+
+  if (reject_invalid && time(h.valid_until) < time::now())
+  {
+    mini_debug("consensus_cache::load() [expired]");
+    return false;
+  }
+
+  const byte_type* record_table = body.get_buffer();
+  const char* string_table = reinterpret_cast<const char*>(
+    record_table + static_cast<size_type>(h.router_count) * sizeof(router_record));
+
+  consensus.reset_onion_routers();
+
+  for (uint32_t i = 0; i < h.router_count; i++)
+  {
+    //
+    // the records aren't guaranteed to be aligned
+    // in the mapped view.
+    //
+    router_record record;
+    memory::copy(&record, record_table + i * sizeof(router_record), sizeof(record));
+
+    if (static_cast<size_type>(record.name_offset) + record.name_size > h.string_table_size ||
+        static_cast<size_type>(record.exit_policy_offset) + record.exit_policy_size > h.string_table_size)
+    {
+      mini_warning("consensus_cache::load() [invalid string offset]");
+      consensus.reset_onion_routers();
+      return false;
+    }
+
+    onion_router* router = new onion_router(
+      consensus,
+      string_ref(string_table + record.name_offset, record.name_size),
+      net::ip_address(record.ip),
+      record.or_port,
+      record.dir_port,
+      byte_buffer_ref(record.identity_fingerprint));
+
+    router->set_flags(onion_router::status_flags(record.flags));
+    router->set_bandwidth(record.bandwidth);
+    router->set_exit_policy(string_ref(string_table + record.exit_policy_offset, record.exit_policy_size));
+
+    if (h.flavor == static_cast<uint32_t>(consensus::flavor::microdesc))
+    {
+      router->set_microdescriptor_digest(byte_buffer_ref(record.microdescriptor_digest));
+    }
+    else
+    {
+      router->set_descriptor_digest(byte_buffer_ref(record.descriptor_digest));
+    }
+
+    consensus._onion_router_map.insert(router->get_identity_fingerprint(), router);
+
+    //
+    // nicknames aren't unique, keep the first one.
+    //
+    if (!consensus._onion_router_name_map.contains(router->get_name()))
+    {
+      consensus._onion_router_name_map.insert(router->get_name(), router);
+    }
+  }
+
+  for (size_type i = 0; i < consensus::bandwidth_weight_count; i++)
+  {
+    consensus._bandwidth_weights[i] = h.bandwidth_weights[i];
+  }
+
+  consensus._valid_until = time(h.valid_until);
+  consensus._flavor = static_cast<consensus::flavor>(h.flavor);
+  consensus.build_onion_router_index();
+
+  return true;
+}
+
+bool
+consensus_cache::save(
+  const consensus& consensus,
+  const string_ref path
+  )
+{
+  //
+  // sort the routers by the identity fingerprint,
+  // so the snapshot doesn't depend on the hashmap order.
+  //
+  onion_router_list routers;
+  routers.reserve(consensus._onion_router_map.get_size());
+
+  for (auto&& pair : consensus._onion_router_map)
+  {
+    routers.add(pair.second);
+  }
+
+  algorithm::sort(routers.begin(), routers.end(), [](onion_router* lhs, onion_router* rhs) {
+    return memory::compare(
+      lhs->get_identity_fingerprint().get_buffer(),
+      rhs->get_identity_fingerprint().get_buffer(),
+      sizeof(router_record::identity_fingerprint)) < 0;
+  });
+
+  byte_buffer records;
+  byte_buffer string_table;
+
+  records.reserve(routers.get_size() * sizeof(router_record));
+
+  for (auto router : routers)
+  {
+    if (router->get_identity_fingerprint().get_size() != sizeof(router_record::identity_fingerprint))
+    {
+      continue;
+    }
+
+    router_record record = { };
+    memory::copy(
+      record.identity_fingerprint,
+      router->get_identity_fingerprint().get_buffer(),
+      sizeof(record.identity_fingerprint));
+
+    if (router->get_descriptor_digest().get_size() == sizeof(record.descriptor_digest))
+    {
+      memory::copy(
+        record.descriptor_digest,
+        router->get_descriptor_digest().get_buffer(),
+        sizeof(record.descriptor_digest));
+    }
+
+    if (router->get_microdescriptor_digest().get_size() == sizeof(record.microdescriptor_digest))
+    {
+      memory::copy(
+        record.microdescriptor_digest,
+        router->get_microdescriptor_digest().get_buffer(),
+        sizeof(record.microdescriptor_digest));
+    }
+
+    record.ip = router->get_ip_address().to_int();
+    record.bandwidth = router->get_bandwidth();
+    record.or_port = router->get_or_port();
+    record.dir_port = router->get_dir_port();
+    record.flags = static_cast<uint16_t>(router->get_flags());
+
+    record.name_offset = static_cast<uint32_t>(string_table.get_size());
+    record.name_size = static_cast<uint16_t>(router->get_name().get_size());
+    string_table.add_many(router->get_name());
+    string_table.add(0);
+
+    record.exit_policy_offset = static_cast<uint32_t>(string_table.get_size());
+    record.exit_policy_size = static_cast<uint16_t>(router->get_exit_policy().get_size());
+    string_table.add_many(router->get_exit_policy());
+    string_table.add(0);
+
+    records.add_many(byte_buffer_ref(
+      reinterpret_cast<const byte_type*>(&record),
+      reinterpret_cast<const byte_type*>(&record) + sizeof(record)));
+  }
+
+  header h = { };
+  h.magic = magic;
+  h.version = version;
+  h.header_size = sizeof(header);
+  h.record_size = sizeof(router_record);
+  h.router_count = static_cast<uint32_t>(records.get_size() / sizeof(router_record));
+  h.string_table_size = static_cast<uint32_t>(string_table.get_size());
+  h.valid_until = static_cast<uint32_t>(consensus._valid_until.to_timestamp());
+  h.flavor = static_cast<uint32_t>(consensus._flavor);
+
+  for (size_type i = 0; i < consensus::bandwidth_weight_count; i++)
+  {
+    h.bandwidth_weights[i] = consensus._bandwidth_weights[i];
+  }
+
+  records.add_many(string_table);
+  h.checksum = compute_checksum(records);
+
+  io::file_stream file(path, io::file_access::write, io::file_mode::create);
+
+  if (!file.is_open())
+  {
+    mini_warning("consensus_cache::save() [cannot open: %s]", path.get_buffer());
+    return false;
+  }
+
+  const bool result =
+    file.write(&h, sizeof(h)) == sizeof(h) &&
+    file.write(records) == records.get_size();
+
+  mini_debug("consensus_cache::save() [%u routers, %u bytes]",
+    h.router_count,
+    static_cast<uint32_t>(sizeof(h) + records.get_size()));
+
+  return result;
+}
+
+uint32_t
+consensus_cache::compute_checksum(
+  const byte_buffer_ref data
+  )
+{
+  //
+  // FNV-1a.
+  //
+  uint32_t result = 0x811c9dc5;
+
+  for (auto b : data)
+  {
+    result ^= b;
+    result *= 0x01000193;
+  }
+
+  return result;
+}
+
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <mini/tor/consensus.h>
+
+namespace mini::tor {
+
+//
+// binary snapshot of the parsed consensus.
+//
+// layout:
+//   header
+//   router_record[router_count] (sorted by the identity fingerprint)
+//   string table (zero-terminated nicknames and exit policies)
+//
+// the snapshot is loaded from the memory mapped file,
+// nothing is parsed. when the header, the checksum or the
+// validity doesn't match, the caller falls back to the text consensus.
+//
+
+struct consensus_cache
+{
+  static constexpr uint32_t magic   = 0x4343544d; // "MTCC"
+  static constexpr uint32_t version = 4;
+
+  struct header
+  {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t record_size;
+    uint32_t router_count;
+    uint32_t string_table_size;
+    uint32_t valid_until;
+    uint32_t checksum;
+    uint32_t flavor;
+    int32_t  bandwidth_weights[consensus::bandwidth_weight_count];
+  };
+
+  struct router_record
+  {
+    uint8_t  identity_fingerprint[20];
+    uint8_t  descriptor_digest[20];
+    uint8_t  microdescriptor_digest[32];
+    uint32_t ip;
+    uint32_t bandwidth;
+    uint32_t name_offset;
+    uint32_t exit_policy_offset;
+    uint16_t or_port;
+    uint16_t dir_port;
+    uint16_t flags;
+    uint16_t name_size;
+    uint16_t exit_policy_size;
+    uint16_t reserved;
+  };
+
+  //
+  // returns false if the snapshot doesn't exist,
+  // is corrupted or expired (when reject_invalid is set).
+  //
+  static bool
+  load(
+    consensus& consensus,
+    const string_ref path,
+    bool reject_invalid = true
+    );
+
+  static bool
+  save(
+    const consensus& consensus,
+    const string_ref path
+    );
+
+  //
+  // checksum of everything behind the header.
+  //
+  static uint32_t
+  compute_checksum(
+    const byte_buffer_ref data
+    );
+};
+
+}
@@ -1,4 +1,5 @@
 #include "key_agreement_ntor.h"
+#include "ntor_key_pool.h"
 
 #include <mini/crypto/random.h>
 #include <mini/crypto/base16.h>
@@ -52,9 +53,9 @@ key_agreement_ntor::key_agreement_ntor(
   onion_router* router
   )
   //
-  // generate key-pair.
+  // take a pregenerated key-pair.
   //
-  : key_agreement_ntor(router, crypto::curve25519::private_key::generate())
+  : key_agreement_ntor(router, ntor_key_pool::get_default().take())
 {
 
 }
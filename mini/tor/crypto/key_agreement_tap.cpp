@@ -208,6 +208,15 @@ key_agreement_tap::compute_shared_secret(
   mini_assert(verification_data.get_size() == crypto::sha1::hash_size_in_bytes);
 
   auto shared_secret = _private_key.get_shared_secret(other_public_key);
+
+  //
+  // degenerate g^y.
+  //
+  if (shared_secret.is_empty())
+  {
+    return byte_buffer();
+  }
+
   auto derived = derive_keys(shared_secret);
 
   //
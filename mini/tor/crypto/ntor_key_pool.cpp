@@ -0,0 +1,152 @@
+#include "ntor_key_pool.h"
+
+#include <mini/logger.h>
+
+namespace mini::tor {
+
+ntor_key_pool::ntor_key_pool(
+  size_type capacity,
+  size_type low_watermark
+  )
+  : _capacity(capacity)
+  , _low_watermark(low_watermark)
+  , _refill_event(threading::reset_type::manual_reset, true)
+{
+  _keys.reserve(_capacity);
+}
+
+ntor_key_pool::~ntor_key_pool(
+  void
+  )
+{
+  stop();
+}
+
+void
+ntor_key_pool::start(
+  void
+  )
+{
+  if (_generator_thread)
+  {
+    return;
+  }
+
+  mini_lock(_mutex)
+  {
+    _stop = false;
+    _refill_event.set();
+  }
+
+  _generator_thread = new threading::thread_function([this]() {
+    generator_loop();
+  });
+
+  _generator_thread->start();
+}
+
+void
+ntor_key_pool::stop(
+  void
+  )
+{
+  if (!_generator_thread)
+  {
+    return;
+  }
+
+  mini_lock(_mutex)
+  {
+    _stop = true;
+    _refill_event.set();
+  }
+
+  _generator_thread->join();
+  _generator_thread.reset();
+}
+
+crypto::curve25519::private_key
+ntor_key_pool::take(
+  void
+  )
+{
+  mini_lock(_mutex)
+  {
+    if (!_keys.is_empty())
+    {
+      crypto::curve25519::private_key result = std::move(_keys.top());
+      _keys.pop();
+
+      if (_keys.get_size() < _low_watermark)
+      {
+        _refill_event.set();
+      }
+
+      return result;
+    }
+
+    _refill_event.set();
+  }
+
+  mini_debug("ntor_key_pool::take() [pool is empty, generating in place]");
+
+  return crypto::curve25519::private_key::generate();
+}
+
+ntor_key_pool&
+ntor_key_pool::get_default(
+  void
+  )
+{
+  static ntor_key_pool default_pool;
+  return default_pool;
+}
+
+void
+ntor_key_pool::generator_loop(
+  void
+  )
+{
+  for (;;)
+  {
+    bool is_full = false;
+
+    mini_lock(_mutex)
+    {
+      if (_stop)
+      {
+        break;
+      }
+
+      is_full = _keys.get_size() >= _capacity;
+
+      if (is_full)
+      {
+        //
+        // reset under the lock, so the wake up
+        // from take() isn't lost.
+        //
+        _refill_event.reset();
+      }
+    }
+
+    if (is_full)
+    {
+      _refill_event.wait();
+      continue;
+    }
+
+    //
+    // the key generation (the scalar multiplication)
+    // is done outside of the lock.
+    //
+    auto private_key = crypto::curve25519::private_key::generate();
+
+    mini_lock(_mutex)
+    {
+      _keys.add(std::move(private_key));
+    }
+  }
+}
+
+}
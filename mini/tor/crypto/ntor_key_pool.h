@@ -0,0 +1,81 @@
+#pragma once
+#include <mini/ptr.h>
+#include <mini/collections/list.h>
+#include <mini/crypto/curve25519.h>
+#include <mini/threading/event.h>
+#include <mini/threading/mutex.h>
+#include <mini/threading/thread_function.h>
+
+namespace mini::tor {
+
+//
+// keeps pregenerated ephemeral curve25519 key-pairs
+// for the ntor handshakes, so the scalar multiplication
+// of the key generation isn't done on the thread
+// which builds the circuit.
+//
+// the pool is refilled by a background thread once
+// it drops below the low watermark. every key-pair
+// is handed out exactly once.
+//
+
+class ntor_key_pool
+{
+  MINI_MAKE_NONCOPYABLE(ntor_key_pool);
+
+  public:
+    static constexpr size_type default_capacity = 16;
+    static constexpr size_type default_low_watermark = 8;
+
+    ntor_key_pool(
+      size_type capacity = default_capacity,
+      size_type low_watermark = default_low_watermark
+      );
+
+    ~ntor_key_pool(
+      void
+      );
+
+    void
+    start(
+      void
+      );
+
+    void
+    stop(
+      void
+      );
+
+    //
+    // generates the key-pair in place
+    // if the pool is empty (or not started).
+    //
+    crypto::curve25519::private_key
+    take(
+      void
+      );
+
+    static ntor_key_pool&
+    get_default(
+      void
+      );
+
+  private:
+    void
+    generator_loop(
+      void
+      );
+
+    size_type _capacity;
+    size_type _low_watermark;
+
+    collections::list<crypto::curve25519::private_key> _keys;
+
+    threading::mutex _mutex;
+    threading::event _refill_event;
+    bool _stop = false;
+
+    ptr<threading::thread_function> _generator_thread;
+};
+
+}
@@ -0,0 +1,395 @@
+#include "descriptor_cache.h"
+#include "consensus.h"
+#include "consensus_cache.h"
+
+#include <mini/logger.h>
+#include <mini/io/memory_mapped_file.h>
+
+namespace mini::tor {
+
+//
+// helpers for the size-prefixed fields.
+//
+
+template <
+  typename TSize
+>
+static void
+write_field(
+  byte_buffer& output,
+  const byte_buffer_ref value
+  )
+{
+  const TSize size = static_cast<TSize>(value.get_size());
+
+  output.add_many(byte_buffer_ref(
+    reinterpret_cast<const byte_type*>(&size),
+    reinterpret_cast<const byte_type*>(&size) + sizeof(size)));
+
+  output.add_many(value);
+}
+
+template <
+  typename TSize
+>
+static bool
+read_field(
+  const byte_buffer_ref input,
+  size_type& offset,
+  byte_buffer_ref& value
+  )
+{
+  TSize size;
+
+  if (offset + sizeof(size) > input.get_size())
+  {
+    return false;
+  }
+
+  memory::copy(&size, input.get_buffer() + offset, sizeof(size));
+  offset += sizeof(size);
+
+  if (offset + size > input.get_size())
+  {
+    return false;
+  }
+
+  value = input.slice(offset, offset + size);
+  offset += size;
+
+  return true;
+}
+
+descriptor_cache::~descriptor_cache(
+  void
+  )
+{
+  close();
+}
+
+void
+descriptor_cache::open(
+  consensus& consensus,
+  const string_ref path
+  )
+{
+  close();
+
+  _consensus = &consensus;
+  _path = path;
+
+  size_type live_count = 0;
+  size_type stale_count = 0;
+  byte_buffer live_records;
+
+  {
+    io::memory_mapped_file file;
+
+    if (file.open(path))
+    {
+      const byte_buffer_ref data = file.get_buffer();
+
+      header h = { };
+      if (data.get_size() >= sizeof(h))
+      {
+        memory::copy(&h, data.get_buffer(), sizeof(h));
+      }
+
+      if (h.magic == magic && h.version == version)
+      {
+        size_type offset = sizeof(header);
+
+        while (offset + sizeof(record_header) <= data.get_size())
+        {
+          record_header rh;
+          memory::copy(&rh, data.get_buffer() + offset, sizeof(rh));
+
+          const size_type record_size = sizeof(record_header) + rh.payload_size;
+
+          //
+          // partially written record at the end of the file.
+          //
+          if (offset + record_size > data.get_size())
+          {
+            break;
+          }
+
+          const byte_buffer_ref payload = data.slice(
+            offset + sizeof(record_header),
+            offset + record_size);
+
+          if (consensus_cache::compute_checksum(payload) == rh.checksum &&
+              read_record(consensus, payload))
+          {
+            live_records.add_many(data.slice(offset, offset + record_size));
+            live_count++;
+          }
+          else
+          {
+            stale_count++;
+          }
+
+          offset += record_size;
+        }
+      }
+      else
+      {
+        //
+        // unknown format, start over.
+        //
+        stale_count++;
+      }
+    }
+  }
+
+  mini_debug(
+    "descriptor_cache::open() [live: %u, stale: %u]",
+    static_cast<uint32_t>(live_count),
+    static_cast<uint32_t>(stale_count));
+
+  if (stale_count > 0 && stale_count * compaction_ratio >= live_count + stale_count)
+  {
+    compact(std::move(live_records));
+  }
+  else
+  {
+    _file.open(path, io::file_access::write, io::file_mode::append);
+
+    if (_file.is_open() && _file.get_size() == 0)
+    {
+      const header h = { magic, version };
+      _file.write(&h, sizeof(h));
+    }
+  }
+}
+
+void
+descriptor_cache::close(
+  void
+  )
+{
+  if (_compaction_thread)
+  {
+    _compaction_thread->join();
+    _compaction_thread.reset();
+  }
+
+  _file.close();
+  _pending_records.clear();
+  _consensus = nullptr;
+}
+
+void
+descriptor_cache::append(
+  const onion_router_list& routers
+  )
+{
+  if (!_consensus)
+  {
+    return;
+  }
+
+  byte_buffer records;
+
+  for (auto router : routers)
+  {
+    if (router->is_descriptor_fetched())
+    {
+      write_record(*_consensus, router, records);
+    }
+  }
+
+  if (records.is_empty())
+  {
+    return;
+  }
+
+  mini_lock(_file_mutex)
+  {
+    if (_file.is_open())
+    {
+      _file.write(records);
+    }
+    else
+    {
+      //
+      // the compaction hasn't reopened the file yet.
+      //
+      _pending_records.add_many(records);
+    }
+  }
+}
+
+void
+descriptor_cache::compact(
+  byte_buffer&& live_records
+  )
+{
+  //
+  // the file is rewritten in place. a crash in the middle
+  // leaves a truncated record at the end, which is ignored.
+  //
+  _compaction_thread.reset(new threading::thread_function(
+    [this, live_records = std::move(live_records)]() {
+      mini_lock(_file_mutex)
+      {
+        _file.open(_path, io::file_access::write, io::file_mode::create);
+
+        if (_file.is_open())
+        {
+          const header h = { magic, version };
+          _file.write(&h, sizeof(h));
+          _file.write(live_records);
+          _file.write(_pending_records);
+        }
+
+        _pending_records.clear();
+      }
+
+      mini_debug(
+        "descriptor_cache::compact() [size: %u bytes]",
+        static_cast<uint32_t>(sizeof(header) + live_records.get_size()));
+    }));
+
+  _compaction_thread->start();
+}
+
+byte_buffer_ref
+descriptor_cache::get_digest(
+  const consensus& consensus,
+  const onion_router* router
+  )
+{
+  return consensus.get_flavor() == consensus::flavor::microdesc
+    ? router->get_microdescriptor_digest()
+    : router->get_descriptor_digest();
+}
+
+bool
+descriptor_cache::write_record(
+  const consensus& consensus,
+  onion_router* router,
+  byte_buffer& output
+  )
+{
+  const byte_buffer_ref digest = get_digest(consensus, router);
+
+  if (digest.is_empty())
+  {
+    return false;
+  }
+
+  string family;
+  for (auto&& member : router->get_family())
+  {
+    if (!family.is_empty())
+    {
+      family += " ";
+    }
+
+    family += member;
+  }
+
+  byte_buffer payload;
+  payload.add_many(router->get_identity_fingerprint());
+  write_field<uint8_t>(payload, digest);
+  write_field<uint16_t>(payload, router->get_onion_key());
+  write_field<uint16_t>(payload, router->get_signing_key());
+  write_field<uint16_t>(payload, router->get_ntor_onion_key());
+  write_field<uint16_t>(payload, family);
+  write_field<uint16_t>(payload, router->get_exit_policy());
+
+  const record_header rh = {
+    static_cast<uint32_t>(payload.get_size()),
+    consensus_cache::compute_checksum(payload)
+  };
+
+  output.add_many(byte_buffer_ref(
+    reinterpret_cast<const byte_type*>(&rh),
+    reinterpret_cast<const byte_type*>(&rh) + sizeof(rh)));
+
+  output.add_many(payload);
+
+  return true;
+}
+
+bool
+descriptor_cache::read_record(
+  consensus& consensus,
+  const byte_buffer_ref payload
+  )
+{
+  static constexpr size_type identity_fingerprint_size = 20;
+
+  if (payload.get_size() < identity_fingerprint_size)
+  {
+    return false;
+  }
+
+  onion_router* router = consensus.get_onion_router_by_identity_fingerprint(
+    payload.slice(0, identity_fingerprint_size));
+
+  //
+  // the onion router has left the consensus,
+  // or it has been filled by an earlier record.
+  //
+  if (!router || router->is_descriptor_fetched())
+  {
+    return false;
+  }
+
+  size_type offset = identity_fingerprint_size;
+  byte_buffer_ref digest;
+  byte_buffer_ref onion_key;
+  byte_buffer_ref signing_key;
+  byte_buffer_ref ntor_onion_key;
+  byte_buffer_ref family;
+  byte_buffer_ref exit_policy;
+
+  if (!read_field<uint8_t>(payload, offset, digest) ||
+      !read_field<uint16_t>(payload, offset, onion_key) ||
+      !read_field<uint16_t>(payload, offset, signing_key) ||
+      !read_field<uint16_t>(payload, offset, ntor_onion_key) ||
+      !read_field<uint16_t>(payload, offset, family) ||
+      !read_field<uint16_t>(payload, offset, exit_policy))
+  {
+    return false;
+  }
+
+  //
+  // the onion router has published a new descriptor.
+  //
+  if (!(digest == get_digest(consensus, router)))
+  {
+    return false;
+  }
+
+  router->set_onion_key(onion_key);
+  router->set_signing_key(signing_key);
+  router->set_ntor_onion_key(ntor_onion_key);
+
+  if (!family.is_empty())
+  {
+    const string_ref family_string(
+      reinterpret_cast<const char*>(family.get_buffer()),
+      family.get_size());
+
+    router->set_family(family_string.split(" "));
+  }
+
+  //
+  // the microdesc flavored consensus doesn't carry
+  // the exit policy summary, it comes from the microdescriptor.
+  //
+  if (router->get_exit_policy().is_empty() && !exit_policy.is_empty())
+  {
+    router->set_exit_policy(string_ref(
+      reinterpret_cast<const char*>(exit_policy.get_buffer()),
+      exit_policy.get_size()));
+  }
+
+  router->set_descriptor_fetched(true);
+  return true;
+}
+
+}
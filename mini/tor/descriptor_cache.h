@@ -0,0 +1,135 @@
+#pragma once
+#include "onion_router.h"
+
+#include <mini/ptr.h>
+#include <mini/string.h>
+#include <mini/byte_buffer.h>
+#include <mini/io/file_stream.h>
+#include <mini/threading/mutex.h>
+#include <mini/threading/thread_function.h>
+
+namespace mini::tor {
+
+//
+// persistent cache of the fetched descriptors.
+//
+// layout:
+//   header
+//   record[] (appended as the descriptors are fetched)
+//
+// each record holds the keys of a single onion router and
+// the digest of the descriptor (or the microdescriptor) they
+// were taken from. the record is used only while the digest
+// matches the current consensus, the stale ones are dropped
+// by the compaction running in the background.
+//
+
+class descriptor_cache
+{
+  MINI_MAKE_NONCOPYABLE(descriptor_cache);
+
+  public:
+    static constexpr uint32_t magic   = 0x4344544d; // "MTDC"
+    static constexpr uint32_t version = 2;
+
+    struct header
+    {
+      uint32_t magic;
+      uint32_t version;
+    };
+
+    //
+    // followed by the payload:
+    //   identity_fingerprint[20]
+    //   uint8_t  digest_size,          digest
+    //   uint16_t onion_key_size,       onion_key
+    //   uint16_t signing_key_size,     signing_key
+    //   uint16_t ntor_onion_key_size,  ntor_onion_key
+    //   uint16_t family_size,          family (space separated)
+    //   uint16_t exit_policy_size,     exit_policy (summary, microdesc "p" line)
+    //
+    struct record_header
+    {
+      uint32_t payload_size;
+      uint32_t checksum;
+    };
+
+    //
+    // compact the file when at least
+    // 1/compaction_ratio of the records are stale.
+    //
+    static constexpr size_type compaction_ratio = 4;
+
+    descriptor_cache(
+      void
+      ) = default;
+
+    ~descriptor_cache(
+      void
+      );
+
+    //
+    // fills the onion routers of the consensus
+    // from the matching records and keeps the file
+    // open for appending.
+    //
+    void
+    open(
+      consensus& consensus,
+      const string_ref path
+      );
+
+    void
+    close(
+      void
+      );
+
+    //
+    // appends the fetched onion routers.
+    // may be called from multiple threads.
+    //
+    void
+    append(
+      const onion_router_list& routers
+      );
+
+  private:
+    void
+    compact(
+      byte_buffer&& live_records
+      );
+
+    static byte_buffer_ref
+    get_digest(
+      const consensus& consensus,
+      const onion_router* router
+      );
+
+    static bool
+    write_record(
+      const consensus& consensus,
+      onion_router* router,
+      byte_buffer& output
+      );
+
+    static bool
+    read_record(
+      consensus& consensus,
+      const byte_buffer_ref payload
+      );
+
+    consensus* _consensus = nullptr;
+    string _path;
+
+    io::file_stream _file;
+    threading::mutex _file_mutex;
+
+    //
+    // appended while the compaction is running.
+    //
+    byte_buffer _pending_records;
+
+    ptr<threading::thread_function> _compaction_thread;
+};
+
+}
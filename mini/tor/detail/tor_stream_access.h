@@ -0,0 +1,36 @@
+#pragma once
+#include <mini/tor/tor_stream.h>
+
+namespace mini::tor::detail {
+
+//
+// internal access to the receive path of tor_stream
+// for the tools outside of the library (bench/).
+// the stream is fed the way the circuit feeds it.
+//
+struct tor_stream_access
+{
+  static void
+  append_to_recv_buffer(
+    tor_stream& stream,
+    const byte_buffer_ref buffer
+    )
+  {
+    stream.append_to_recv_buffer(buffer);
+  }
+
+  //
+  // marks the stream as destroyed without sending
+  // RELAY_END, so it can be deleted without a circuit
+  // connected to the onion router.
+  //
+  static void
+  destroy(
+    tor_stream& stream
+    )
+  {
+    stream.set_state(tor_stream::state::destroyed);
+  }
+};
+
+}
@@ -1,4 +1,5 @@
 #include "hidden_service.h"
+#include "circuit_node.h"
 
 #include <mini/algorithm.h>
 #include <mini/logger.h>
@@ -9,8 +10,11 @@
 #include <mini/io/memory_stream.h>
 #include <mini/io/stream_reader.h>
 #include <mini/io/stream_wrapper.h>
+#include <mini/tor/circuit_pool.h>
+#include <mini/tor/hidden_service_cache.h>
 #include <mini/tor/parsers/hidden_service_descriptor_parser.h>
 #include <mini/net/http.h>
+#include <mini/threading/thread_function.h>
 
 namespace mini::tor {
 
@@ -47,41 +51,93 @@ hidden_service::connect(
   void
   )
 {
-  find_responsible_directories();
+  //
+  // create rendezvous cookie.
+  //
+  crypto::random_device.get_random_bytes(_rendezvous_cookie);
+
+  hidden_service_cache& cache = hidden_service_cache::get_default();
+  const uint32_t time_period = get_time_period();
+
+  onion_router_list::size_type responsible_directory_index = onion_router_list::not_found;
+
+  //
+  // the introduction points are known from the recent connect,
+  // skip the directories.
+  //
+  const bool cached = cache.find(_onion, time_period, _consensus, _introduction_point_list);
 
-  if (_responsible_directory_list.is_empty() == false)
+  if (cached)
   {
+    _rendezvous_circuit->rendezvous_establish(_rendezvous_cookie);
+  }
+  else
+  {
+    find_responsible_directories();
+
+    if (_responsible_directory_list.is_empty())
+    {
+      return false;
+    }
+
     //
-    // create rendezvous cookie.
+    // establish rendezvous while the descriptor is being fetched.
     //
-    crypto::random_device.get_random_bytes(_rendezvous_cookie);
+    threading::thread_function rendezvous_thread([this]() {
+      _rendezvous_circuit->rendezvous_establish(_rendezvous_cookie);
+    });
+
+    rendezvous_thread.start();
+
+    responsible_directory_index = fetch_hidden_service_descriptor();
+
+    rendezvous_thread.join();
+  }
+
+  if (!_rendezvous_circuit->is_rendezvous_established())
+  {
+    return false;
+  }
+
+  if (cached)
+  {
+    introduce();
+
+    if (_rendezvous_circuit->is_rendezvous_completed())
+    {
+      return true;
+    }
 
     //
-    // establish rendezvous.
+    // the cached introduction points don't work anymore.
     //
-    _rendezvous_circuit->rendezvous_establish(_rendezvous_cookie);
+    mini_info("\tCached introduction points failed, fetching the descriptor...");
 
-    if (_rendezvous_circuit->is_rendezvous_established())
-    {
-      onion_router_list::size_type responsible_directory_index = 0;
-      while ((responsible_directory_index = fetch_hidden_service_descriptor(responsible_directory_index)) != onion_router_list::not_found)
-      {
-        introduce();
+    cache.remove(_onion);
 
-        if (_rendezvous_circuit->is_rendezvous_completed())
-        {
-          return true;
-        }
-      }
+    find_responsible_directories();
+    responsible_directory_index = fetch_hidden_service_descriptor();
+  }
+
+  while (responsible_directory_index != onion_router_list::not_found)
+  {
+    introduce();
+
+    if (_rendezvous_circuit->is_rendezvous_completed())
+    {
+      cache.insert(_onion, time_period, _publication_time, _introduction_point_list);
+      return true;
     }
+
+    responsible_directory_index = fetch_hidden_service_descriptor(responsible_directory_index);
   }
 
   return false;
 }
 
-byte_buffer
-hidden_service::get_secret_id(
-  replica_type replica
+uint32_t
+hidden_service::get_time_period(
+  void
   )
 {
   byte_type permanent_id_byte = _permanent_id[0];
@@ -97,7 +153,15 @@ hidden_service::get_secret_id(
   //   time-period = (current-time + permanent-id-byte * 86400 / 256)
   //                   / 86400
   //
-  uint32_t time_period = (time::now().to_timestamp() + (permanent_id_byte * 86400 / 256)) / 86400;
+  return (time::now().to_timestamp() + (permanent_id_byte * 86400 / 256)) / 86400;
+}
+
+byte_buffer
+hidden_service::get_secret_id(
+  replica_type replica
+  )
+{
+  uint32_t time_period = get_time_period();
 
   stack_byte_buffer<5> secret_bytes;
   io::memory_stream secret_stream(secret_bytes);
@@ -146,10 +210,12 @@ hidden_service::find_responsible_directories(
 
   _responsible_directory_list.clear();
 
-  auto directory_list = _consensus.get_onion_routers_by_criteria({
-    {}, {}, {},
-    onion_router::status_flag::hsdir
-  });
+  const onion_router_list& directory_ring = _consensus.get_hsdir_ring();
+
+  if (directory_ring.is_empty())
+  {
+    return;
+  }
 
   //
   // search for the 2 sets of 3 hidden service directories.
@@ -158,20 +224,23 @@ hidden_service::find_responsible_directories(
   {
     auto descriptor_id = get_descriptor_id(replica);
 
-    auto directory_list_iterator = algorithm::lower_bound(
-      directory_list.begin(),
-      directory_list.end(),
+    //
+    // the first directory following the descriptor id.
+    //
+    auto directory_ring_iterator = algorithm::upper_bound(
+      directory_ring.begin(),
+      directory_ring.end(),
       descriptor_id,
-      [](onion_router* lhs, const byte_buffer_ref rhs) -> bool {
-        return lhs->get_identity_fingerprint().compare(rhs) < 0;
+      [](const byte_buffer_ref lhs, onion_router* rhs) -> bool {
+        return lhs.compare(rhs->get_identity_fingerprint()) < 0;
       }
     );
 
-    auto index = algorithm::distance(directory_list.begin(), directory_list_iterator) + 1;
+    auto index = algorithm::distance(directory_ring.begin(), directory_ring_iterator);
 
     for (size_type i = 0; i < 3; i++)
     {
-      _responsible_directory_list.add(directory_list[(index + i) % directory_list.get_size()]);
+      _responsible_directory_list.add(directory_ring[(index + i) % directory_ring.get_size()]);
     }
   }
 }
@@ -181,125 +250,254 @@ hidden_service::fetch_hidden_service_descriptor(
   onion_router_list::size_type responsible_directory_index
   )
 {
-  for (
-    onion_router_list::size_type i = responsible_directory_index;
-    i < _responsible_directory_list.get_size();
-    i++
-    )
-  {
-    onion_router* responsible_directory = _responsible_directory_list[i];
+  const size_type responsible_directory_count = _responsible_directory_list.get_size();
 
-    //
-    // create new circuit and extend it with responsible directory.
-    //
-    mini_info(
-      "\tCreating circuit for hidden service (try #%u), connecting to '%s' (%s:%u)",
-      (uint32_t)(i + 1),
-      _socket.get_onion_router()->get_name().get_buffer(),
-      _socket.get_onion_router()->get_ip_address().to_string().get_buffer(),
-      _socket.get_onion_router()->get_or_port());
-    mini_info("\tConnected...");
+  if (responsible_directory_index >= responsible_directory_count)
+  {
+    return onion_router_list::not_found;
+  }
 
-    ptr<circuit> directory_circuit = _socket.create_circuit();
+  //
+  // race the responsible directories.
+  // each thread takes the next untried directory,
+  // the first valid descriptor wins and the fetches
+  // still in flight are cancelled.
+  //
+  mini_lock(_fetch_mutex)
+  {
+    _fetch_next_index = responsible_directory_index;
+    _fetch_completed = false;
+  }
 
-    if (!directory_circuit)
+  auto fetch_loop = [this, responsible_directory_count]() {
+    for (;;)
     {
-      //
-      // either tor socket is destroyed
-      // or we couldn't create circuit with the first
-      // onion router. try it again anyway.
-      // but if the socket is destroyed, we're out of luck.
-      //
-      continue;
+      onion_router_list::size_type index = onion_router_list::not_found;
+
+      mini_lock(_fetch_mutex)
+      {
+        if (!_fetch_completed && _fetch_next_index < responsible_directory_count)
+        {
+          index = _fetch_next_index++;
+        }
+      }
+
+      if (index == onion_router_list::not_found)
+      {
+        break;
+      }
+
+      fetch_hidden_service_descriptor_from(index);
     }
+  };
 
-    mini_info(
-      "\tExtending circuit for hidden service, connecting to responsible directory '%s' (%s:%u)",
-      responsible_directory->get_name().get_buffer(),
-      responsible_directory->get_ip_address().to_string().get_buffer(),
-      responsible_directory->get_or_port());
+  const size_type thread_count = algorithm::min(
+    responsible_directory_count - responsible_directory_index,
+    max_parallel_descriptor_fetch_count);
+
+  if (thread_count == 1)
+  {
+    fetch_loop();
+  }
+  else
+  {
+    collections::list<ptr<threading::thread_function>> thread_list;
+
+    for (size_type i = 0; i < thread_count; i++)
+    {
+      ptr<threading::thread_function> thread(new threading::thread_function(fetch_loop));
 
-    directory_circuit->extend(responsible_directory);
+      thread->start();
+      thread_list.add(std::move(thread));
+    }
 
-    if (!directory_circuit->is_ready())
+    for (auto& thread : thread_list)
     {
-      mini_warning("\tError while extending the directory circuit");
-      continue;
+      thread->join();
     }
+  }
 
+  mini_lock(_fetch_mutex)
+  {
     //
-    // circuit must have exactly 2 nodes now.
+    // the cancelled directories are skipped
+    // if the caller asks again.
     //
-    mini_assert(directory_circuit->get_circuit_node_list_size() == 2);
+    return _fetch_completed
+      ? _fetch_next_index
+      : onion_router_list::not_found;
+  }
+}
 
-    mini_info("\tExtended...");
+bool
+hidden_service::fetch_hidden_service_descriptor_from(
+  onion_router_list::size_type responsible_directory_index
+  )
+{
+  onion_router* responsible_directory = _responsible_directory_list[responsible_directory_index];
 
-    replica_type replica = i >= 3;
+  //
+  // create new circuit and extend it with responsible directory.
+  //
+  mini_info(
+    "\tCreating circuit for hidden service (try #%u), connecting to '%s' (%s:%u)",
+    (uint32_t)(responsible_directory_index + 1),
+    _socket.get_onion_router()->get_name().get_buffer(),
+    _socket.get_onion_router()->get_ip_address().to_string().get_buffer(),
+    _socket.get_onion_router()->get_or_port());
+
+  ptr<circuit> directory_circuit = create_circuit();
 
+  if (!directory_circuit)
+  {
     //
-    // create the directory stream on the directory circuit.
+    // either tor socket is destroyed
+    // or we couldn't create circuit with the first
+    // onion router. try it again anyway.
+    // but if the socket is destroyed, we're out of luck.
     //
-    ptr<tor_stream> directory_stream = directory_circuit->create_dir_stream();
+    return false;
+  }
+
+  mini_info("\tConnected...");
 
-    if (!directory_stream)
+  //
+  // the winning fetch may cancel the circuit from now on,
+  // it is still destroyed by this thread.
+  //
+  mini_lock(_fetch_mutex)
+  {
+    if (_fetch_completed)
     {
-      mini_warning("\tError while establishing the directory stream");
-      continue;
+      return false;
     }
 
-    //
-    // request the hidden service descriptor.
-    //
-    const string descriptor_path = string::format(
-      "/tor/rendezvous2/%s",
-      crypto::base32::encode(get_descriptor_id(replica)).get_buffer());
+    _fetch_circuit_list.add(directory_circuit.get());
+  }
+
+  const string hidden_service_descriptor = download_hidden_service_descriptor(
+    directory_circuit.get(),
+    responsible_directory,
+    responsible_directory_index >= 3);
+
+  mini_lock(_fetch_mutex)
+  {
+    _fetch_circuit_list.remove(directory_circuit.get());
+  }
+
+  //
+  // parse hidden service descriptor.
+  //
+  if (hidden_service_descriptor.is_empty() ||
+      hidden_service_descriptor.contains("404 Not found"))
+  {
+    mini_warning("\tHidden service descriptor is invalid...");
+    return false;
+  }
 
-    mini_debug(
-      "hidden_service::fetch_hidden_service_descriptor() [path: %s]",
-      descriptor_path.get_buffer());
+  mini_info("\tHidden service descriptor is valid...");
 
-    mini_info("\tSending request for hidden service descriptor...");
+  hidden_service_descriptor_parser parser;
+  parser.parse(_consensus, hidden_service_descriptor);
+
+  if (parser.introduction_point_list.is_empty())
+  {
+    mini_warning("\tHidden service descriptor contains no introduction points...");
+    return false;
+  }
 
-    const string hidden_service_descriptor =
-      net::http::client::get(
-        responsible_directory->get_ip_address().to_string(),
-        responsible_directory->get_dir_port(),
-        descriptor_path,
-        *directory_stream);
+  mini_lock(_fetch_mutex)
+  {
+    if (_fetch_completed)
+    {
+      return false;
+    }
 
-    mini_info("\tHidden service descriptor received...");
+    _fetch_completed = true;
+    _introduction_point_list = std::move(parser.introduction_point_list);
+    _publication_time = parser.publication_time;
 
     //
-    // parse hidden service descriptor.
+    // cancel the other fetches, their threads wake up
+    // and delete the circuits.
     //
-    if (!hidden_service_descriptor.is_empty() &&
-        !hidden_service_descriptor.contains("404 Not found"))
+    for (auto fetch_circuit : _fetch_circuit_list)
     {
-      mini_info("\tHidden service descriptor is valid...");
+      fetch_circuit->cancel();
+    }
+  }
 
-      hidden_service_descriptor_parser parser;
-      parser.parse(_consensus, hidden_service_descriptor);
+  return true;
+}
 
-      mini_assert(!parser.introduction_point_list.is_empty());
+string
+hidden_service::download_hidden_service_descriptor(
+  circuit* directory_circuit,
+  onion_router* responsible_directory,
+  replica_type replica
+  )
+{
+  mini_info(
+    "\tExtending circuit for hidden service, connecting to responsible directory '%s' (%s:%u)",
+    responsible_directory->get_name().get_buffer(),
+    responsible_directory->get_ip_address().to_string().get_buffer(),
+    responsible_directory->get_or_port());
 
-      if (!parser.introduction_point_list.is_empty())
-      {
-        _introduction_point_list = std::move(parser.introduction_point_list);
-      }
-      else
-      {
-        mini_warning("\tHidden service descriptor contains no introduction points...");
-      }
+  directory_circuit->extend(responsible_directory);
 
-      return i;
-    }
-    else
-    {
-      mini_warning("\tHidden service descriptor is invalid...");
-    }
+  if (directory_circuit->is_cancelled())
+  {
+    return string();
+  }
+
+  if (!directory_circuit->is_ready())
+  {
+    mini_warning("\tError while extending the directory circuit");
+    return string();
+  }
+
+  //
+  // circuit must have at least 2 nodes now,
+  // the prebuilt internal circuits have more.
+  //
+  mini_assert(directory_circuit->get_circuit_node_list_size() >= 2);
+
+  mini_info("\tExtended...");
+
+  //
+  // create the directory stream on the directory circuit.
+  //
+  ptr<tor_stream> directory_stream = directory_circuit->create_dir_stream();
+
+  if (!directory_stream)
+  {
+    mini_warning("\tError while establishing the directory stream");
+    return string();
   }
 
-  return onion_router_list::not_found;
+  //
+  // request the hidden service descriptor.
+  //
+  const string descriptor_path = string::format(
+    "/tor/rendezvous2/%s",
+    crypto::base32::encode(get_descriptor_id(replica)).get_buffer());
+
+  mini_debug(
+    "hidden_service::download_hidden_service_descriptor() [path: %s]",
+    descriptor_path.get_buffer());
+
+  mini_info("\tSending request for hidden service descriptor...");
+
+  const string hidden_service_descriptor =
+    net::http::client::get(
+      responsible_directory->get_ip_address().to_string(),
+      responsible_directory->get_dir_port(),
+      descriptor_path,
+      *directory_stream);
+
+  mini_info("\tHidden service descriptor received...");
+
+  return hidden_service_descriptor;
 }
 
 void
@@ -307,57 +505,144 @@ hidden_service::introduce(
   void
   )
 {
+  if (_introduction_point_list.is_empty())
+  {
+    return;
+  }
+
+  //
+  // all the introductions carry the same rendezvous handshake,
+  // whichever introduction point reaches the hidden service
+  // first completes the rendezvous.
+  //
+  if (!_rendezvous_circuit->_extend_node)
+  {
+    _rendezvous_circuit->_extend_node = _rendezvous_circuit->create_circuit_node(
+      _introduction_point_list[0],
+      circuit_node_type::introduction_point);
+
+    _rendezvous_circuit->set_state(circuit::state::rendezvous_completing);
+  }
+
+  //
+  // staggered race: each introduction point gets a head start,
+  // the next one is tried if the rendezvous hasn't been completed
+  // in the meantime. the pending introductions are cancelled
+  // by the one which completes the rendezvous.
+  //
+  collections::list<ptr<threading::thread_function>> thread_list;
+
   for (onion_router* introduction_point : _introduction_point_list)
   {
-    mini_info(
-      "\tCreating circuit for hidden service introduce, connecting to '%s' (%s:%u)",
-      _socket.get_onion_router()->get_name().get_buffer(),
-      _socket.get_onion_router()->get_ip_address().to_string().get_buffer(),
-      _socket.get_onion_router()->get_or_port());
+    if (_rendezvous_circuit->is_rendezvous_completed() ||
+        _rendezvous_circuit->is_destroyed())
+    {
+      break;
+    }
+
+    ptr<threading::thread_function> thread(new threading::thread_function([this, introduction_point]() {
+      introduce(introduction_point);
+    }));
 
-    ptr<circuit> introduce_circuit = _socket.create_circuit();
+    thread->start();
+    thread_list.add(std::move(thread));
 
-    if (!introduce_circuit)
+    _rendezvous_circuit->wait_for_state(circuit::state::rendezvous_completed, introduction_head_start);
+  }
+
+  for (auto& thread : thread_list)
+  {
+    thread->join();
+  }
+}
+
+void
+hidden_service::introduce(
+  onion_router* introduction_point
+  )
+{
+  mini_info(
+    "\tCreating circuit for hidden service introduce, connecting to '%s' (%s:%u)",
+    _socket.get_onion_router()->get_name().get_buffer(),
+    _socket.get_onion_router()->get_ip_address().to_string().get_buffer(),
+    _socket.get_onion_router()->get_or_port());
+
+  ptr<circuit> introduce_circuit = create_circuit();
+
+  if (!introduce_circuit)
+  {
+    //
+    // either tor socket is destroyed
+    // or we couldn't create circuit with the first
+    // onion router.
+    //
+    return;
+  }
+
+  mini_info("\tConnected...");
+
+  mini_lock(_introduce_mutex)
+  {
+    if (_rendezvous_circuit->is_rendezvous_completed())
     {
-      //
-      // either tor socket is destroyed
-      // or we couldn't create circuit with the first
-      // onion router. try it again anyway.
-      // but if the socket is destroyed, we're out of luck.
-      //
-      continue;
+      return;
     }
 
-    mini_info("\tConnected...");
+    _introduce_circuit_list.add(introduce_circuit.get());
+  }
 
-    mini_info(
-      "\tExtending circuit to introduction point '%s' (%s:%u)",
-      introduction_point->get_name().get_buffer(),
-      introduction_point->get_ip_address().to_string().get_buffer(),
-      introduction_point->get_or_port());
+  mini_info(
+    "\tExtending circuit to introduction point '%s' (%s:%u)",
+    introduction_point->get_name().get_buffer(),
+    introduction_point->get_ip_address().to_string().get_buffer(),
+    introduction_point->get_or_port());
 
-    introduce_circuit->extend(introduction_point);
+  introduce_circuit->extend(introduction_point);
 
-    if (!introduce_circuit->is_ready())
+  if (introduce_circuit->is_cancelled())
+  {
+    mini_lock(_introduce_mutex)
     {
-      mini_warning("\tError while extending the introduce circuit");
-      continue;
+      _introduce_circuit_list.remove(introduce_circuit.get());
     }
 
+    return;
+  }
+
+  if (introduce_circuit->is_ready())
+  {
     //
-    // circuit must have exactly 2 nodes now.
+    // circuit must have at least 2 nodes now,
+    // the prebuilt internal circuits have more.
     //
-    mini_assert(introduce_circuit->get_circuit_node_list_size() == 2);
+    mini_assert(introduce_circuit->get_circuit_node_list_size() >= 2);
 
     mini_info("\tExtended...");
     mini_info("\tSending introduce...");
 
     introduce_circuit->rendezvous_introduce(_rendezvous_circuit, _rendezvous_cookie);
+  }
+  else
+  {
+    mini_warning("\tError while extending the introduce circuit");
+  }
+
+  mini_lock(_introduce_mutex)
+  {
+    _introduce_circuit_list.remove(introduce_circuit.get());
 
-    if (introduce_circuit->get_state() == circuit::state::rendezvous_introduced)
+    if (_rendezvous_circuit->is_rendezvous_completed())
     {
       mini_info("\tIntroduced successfully...");
-      break;
+
+      //
+      // cancel the introductions still waiting,
+      // their threads wake up and delete the circuits.
+      //
+      for (auto pending_circuit : _introduce_circuit_list)
+      {
+        pending_circuit->cancel();
+      }
     }
     else
     {
@@ -366,4 +651,20 @@ hidden_service::introduce(
   }
 }
 
+circuit*
+hidden_service::create_circuit(
+  void
+  )
+{
+  if (circuit_pool* pool = _socket.get_circuit_pool())
+  {
+    if (circuit* pooled_circuit = pool->get_internal_circuit())
+    {
+      return pooled_circuit;
+    }
+  }
+
+  return _socket.create_circuit();
+}
+
 }
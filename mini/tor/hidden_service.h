@@ -2,6 +2,7 @@
 #include <mini/stack_buffer.h>
 #include <mini/tor/circuit.h>
 #include <mini/tor/consensus.h>
+#include <mini/threading/mutex.h>
 
 namespace mini::tor {
 
@@ -21,6 +22,11 @@ class hidden_service
       );
 
   private:
+    uint32_t
+    get_time_period(
+      void
+      );
+
     byte_buffer
     get_secret_id(
       replica_type replica
@@ -36,16 +42,59 @@ class hidden_service
       void
       );
 
+    //
+    // fetches the descriptor from the responsible directories,
+    // starting at the responsible_directory_index.
+    // returns the index of the first directory which hasn't
+    // been tried, or not_found if no descriptor was fetched.
+    //
     onion_router_list::size_type
     fetch_hidden_service_descriptor(
       onion_router_list::size_type responsible_directory_index = 0
       );
 
+    bool
+    fetch_hidden_service_descriptor_from(
+      onion_router_list::size_type responsible_directory_index
+      );
+
+    string
+    download_hidden_service_descriptor(
+      circuit* directory_circuit,
+      onion_router* responsible_directory,
+      replica_type replica
+      );
+
+    void
+    introduce(
+      void
+      );
+
     void
     introduce(
+      onion_router* introduction_point
+      );
+
+    //
+    // takes the prebuilt internal circuit from the circuit pool,
+    // or creates a new one-hop circuit.
+    //
+    circuit*
+    create_circuit(
       void
       );
 
+    //
+    // how many responsible directories are asked at once.
+    //
+    static constexpr size_type max_parallel_descriptor_fetch_count = 3;
+
+    //
+    // how long an introduction point is given
+    // before the next one is tried as well.
+    //
+    static constexpr timeout_type introduction_head_start = 2000;
+
     circuit* _rendezvous_circuit;
     tor_socket& _socket;
     consensus& _consensus;
@@ -55,8 +104,23 @@ class hidden_service
 
     onion_router_list _responsible_directory_list;
     onion_router_list _introduction_point_list;
+    time _publication_time;
 
     stack_byte_buffer<20> _rendezvous_cookie;
+
+    //
+    // state of the racing descriptor fetch.
+    //
+    threading::mutex _fetch_mutex;
+    onion_router_list::size_type _fetch_next_index = 0;
+    bool _fetch_completed = false;
+    collections::list<circuit*> _fetch_circuit_list;
+
+    //
+    // introduce circuits waiting for the rendezvous.
+    //
+    threading::mutex _introduce_mutex;
+    collections::list<circuit*> _introduce_circuit_list;
 };
 
 }
@@ -0,0 +1,118 @@
+#include "hidden_service_cache.h"
+#include "consensus.h"
+
+#include <mini/logger.h>
+
+namespace mini::tor {
+
+bool
+hidden_service_cache::find(
+  const string_ref onion,
+  uint32_t time_period,
+  consensus& consensus,
+  onion_router_list& introduction_point_list
+  )
+{
+  introduction_point_list.clear();
+
+  mini_lock(_mutex)
+  {
+    auto it = _entry_map.find(onion);
+
+    if (it == _entry_map.end())
+    {
+      return false;
+    }
+
+    if (it->second.time_period != time_period ||
+        it->second.valid_until < time::now())
+    {
+      mini_debug("hidden_service_cache::find() [%s.onion, expired]", onion.get_buffer());
+
+      _entry_map.remove(it);
+      return false;
+    }
+
+    for (auto&& introduction_point : it->second.introduction_point_list)
+    {
+      onion_router* router = consensus.get_onion_router_by_identity_fingerprint(
+        introduction_point.identity_fingerprint);
+
+      //
+      // the introduction point has left the consensus.
+      //
+      if (!router)
+      {
+        continue;
+      }
+
+      router->set_service_key(introduction_point.service_key);
+      introduction_point_list.add(router);
+    }
+
+    mini_debug(
+      "hidden_service_cache::find() [%s.onion, introduction points: %u]",
+      onion.get_buffer(),
+      static_cast<uint32_t>(introduction_point_list.get_size()));
+
+    return !introduction_point_list.is_empty();
+  }
+}
+
+void
+hidden_service_cache::insert(
+  const string_ref onion,
+  uint32_t time_period,
+  time publication_time,
+  const onion_router_list& introduction_point_list
+  )
+{
+  if (publication_time == time())
+  {
+    publication_time = time::now();
+  }
+
+  entry new_entry;
+  new_entry.time_period = time_period;
+  new_entry.valid_until = time(publication_time.to_timestamp() + max_descriptor_age);
+
+  for (auto router : introduction_point_list)
+  {
+    new_entry.introduction_point_list.add({
+      router->get_identity_fingerprint(),
+      router->get_service_key()
+    });
+  }
+
+  mini_lock(_mutex)
+  {
+    _entry_map[onion] = std::move(new_entry);
+  }
+}
+
+void
+hidden_service_cache::remove(
+  const string_ref onion
+  )
+{
+  mini_lock(_mutex)
+  {
+    auto it = _entry_map.find(onion);
+
+    if (it != _entry_map.end())
+    {
+      _entry_map.remove(it);
+    }
+  }
+}
+
+hidden_service_cache&
+hidden_service_cache::get_default(
+  void
+  )
+{
+  static hidden_service_cache default_cache;
+  return default_cache;
+}
+
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include "onion_router.h"
+
+#include <mini/time.h>
+#include <mini/string.h>
+#include <mini/byte_buffer.h>
+#include <mini/collections/list.h>
+#include <mini/collections/hashmap.h>
+#include <mini/threading/mutex.h>
+
+namespace mini::tor {
+
+class consensus;
+
+//
+// introduction points of the recently connected hidden services.
+//
+// the entries are keyed by the onion address and valid only
+// for the time period the descriptor was fetched in and until
+// the descriptor is too old. the introduction points are kept
+// as the identity fingerprints, so the entries survive
+// the consensus reload.
+//
+
+class hidden_service_cache
+{
+  MINI_MAKE_NONCOPYABLE(hidden_service_cache);
+
+  public:
+    //
+    // the directories keep the descriptors
+    // for 24 hours after their publication.
+    //
+    static constexpr time_type max_descriptor_age = 24 * 60 * 60;
+
+    hidden_service_cache(
+      void
+      ) = default;
+
+    //
+    // fills the introduction points (with their service keys)
+    // from the cache. returns false if there is no valid entry.
+    //
+    bool
+    find(
+      const string_ref onion,
+      uint32_t time_period,
+      consensus& consensus,
+      onion_router_list& introduction_point_list
+      );
+
+    void
+    insert(
+      const string_ref onion,
+      uint32_t time_period,
+      time publication_time,
+      const onion_router_list& introduction_point_list
+      );
+
+    void
+    remove(
+      const string_ref onion
+      );
+
+    static hidden_service_cache&
+    get_default(
+      void
+      );
+
+  private:
+    struct introduction_point
+    {
+      byte_buffer identity_fingerprint;
+      byte_buffer service_key;
+    };
+
+    struct entry
+    {
+      uint32_t time_period;
+      time valid_until;
+      collections::list<introduction_point> introduction_point_list;
+    };
+
+    collections::hashmap<string, entry> _entry_map;
+    threading::mutex _mutex;
+};
+
+}
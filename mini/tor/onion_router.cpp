@@ -1,9 +1,31 @@
 #include "onion_router.h"
 #include "consensus.h"
-#include "parsers/onion_router_descriptor_parser.h"
 
 namespace mini::tor {
 
+//
+// parses the leading digits of the value.
+//
+static uint32_t
+port_to_int(
+  const string_ref value
+  )
+{
+  uint32_t result = 0;
+
+  for (auto c : value)
+  {
+    if (c < '0' || c > '9')
+    {
+      break;
+    }
+
+    result = result * 10 + (c - '0');
+  }
+
+  return result;
+}
+
 onion_router::onion_router(
   consensus& consensus,
   const string_ref name,
@@ -19,9 +41,43 @@ onion_router::onion_router(
   , _dir_port(dir_port)
   , _identity_fingerprint(identity_fingerprint)
   , _flags(status_flag::none)
+  , _bandwidth(0)
+  , _exit_policy()
+  , _onion_key()
+  , _signing_key()
+  , _ntor_onion_key()
+  , _family()
+  , _descriptor_digest()
+  , _microdescriptor_digest()
+  , _service_key()
+  , _descriptor_fetched(false)
+{
+
+}
+
+onion_router::onion_router(
+  consensus& consensus,
+  const string_ref name,
+  net::ip_address ip,
+  uint16_t or_port,
+  uint16_t dir_port,
+  const byte_buffer_ref identity_fingerprint
+  )
+  : _consensus(consensus)
+  , _name(name)
+  , _ip(ip)
+  , _or_port(or_port)
+  , _dir_port(dir_port)
+  , _identity_fingerprint(identity_fingerprint)
+  , _flags(status_flag::none)
+  , _bandwidth(0)
+  , _exit_policy()
   , _onion_key()
   , _signing_key()
   , _ntor_onion_key()
+  , _family()
+  , _descriptor_digest()
+  , _microdescriptor_digest()
   , _service_key()
   , _descriptor_fetched(false)
 {
@@ -133,6 +189,93 @@ onion_router::set_flags(
   _flags = flags;
 }
 
+uint32_t
+onion_router::get_bandwidth(
+  void
+  ) const
+{
+  return _bandwidth;
+}
+
+void
+onion_router::set_bandwidth(
+  uint32_t value
+  )
+{
+  _bandwidth = value;
+}
+
+string_ref
+onion_router::get_exit_policy(
+  void
+  ) const
+{
+  return _exit_policy;
+}
+
+void
+onion_router::set_exit_policy(
+  const string_ref value
+  )
+{
+  _exit_policy = value;
+}
+
+bool
+onion_router::allows_exit_port(
+  uint16_t port
+  ) const
+{
+  //
+  // dir-spec.txt
+  // 3.4.1.
+  //
+  // "p" SP ("accept" / "reject") SP PortList NL
+  //
+  const string_ref exit_policy = _exit_policy;
+  const size_type position = exit_policy.index_of(" ");
+
+  if (position == string_ref::not_found)
+  {
+    return false;
+  }
+
+  const bool accept = exit_policy.substring(0, position).equals("accept");
+  const string_ref port_list = exit_policy.substring(position + 1);
+
+  //
+  // PortList = PortOrRange *("," PortOrRange)
+  // PortOrRange = INT "-" INT / INT
+  //
+  size_type previous = 0;
+  while (previous < port_list.get_size())
+  {
+    size_type next = port_list.index_of(",", previous);
+
+    if (next == string_ref::not_found)
+    {
+      next = port_list.get_size();
+    }
+
+    const string_ref port_range = port_list.substring(previous, next - previous);
+    const size_type dash = port_range.index_of("-");
+
+    const uint32_t first = port_to_int(port_range);
+    const uint32_t last = dash == string_ref::not_found
+      ? first
+      : port_to_int(port_range.substring(dash + 1));
+
+    if (port >= first && port <= last)
+    {
+      return accept;
+    }
+
+    previous = next + 1;
+  }
+
+  return !accept;
+}
+
 byte_buffer_ref
 onion_router::get_onion_key(
   void
@@ -196,6 +339,80 @@ onion_router::set_ntor_onion_key(
   _ntor_onion_key = value;
 }
 
+const string_collection&
+onion_router::get_family(
+  void
+  )
+{
+  if (!_descriptor_fetched)
+  {
+    fetch_descriptor();
+  }
+
+  return _family;
+}
+
+void
+onion_router::set_family(
+  const string_collection& value
+  )
+{
+  _family.clear();
+
+  for (auto&& member : value)
+  {
+    _family.add(member);
+  }
+}
+
+byte_buffer_ref
+onion_router::get_descriptor_digest(
+  void
+  ) const
+{
+  return _descriptor_digest;
+}
+
+void
+onion_router::set_descriptor_digest(
+  const byte_buffer_ref value
+  )
+{
+  _descriptor_digest = value;
+}
+
+byte_buffer_ref
+onion_router::get_microdescriptor_digest(
+  void
+  ) const
+{
+  return _microdescriptor_digest;
+}
+
+void
+onion_router::set_microdescriptor_digest(
+  const byte_buffer_ref value
+  )
+{
+  _microdescriptor_digest = value;
+}
+
+bool
+onion_router::is_descriptor_fetched(
+  void
+  ) const
+{
+  return _descriptor_fetched;
+}
+
+void
+onion_router::set_descriptor_fetched(
+  bool value
+  )
+{
+  _descriptor_fetched = value;
+}
+
 byte_buffer_ref
 onion_router::get_service_key(
   void
@@ -217,9 +434,15 @@ onion_router::fetch_descriptor(
   void
   )
 {
-  onion_router_descriptor_parser parser;
-  parser.parse(this, _consensus.get_onion_router_descriptor(_identity_fingerprint));
+  onion_router_list routers;
+  routers.add(this);
+
+  _consensus.prefetch_descriptors(routers);
 
+  //
+  // don't try again, even if the descriptor
+  // couldn't be fetched.
+  //
   _descriptor_fetched = true;
 }
 
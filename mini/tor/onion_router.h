@@ -1,9 +1,13 @@
 #pragma once
 #include <mini/flags.h>
+#include <mini/string.h>
 #include <mini/byte_buffer.h>
+#include <mini/collections/hashset.h>
 #include <mini/net/ip_address.h>
 #include <mini/crypto/sha1.h>
 
+#include <atomic>
+
 namespace mini::tor {
 
 class consensus;
@@ -101,6 +105,15 @@ class onion_router
       const byte_buffer_ref identity_fingerprint
       );
 
+    onion_router(
+      consensus& consensus,
+      const string_ref name,
+      net::ip_address ip,
+      uint16_t or_port,
+      uint16_t dir_port,
+      const byte_buffer_ref identity_fingerprint
+      );
+
     consensus&
     get_consensus(
       void
@@ -166,6 +179,43 @@ class onion_router
       status_flags
       );
 
+    //
+    // bandwidth from the consensus (in kilobytes per second).
+    //
+    uint32_t
+    get_bandwidth(
+      void
+      ) const;
+
+    void
+    set_bandwidth(
+      uint32_t value
+      );
+
+    //
+    // exit policy summary from the consensus,
+    // e.g. "accept 80,443" or "reject 1-65535".
+    //
+    string_ref
+    get_exit_policy(
+      void
+      ) const;
+
+    void
+    set_exit_policy(
+      const string_ref value
+      );
+
+    //
+    // returns true if the exit policy summary allows the port.
+    // the unknown summary (e.g. the microdescriptor
+    // hasn't been fetched yet) doesn't allow any port.
+    //
+    bool
+    allows_exit_port(
+      uint16_t port
+      ) const;
+
     byte_buffer_ref
     get_onion_key(
       void
@@ -196,6 +246,58 @@ class onion_router
       const byte_buffer_ref value
       );
 
+    //
+    // family members declared by the onion router
+    // ("$fingerprint" or nickname).
+    //
+    const string_collection&
+    get_family(
+      void
+      );
+
+    void
+    set_family(
+      const string_collection& value
+      );
+
+    //
+    // sha1 digest of the server descriptor,
+    // set only by the ns flavored consensus.
+    //
+    byte_buffer_ref
+    get_descriptor_digest(
+      void
+      ) const;
+
+    void
+    set_descriptor_digest(
+      const byte_buffer_ref value
+      );
+
+    //
+    // sha256 digest of the microdescriptor,
+    // set only by the microdesc flavored consensus.
+    //
+    byte_buffer_ref
+    get_microdescriptor_digest(
+      void
+      ) const;
+
+    void
+    set_microdescriptor_digest(
+      const byte_buffer_ref value
+      );
+
+    bool
+    is_descriptor_fetched(
+      void
+      ) const;
+
+    void
+    set_descriptor_fetched(
+      bool value
+      );
+
     byte_buffer_ref
     get_service_key(
       void
@@ -221,17 +323,28 @@ class onion_router
 
     byte_buffer _identity_fingerprint; // 20 bytes.
     status_flags _flags;
+    uint32_t _bandwidth;
+    string _exit_policy;
 
     byte_buffer _onion_key;
     byte_buffer _signing_key;
     byte_buffer _ntor_onion_key;
+    string_collection _family;
+
+    byte_buffer _descriptor_digest; // 20 bytes.
+    byte_buffer _microdescriptor_digest; // 32 bytes.
 
     byte_buffer _service_key; // for introduction point
 
-    bool _descriptor_fetched;
+    //
+    // set by the prefetch threads once the keys are filled in,
+    // the keys are read only after it is seen set.
+    //
+    std::atomic<bool> _descriptor_fetched;
 };
 
 using onion_router_list = collections::list<onion_router*>;
+using onion_router_set = collections::hashset<onion_router*>;
 
 DECLARE_FLAGS_OPERATORS(onion_router::status_flags);
 
@@ -6,17 +6,114 @@ constexpr consensus_parser::preamble_control_word_list          consensus_parser
 constexpr consensus_parser::router_status_entry                 consensus_parser::router_status_entry_chars;
 constexpr consensus_parser::router_status_flags_type            consensus_parser::router_status_flags;
 constexpr consensus_parser::directory_footer_control_word_list  consensus_parser::directory_footer_control_words;
+constexpr consensus_parser::bandwidth_weight_list               consensus_parser::bandwidth_weights;
+constexpr string_hash                                           consensus_parser::router_status_entry_w_bandwidth;
+constexpr string_hash                                           consensus_parser::preamble_flavor_microdesc;
+
+//
+// helpers for the tokens, which are not zero-terminated.
+//
+
+static string_hash
+token_hash(
+  const string_ref token
+  )
+{
+  return string_hash(token.get_buffer(), token.get_size());
+}
+
+static int32_t
+token_to_int(
+  const string_ref token
+  )
+{
+  int32_t result = 0;
+  bool negative = false;
+
+  for (auto c : token)
+  {
+    if (c == '-' && !negative && result == 0)
+    {
+      negative = true;
+    }
+    else if (c >= '0' && c <= '9')
+    {
+      result = result * 10 + (c - '0');
+    }
+    else
+    {
+      break;
+    }
+  }
+
+  return negative ? -result : result;
+}
+
+//
+// splits "key=value" token, returns false if there is no '='.
+//
+static bool
+token_split_key_value(
+  const string_ref token,
+  string_ref& key,
+  string_ref& value
+  )
+{
+  const size_type position = token.index_of("=");
+
+  if (position == string_ref::not_found)
+  {
+    return false;
+  }
+
+  key = token.substring(0, position);
+  value = token.substring(position + 1);
+  return true;
+}
+
+//
+// fills the tokens with the space separated parts of the line,
+// returns the number of the tokens.
+//
+static size_type
+split_line(
+  const string_ref line,
+  string_ref (&tokens)[consensus_parser::max_token_count]
+  )
+{
+  size_type token_count = 0;
+  size_type previous = 0;
+
+  while (token_count < consensus_parser::max_token_count)
+  {
+    //
+    // memchr() based search.
+    //
+    const size_type position = line.index_of(" ", previous);
+
+    if (position == string_ref::not_found)
+    {
+      tokens[token_count++] = line.substring(previous);
+      break;
+    }
+
+    tokens[token_count++] = line.substring(previous, position - previous);
+    previous = position + 1;
+  }
+
+  return token_count;
+}
 
 onion_router::status_flags
 consensus_parser::string_to_status_flags(
-  const string_collection& splitted
+  const buffer_ref<string_ref> tokens
   )
 {
   onion_router::status_flags result = onion_router::status_flag::none;
 
-  for (auto&& flag_string : splitted)
+  for (auto&& flag_string : tokens)
   {
-    auto index = router_status_flags.index_of(string_hash(flag_string));
+    auto index = router_status_flags.index_of(token_hash(flag_string));
 
     if (index != router_status_flags_type::not_found)
     {
@@ -29,119 +126,321 @@ consensus_parser::string_to_status_flags(
 }
 
 void
-consensus_parser::parse(
+consensus_parser::parse_bandwidth_weights(
+  const buffer_ref<string_ref> tokens
+  )
+{
+  //
+  // skip the "bandwidth-weights" control word.
+  //
+  for (size_type i = 1; i < tokens.get_size(); i++)
+  {
+    string_ref key;
+    string_ref value;
+
+    if (!token_split_key_value(tokens[i], key, value))
+    {
+      continue;
+    }
+
+    auto index = bandwidth_weights.index_of(token_hash(key));
+
+    if (index != bandwidth_weight_list::not_found)
+    {
+      _consensus->_bandwidth_weights[index] = token_to_int(value);
+    }
+  }
+}
+
+void
+consensus_parser::begin(
   consensus& consensus,
-  const string_ref content,
   bool reject_invalid
   )
 {
-  string_collection lines = static_cast<string>(content).split("\n");
-  document_location current_location = document_location::preamble;
-  onion_router* current_router = nullptr;
+  _consensus = &consensus;
+  _reject_invalid = reject_invalid;
+  _microdesc_flavor = false;
+  _finished = false;
+  _current_location = document_location::preamble;
+  _current_router = nullptr;
+  _incomplete_line.clear();
+}
+
+void
+consensus_parser::parse_chunk(
+  const string_ref chunk
+  )
+{
+  size_type previous = 0;
 
-  for (auto&& line : lines)
+  while (!_finished)
   {
-    auto splitted_line = line.split(" ");
+    const size_type position = chunk.index_of("\n", previous);
 
-    //
-    // move the location if we are at the router status entries.
-    //
-    if (splitted_line[0].get_size() == 1 && splitted_line[0][0] == router_status_entry_chars[router_status_entry_r])
+    if (position == string_ref::not_found)
     {
-      current_location = document_location::router_status_entry;
+      //
+      // keep the rest for the next chunk.
+      //
+      _incomplete_line.append(chunk.substring(previous));
+      break;
     }
-    else if (splitted_line[0] == directory_footer_control_words[directory_footer])
+
+    const string_ref line = chunk.substring(previous, position - previous);
+    previous = position + 1;
+
+    if (_incomplete_line.is_empty())
     {
-      current_location = document_location::directory_footer;
+      _finished = !parse_line(line);
     }
-
-    switch (current_location)
+    else
     {
-      case document_location::preamble:
+      _incomplete_line.append(line);
+      _finished = !parse_line(_incomplete_line);
+      _incomplete_line.clear();
+    }
+  }
+}
+
+void
+consensus_parser::end(
+  void
+  )
+{
+  //
+  // the last line doesn't have to end with a newline.
+  //
+  if (!_finished && !_incomplete_line.is_empty())
+  {
+    parse_line(_incomplete_line);
+  }
+
+  _incomplete_line.clear();
+  _finished = true;
+}
+
+void
+consensus_parser::parse(
+  consensus& consensus,
+  const string_ref content,
+  bool reject_invalid
+  )
+{
+  begin(consensus, reject_invalid);
+  parse_chunk(content);
+  end();
+}
+
+bool
+consensus_parser::parse_line(
+  const string_ref line
+  )
+{
+  string_ref splitted_line[max_token_count];
+  const size_type token_count = split_line(line, splitted_line);
+  const string_hash control_word = token_hash(splitted_line[0]);
+
+  //
+  // move the location if we are at the router status entries.
+  //
+  if (splitted_line[0].get_size() == 1 && splitted_line[0][0] == router_status_entry_chars[router_status_entry_r])
+  {
+    _current_location = document_location::router_status_entry;
+  }
+  else if (control_word == directory_footer_control_words[directory_footer])
+  {
+    _current_location = document_location::directory_footer;
+  }
+
+  switch (_current_location)
+  {
+    case document_location::preamble:
+      {
+        if (control_word == preamble_control_words[preamble_type::preamble_network_status_version])
         {
-          if (splitted_line[0] == preamble_control_words[preamble_type::preamble_valid_until])
-          {
-            consensus._valid_until.parse(splitted_line[1] + " " + splitted_line[2]);
+          _microdesc_flavor =
+            token_count >= 3 &&
+            token_hash(splitted_line[2]) == preamble_flavor_microdesc;
 
-            if (reject_invalid && consensus._valid_until < time::now())
-            {
-              return;
-            }
-          }
+          _consensus->_flavor = _microdesc_flavor
+            ? consensus::flavor::microdesc
+            : consensus::flavor::ns;
         }
-        break;
-
-      case document_location::router_status_entry:
+        else if (control_word == preamble_control_words[preamble_type::preamble_valid_until] && token_count >= 3)
         {
           //
-          // we currently support only single letter status entries.
-          // check if the control word has exactly one letter.
+          // date and time, up to the end of the line.
           //
-          if (splitted_line[0].get_size() != 1)
+          char valid_until[32] = { 0 };
+          const string_ref valid_until_ref(splitted_line[1].get_buffer(), line.end());
+
+          memory::copy(
+            valid_until,
+            valid_until_ref.get_buffer(),
+            algorithm::min(valid_until_ref.get_size(), sizeof(valid_until) - 1));
+
+          _consensus->_valid_until.parse(valid_until);
+
+          if (_reject_invalid && _consensus->_valid_until < time::now())
           {
-            break;
+            return false;
           }
+        }
+      }
+      break;
 
-          switch (splitted_line[0][0])
-          {
-            case router_status_entry_chars[router_status_entry_r]:
+    case document_location::router_status_entry:
+      {
+        //
+        // we currently support only single letter status entries.
+        // check if the control word has exactly one letter.
+        //
+        if (splitted_line[0].get_size() != 1)
+        {
+          break;
+        }
+
+        switch (splitted_line[0][0])
+        {
+          case router_status_entry_chars[router_status_entry_r]:
+            {
+              //
+              // router.
+              //
+              const size_type shift = _microdesc_flavor
+                ? router_status_entry_r_microdesc_shift
+                : 0;
+
+              if (token_count < router_status_entry_r_item_count - shift)
               {
                 //
-                // router.
+                // next line.
                 //
-                if (splitted_line.get_size() < router_status_entry_r_item_count)
-                {
-                  //
-                  // next line.
-                  //
-                  continue;
-                }
+                _current_router = nullptr;
+                break;
+              }
+
+              auto identity_fingerprint = crypto::base64::decode(splitted_line[router_status_entry_r_identity]);
+
+              const string_ref ip_token = splitted_line[router_status_entry_r_ip - shift];
 
-                auto identity_fingerprint = crypto::base64::decode(splitted_line[router_status_entry_r_identity]);
+              //
+              // the ip address is expected to be zero-terminated.
+              //
+              char ip[16] = { 0 };
+              memory::copy(
+                ip,
+                ip_token.get_buffer(),
+                algorithm::min(ip_token.get_size(), sizeof(ip) - 1));
 
-                current_router = new onion_router(
-                  consensus,
-                  splitted_line[router_status_entry_r_nickname],
-                  splitted_line[router_status_entry_r_ip],
-                  static_cast<uint16_t>(splitted_line[router_status_entry_r_or_port].to_int()),
-                  static_cast<uint16_t>(splitted_line[router_status_entry_r_dir_port].to_int()),
-                  identity_fingerprint);
+              _current_router = new onion_router(
+                *_consensus,
+                splitted_line[router_status_entry_r_nickname],
+                ip,
+                static_cast<uint16_t>(token_to_int(splitted_line[router_status_entry_r_or_port - shift])),
+                static_cast<uint16_t>(token_to_int(splitted_line[router_status_entry_r_dir_port - shift])),
+                identity_fingerprint);
 
-                consensus._onion_router_map.insert(identity_fingerprint, current_router);
+              if (!_microdesc_flavor)
+              {
+                _current_router->set_descriptor_digest(
+                  crypto::base64::decode(splitted_line[router_status_entry_r_digest]));
               }
-              break;
 
-            case router_status_entry_chars[router_status_entry_s]:
+              _consensus->_onion_router_map.insert(_current_router->get_identity_fingerprint(), _current_router);
+
+              //
+              // nicknames aren't unique, keep the first one.
+              //
+              if (!_consensus->_onion_router_name_map.contains(_current_router->get_name()))
               {
-                //
-                // flags.
-                //
-                if (current_router != nullptr)
+                _consensus->_onion_router_name_map.insert(_current_router->get_name(), _current_router);
+              }
+            }
+            break;
+
+          case router_status_entry_chars[router_status_entry_s]:
+            {
+              //
+              // flags.
+              //
+              if (_current_router != nullptr)
+              {
+                _current_router->set_flags(string_to_status_flags(
+                  buffer_ref<string_ref>(splitted_line, splitted_line + token_count)));
+              }
+            }
+            break;
+
+          case router_status_entry_chars[router_status_entry_m]:
+            {
+              //
+              // microdescriptor digest.
+              //
+              if (_current_router != nullptr && _microdesc_flavor && token_count >= 2)
+              {
+                _current_router->set_microdescriptor_digest(
+                  crypto::base64::decode(splitted_line[1]));
+              }
+            }
+            break;
+
+          case router_status_entry_chars[router_status_entry_p]:
+            {
+              //
+              // exit policy summary.
+              //
+              if (_current_router != nullptr && token_count >= 3)
+              {
+                _current_router->set_exit_policy(string_ref(splitted_line[1].get_buffer(), line.end()));
+              }
+            }
+            break;
+
+          case router_status_entry_chars[router_status_entry_w]:
+            {
+              //
+              // bandwidth.
+              //
+              if (_current_router != nullptr)
+              {
+                for (size_type i = 1; i < token_count; i++)
                 {
-                  current_router->set_flags(string_to_status_flags(line.split(" ")));
+                  string_ref key;
+                  string_ref value;
+
+                  if (token_split_key_value(splitted_line[i], key, value) &&
+                      token_hash(key) == router_status_entry_w_bandwidth)
+                  {
+                    _current_router->set_bandwidth(static_cast<uint32_t>(token_to_int(value)));
+                  }
                 }
               }
-              break;
-          }
+            }
+            break;
         }
-        break;
+      }
+      break;
 
-      case document_location::directory_footer:
-        //
-        // ignore directory footer.
-        //
-        goto consensus_parsed;
-
-      //
-    } // switch (current_location)
-      //
-
-    //
-  } // for (auto&& line : consensus_lines)
-    //
+    case document_location::directory_footer:
+      {
+        if (control_word == directory_footer_control_words[directory_footer_bandwidth_weights])
+        {
+          parse_bandwidth_weights(buffer_ref<string_ref>(splitted_line, splitted_line + token_count));
+        }
+        else if (control_word == directory_footer_control_words[directory_footer_directory_signature])
+        {
+          //
+          // ignore the signatures.
+          //
+          return false;
+        }
+      }
+      break;
+  }
 
-consensus_parsed:
-  ;
+  return true;
 }
 
 }
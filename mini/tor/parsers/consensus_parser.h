@@ -31,14 +31,21 @@ struct consensus_parser
   //
   enum preamble_type
   {
+    preamble_network_status_version,
     preamble_valid_until,
   };
 
-  using preamble_control_word_list = stack_buffer<string_hash, 1>;
+  using preamble_control_word_list = stack_buffer<string_hash, 2>;
   static constexpr preamble_control_word_list preamble_control_words = { {
+    "network-status-version",
     "valid-until",
   } };
 
+  //
+  // "network-status-version" SP version [SP flavor] NL
+  //
+  static constexpr string_hash preamble_flavor_microdesc = "microdesc";
+
   //
   // router status entry.
   //
@@ -50,6 +57,7 @@ struct consensus_parser
     router_status_entry_v,
     router_status_entry_w,
     router_status_entry_p,
+    router_status_entry_m,
   };
 
   using router_status_entry = stack_buffer<char, 7>;
@@ -60,6 +68,7 @@ struct consensus_parser
     'v',
     'w',
     'p',
+    'm',
   } };
 
   enum router_status_entry_r_type
@@ -84,6 +93,15 @@ struct consensus_parser
     router_status_entry_r_item_count,
   };
 
+  //
+  // dir-spec.txt
+  // 3.9.2.
+  //
+  // the microdesc flavored "r" line omits the digest,
+  // the following items are shifted by one.
+  //
+  static constexpr size_type router_status_entry_r_microdesc_shift = 1;
+
   enum router_status_entry_s_type
   {
     router_status_entry_s_none            = 0x0000,
@@ -119,26 +137,79 @@ struct consensus_parser
     "V2Dir",
   } };
 
+  //
+  // "w" SP "Bandwidth=" INT [SP "Measured=" INT] [SP "Unmeasured=1"] NL
+  //
+  static constexpr string_hash router_status_entry_w_bandwidth = "Bandwidth";
+
   //
   // directory footer.
   //
   enum directory_footer_type
   {
     directory_footer,
+    directory_footer_bandwidth_weights,
+    directory_footer_directory_signature,
   };
 
-  using directory_footer_control_word_list = stack_buffer<string_hash, 1>;
+  using directory_footer_control_word_list = stack_buffer<string_hash, 3>;
   static constexpr directory_footer_control_word_list directory_footer_control_words = { {
     "directory-footer",
+    "bandwidth-weights",
+    "directory-signature",
+  } };
+
+  //
+  // in the order of consensus::bandwidth_weight.
+  //
+  using bandwidth_weight_list = stack_buffer<string_hash, consensus::bandwidth_weight_count>;
+  static constexpr bandwidth_weight_list bandwidth_weights = { {
+    "Wbd", "Wbe", "Wbg", "Wbm",
+    "Wdb",
+    "Web", "Wed", "Wee", "Weg", "Wem",
+    "Wgb", "Wgd", "Wgg", "Wgm",
+    "Wmb", "Wmd", "Wme", "Wmg", "Wmm",
   } };
 
   //
   // implementation.
   //
 
+  //
+  // maximum number of space separated tokens
+  // taken from a single line, the rest is ignored.
+  //
+  static constexpr size_type max_token_count = 32;
+
   onion_router::status_flags
   string_to_status_flags(
-    const string_collection& splitted
+    const buffer_ref<string_ref> tokens
+    );
+
+  void
+  parse_bandwidth_weights(
+    const buffer_ref<string_ref> tokens
+    );
+
+  //
+  // the document may be passed in arbitrary chunks,
+  // e.g. as they are received:
+  //   begin() -> parse_chunk() ... -> end()
+  //
+  void
+  begin(
+    consensus& consensus,
+    bool reject_invalid = true
+    );
+
+  void
+  parse_chunk(
+    const string_ref chunk
+    );
+
+  void
+  end(
+    void
     );
 
   void
@@ -147,6 +218,27 @@ struct consensus_parser
     const string_ref content,
     bool reject_invalid = true
     );
+
+  //
+  // returns false when the rest
+  // of the document should be ignored.
+  //
+  bool
+  parse_line(
+    const string_ref line
+    );
+
+  consensus* _consensus = nullptr;
+  bool _reject_invalid = true;
+  bool _microdesc_flavor = false;
+  bool _finished = false;
+  document_location _current_location = document_location::preamble;
+  onion_router* _current_router = nullptr;
+
+  //
+  // incomplete line from the end of the previous chunk.
+  //
+  string _incomplete_line;
 };
 
 }
@@ -16,10 +16,21 @@ hidden_service_descriptor_parser::parse(
 
   for (auto&& line : lines)
   {
+    //
+    // publication-time YYYY-MM-DD HH:MM:SS
+    //
+    const size_type separator = line.index_of(" ");
+
+    if (separator != string::not_found &&
+        string_hash(line.get_buffer(), separator) == control_words[control_word_publication_time])
+    {
+      publication_time.parse(line.substring(separator + 1));
+      continue;
+    }
     //
     // introduction-points
     //
-    if (line == control_words[control_word_introduction_points])
+    else if (line == control_words[control_word_introduction_points])
     {
       current_location = document_location::introduction_points;
       continue;
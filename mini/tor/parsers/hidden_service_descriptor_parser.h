@@ -1,4 +1,5 @@
 #pragma once
+#include <mini/time.h>
 #include <mini/string.h>
 #include <mini/string_hash.h>
 #include <mini/stack_buffer.h>
@@ -14,6 +15,7 @@ namespace mini::tor {
 struct hidden_service_descriptor_parser
 {
   onion_router_list introduction_point_list;
+  time publication_time;
 
   enum class document_location
   {
@@ -25,14 +27,16 @@ struct hidden_service_descriptor_parser
 
   enum control_word_type
   {
+    control_word_publication_time,
     control_word_introduction_points,
 
     control_word_message_begin,
     control_word_message_end,
   };
 
-  using control_word_list = stack_buffer<string_hash, 3>;
+  using control_word_list = stack_buffer<string_hash, 4>;
   static constexpr control_word_list control_words = { {
+    "publication-time",
     "introduction-points",
     "-----BEGIN MESSAGE-----",
     "-----END MESSAGE-----",
@@ -0,0 +1,195 @@
+#include "microdescriptor_parser.h"
+
+#include <mini/crypto/base64.h>
+#include <mini/crypto/sha256.h>
+
+namespace mini::tor {
+
+constexpr microdescriptor_parser::control_word_list microdescriptor_parser::control_words;
+
+//
+// returns the part of the line up to the first space.
+//
+static string_ref
+first_token(
+  const string_ref line
+  )
+{
+  const size_type position = line.index_of(" ");
+
+  return position == string_ref::not_found
+    ? line
+    : line.substring(0, position);
+}
+
+static string_hash
+token_hash(
+  const string_ref token
+  )
+{
+  return string_hash(token.get_buffer(), token.get_size());
+}
+
+size_type
+microdescriptor_parser::parse(
+  const onion_router_list& routers,
+  const string_ref content
+  )
+{
+  onion_router_digest_map router_map;
+  router_map.reserve(routers.get_size());
+
+  for (auto router : routers)
+  {
+    if (router->get_microdescriptor_digest().get_size() == crypto::sha256::hash_size_in_bytes)
+    {
+      router_map.insert(router->get_microdescriptor_digest(), router);
+    }
+  }
+
+  size_type result = 0;
+  size_type microdescriptor_begin = 0;
+  size_type position = 0;
+  bool has_ntor_onion_key = false;
+
+  while (position < content.get_size())
+  {
+    size_type line_end = content.index_of("\n", position);
+
+    if (line_end == string_ref::not_found)
+    {
+      line_end = content.get_size();
+    }
+
+    const string_hash control_word = token_hash(first_token(
+      content.substring(position, line_end - position)));
+
+    //
+    // split the content at the start of the next microdescriptor.
+    //
+    const bool next_microdescriptor =
+      control_word == control_words[control_word_onion_key] ||
+      (control_word == control_words[control_word_ntor_onion_key] && has_ntor_onion_key);
+
+    if (next_microdescriptor && position != microdescriptor_begin)
+    {
+      if (parse_microdescriptor(router_map, content.substring(microdescriptor_begin, position - microdescriptor_begin)))
+      {
+        result++;
+      }
+
+      microdescriptor_begin = position;
+      has_ntor_onion_key = false;
+    }
+
+    if (control_word == control_words[control_word_ntor_onion_key])
+    {
+      has_ntor_onion_key = true;
+    }
+
+    position = line_end + 1;
+  }
+
+  if (microdescriptor_begin < content.get_size())
+  {
+    if (parse_microdescriptor(router_map, content.substring(microdescriptor_begin)))
+    {
+      result++;
+    }
+  }
+
+  return result;
+}
+
+bool
+microdescriptor_parser::parse_microdescriptor(
+  const onion_router_digest_map& router_map,
+  const string_ref microdescriptor
+  )
+{
+  const byte_buffer digest = crypto::sha256::compute(microdescriptor);
+  auto it = router_map.find(digest);
+
+  if (it == router_map.end())
+  {
+    return false;
+  }
+
+  onion_router* router = it->second;
+  document_location current_location = document_location::control_word;
+  string current_key;
+
+  for (auto&& line : microdescriptor.split("\n"))
+  {
+    const string_collection splitted_line = line.split(" ");
+    const string_hash control_word_hash = splitted_line[0];
+    const string_hash line_hash = line;
+
+    //
+    // onion-key
+    //
+    if (line_hash == control_words[control_word_onion_key])
+    {
+      current_location = document_location::onion_key;
+    }
+    //
+    // -----BEGIN RSA PUBLIC KEY-----
+    //
+    else if (line_hash == control_words[control_word_key_begin])
+    {
+      if (current_location == document_location::onion_key)
+      {
+        current_location = document_location::onion_key_content;
+      }
+    }
+    //
+    // -----END RSA PUBLIC KEY-----
+    //
+    else if (line_hash == control_words[control_word_key_end])
+    {
+      if (current_location == document_location::onion_key_content)
+      {
+        router->set_onion_key(crypto::base64::decode(current_key));
+      }
+
+      current_location = document_location::control_word;
+      current_key.clear();
+    }
+    else if (current_location == document_location::onion_key_content)
+    {
+      current_key += line;
+    }
+    else if (control_word_hash == control_words[control_word_ntor_onion_key] && splitted_line.get_size() >= 2)
+    {
+      router->set_ntor_onion_key(crypto::base64::decode(splitted_line[1]));
+    }
+    else if (control_word_hash == control_words[control_word_family])
+    {
+      string_collection family;
+      for (size_type i = 1; i < splitted_line.get_size(); i++)
+      {
+        family.add(splitted_line[i]);
+      }
+
+      router->set_family(family);
+    }
+    //
+    // dir-spec.txt
+    // 3.3.
+    //
+    // "p" SP ("accept" / "reject") SP PortList NL
+    //
+    else if (control_word_hash == control_words[control_word_exit_policy] && splitted_line.get_size() >= 3)
+    {
+      //
+      // everything behind the "p ".
+      //
+      router->set_exit_policy(string_ref(line).substring(2));
+    }
+  }
+
+  router->set_descriptor_fetched(true);
+  return true;
+}
+
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <mini/string.h>
+#include <mini/string_hash.h>
+#include <mini/stack_buffer.h>
+#include <mini/collections/hashmap.h>
+#include <mini/tor/onion_router.h>
+
+namespace mini::tor {
+
+//
+// dir-spec.txt
+// 3.3.
+//
+// the microdescriptors are served concatenated,
+// each one starts with the "onion-key" line
+// (or with the "ntor-onion-key" line when the onion key is omitted).
+// the digest of the microdescriptor is the sha256 of its text.
+//
+
+struct microdescriptor_parser
+{
+  enum class document_location
+  {
+    control_word,
+
+    onion_key,
+    onion_key_content,
+  };
+
+  enum control_word_type
+  {
+    control_word_onion_key,
+
+    control_word_key_begin,
+    control_word_key_end,
+
+    control_word_ntor_onion_key,
+    control_word_family,
+    control_word_exit_policy,
+  };
+
+  using control_word_list = stack_buffer<string_hash, 6>;
+  static constexpr control_word_list control_words = { {
+    "onion-key",
+    "-----BEGIN RSA PUBLIC KEY-----",
+    "-----END RSA PUBLIC KEY-----",
+    "ntor-onion-key",
+    "family",
+    "p",
+  } };
+
+  using onion_router_digest_map = collections::hashmap<byte_buffer_ref, onion_router*>;
+
+  //
+  // fills the onion routers, whose microdescriptor digest
+  // matches one of the microdescriptors in the content.
+  // returns the number of the filled onion routers.
+  //
+  size_type
+  parse(
+    const onion_router_list& routers,
+    const string_ref content
+    );
+
+  bool
+  parse_microdescriptor(
+    const onion_router_digest_map& router_map,
+    const string_ref microdescriptor
+    );
+};
+
+}
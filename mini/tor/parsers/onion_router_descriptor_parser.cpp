@@ -1,5 +1,6 @@
 #include "onion_router_descriptor_parser.h"
 
+#include <mini/crypto/base16.h>
 #include <mini/crypto/base64.h>
 
 namespace mini::tor {
@@ -77,7 +78,126 @@ onion_router_descriptor_parser::parse(
     {
       router->set_ntor_onion_key(crypto::base64::decode(splitted_line[1]));
     }
+    else if (control_word_hash == control_words[control_word_family])
+    {
+      string_collection family;
+      for (size_type i = 1; i < splitted_line.get_size(); i++)
+      {
+        family.add(splitted_line[i]);
+      }
+
+      router->set_family(family);
+    }
+  }
+}
+
+size_type
+onion_router_descriptor_parser::parse(
+  const onion_router_list& routers,
+  const string_ref content
+  )
+{
+  onion_router_fingerprint_map router_map;
+  router_map.reserve(routers.get_size());
+
+  for (auto router : routers)
+  {
+    router_map.insert(router->get_identity_fingerprint(), router);
+  }
+
+  size_type result = 0;
+  size_type descriptor_begin = 0;
+  size_type position = 0;
+
+  while (position < content.get_size())
+  {
+    size_type line_end = content.index_of("\n", position);
+
+    if (line_end == string_ref::not_found)
+    {
+      line_end = content.get_size();
+    }
+
+    const string_ref line = content.substring(position, line_end - position);
+    const size_type control_word_end = line.index_of(" ");
+
+    //
+    // split the content at the start of the next descriptor.
+    //
+    const bool next_descriptor =
+      control_word_end != string_ref::not_found &&
+      string_hash(line.get_buffer(), control_word_end) == control_words[control_word_router];
+
+    if (next_descriptor && position != descriptor_begin)
+    {
+      if (parse_descriptor(router_map, content.substring(descriptor_begin, position - descriptor_begin)))
+      {
+        result++;
+      }
+
+      descriptor_begin = position;
+    }
+
+    position = line_end + 1;
   }
+
+  if (descriptor_begin < content.get_size())
+  {
+    if (parse_descriptor(router_map, content.substring(descriptor_begin)))
+    {
+      result++;
+    }
+  }
+
+  return result;
+}
+
+bool
+onion_router_descriptor_parser::parse_descriptor(
+  const onion_router_fingerprint_map& router_map,
+  const string_ref descriptor
+  )
+{
+  auto it = router_map.find(parse_fingerprint(descriptor));
+
+  if (it == router_map.end())
+  {
+    return false;
+  }
+
+  parse(it->second, descriptor);
+  it->second->set_descriptor_fetched(true);
+  return true;
+}
+
+byte_buffer
+onion_router_descriptor_parser::parse_fingerprint(
+  const string_ref descriptor
+  )
+{
+  //
+  // "fingerprint" fingerprint NL
+  //
+  // the fingerprint is the hex encoded hash of the identity key,
+  // with a single space after every 4 characters.
+  //
+  for (auto&& line : descriptor.split("\n"))
+  {
+    string_collection splitted_line = line.split(" ");
+
+    if (string_hash(splitted_line[0]) == control_words[control_word_fingerprint])
+    {
+      string fingerprint;
+      for (size_type i = 1; i < splitted_line.get_size(); i++)
+      {
+        fingerprint += splitted_line[i];
+      }
+
+      return crypto::base16::decode(fingerprint);
+    }
+  }
+
+  return byte_buffer();
 }
 
 }
@@ -2,6 +2,7 @@
 #include <mini/string.h>
 #include <mini/string_hash.h>
 #include <mini/stack_buffer.h>
+#include <mini/collections/hashmap.h>
 #include <mini/tor/onion_router.h>
 
 namespace mini::tor {
@@ -30,22 +31,54 @@ struct onion_router_descriptor_parser
     control_word_key_end,
 
     control_word_ntor_onion_key,
+    control_word_family,
+
+    control_word_router,
+    control_word_fingerprint,
   };
 
-  using control_word_list = stack_buffer<string_hash, 5>;
+  using control_word_list = stack_buffer<string_hash, 8>;
   static constexpr control_word_list control_words = { {
     "onion-key",
     "signing-key",
     "-----BEGIN RSA PUBLIC KEY-----",
     "-----END RSA PUBLIC KEY-----",
     "ntor-onion-key",
+    "family",
+    "router",
+    "fingerprint",
     } };
 
+  using onion_router_fingerprint_map = collections::hashmap<byte_buffer_ref, onion_router*>;
+
   void
   parse(
     onion_router* router,
     const string_ref descriptor
     );
+
+  //
+  // parses the concatenated descriptors (each one starts
+  // with the "router" line) and fills the onion routers,
+  // whose identity fingerprint matches.
+  // returns the number of the filled onion routers.
+  //
+  size_type
+  parse(
+    const onion_router_list& routers,
+    const string_ref content
+    );
+
+  bool
+  parse_descriptor(
+    const onion_router_fingerprint_map& router_map,
+    const string_ref descriptor
+    );
+
+  static byte_buffer
+  parse_fingerprint(
+    const string_ref descriptor
+    );
 };
 
 }
@@ -2,6 +2,7 @@
 #include "circuit_node.h"
 #include "circuit.h"
 
+#include <mini/algorithm.h>
 #include <mini/io/memory_stream.h>
 #include <mini/io/stream_wrapper.h>
 
@@ -26,12 +27,16 @@ relay_cell::relay_cell(
   MINI_UNREFERENCED(recognized);
   MINI_UNREFERENCED(digest);
 
-  byte_buffer payload(payload_length);
-  payload_buffer.read(payload);
+  //
+  // the data are copied straight from the cell payload.
+  //
+  const size_type payload_offset = payload_stream.get_position();
 
   _relay_command = relay_command;
   _stream_id = stream_id;
-  this->set_relay_payload(payload);
+  this->set_relay_payload(c.get_payload().slice(
+    payload_offset,
+    payload_offset + algorithm::min(static_cast<size_type>(payload_length), payload_data_size)));
 }
 
 relay_cell::relay_cell(
@@ -87,7 +92,9 @@ relay_cell::get_relay_payload(
   void
   ) const
 {
-  return _relay_payload;
+  return byte_buffer_ref(
+    _relay_payload.get_buffer(),
+    _relay_payload.get_buffer() + _relay_payload_size);
 }
 
 void
@@ -95,7 +102,10 @@ relay_cell::set_relay_payload(
   const byte_buffer_ref payload
   )
 {
-  _relay_payload = payload;
+  mini_assert(payload.get_size() <= payload_data_size);
+
+  _relay_payload_size = algorithm::min(payload.get_size(), payload_data_size);
+  memory::copy(_relay_payload.get_buffer(), payload.get_buffer(), _relay_payload_size);
 }
 
 circuit_node*
@@ -115,7 +115,8 @@ class relay_cell
     cell_command _relay_command = (cell_command)0;
     tor_stream_id_type _stream_id = 0;
     stack_byte_buffer<4> _digest;
-    byte_buffer _relay_payload;
+    stack_byte_buffer<payload_data_size> _relay_payload;
+    size_type _relay_payload_size = 0;
 };
 
 }
@@ -7,10 +7,13 @@
 
 namespace mini::tor {
 
+thread_local circuit* tor_socket::_current_circuit = nullptr;
+
 tor_socket::tor_socket(
   onion_router* onion_router
   )
   : _onion_router(onion_router)
+  , _dispatch_done_event(threading::reset_type::manual_reset, true)
 {
   if (onion_router != nullptr)
   {
@@ -42,6 +45,10 @@ tor_socket::connect(
 
   _onion_router = router;
 
+  _recv_buffer.resize(recv_buffer_size);
+  _recv_buffer_offset = 0;
+  _recv_buffer_data_size = 0;
+
   _socket.reset(new net::ssl_socket(
     _onion_router->get_ip_address().to_string(),
     _onion_router->get_or_port()));
@@ -74,6 +81,35 @@ tor_socket::connect(
   recv_net_info();
   send_net_info();
 
+#ifdef MINI_OS_LINUX
+  //
+  // the rest of the cells is received and sent
+  // by the reactor threads, the socket must not block them.
+  //
+  _socket->get_underlying_socket().set_blocking_read(false);
+  _socket->get_underlying_socket().set_blocking_write(false);
+
+  net::reactor& reactor = net::reactor::get_default();
+  const int fd = _socket->get_underlying_socket().get_native_handle();
+
+  _send_timer = reactor.add_timer([this]() { on_send_timer(); });
+
+  set_state(state::ready);
+
+  reactor.add(fd, [this]() {
+    on_readable();
+    on_writable();
+  });
+
+  //
+  // the handshake might have read more than it consumed,
+  // the cells left in the receive buffer (or in the TLS layer)
+  // wouldn't wake up the reactor. the write request
+  // dispatches the callback right away, which drains them
+  // and writes the cells queued before the registration.
+  //
+  reactor.request_write(fd);
+#else
   //
   // start the receive loop.
   //
@@ -86,6 +122,7 @@ tor_socket::connect(
   // this shouldn't fail unless the creation of the thread fails.
   //
   wait_for_state(state::ready);
+#endif
 }
 
 void
@@ -106,16 +143,31 @@ tor_socket::close(
 
   set_state(state::closing);
 
-  while (!_circuit_map.is_empty())
+  for (;;)
   {
-    _circuit_map.end()[-1].second->send_destroy_cell();
+    circuit* last_circuit = nullptr;
+
+    mini_lock(_circuit_map_mutex)
+    {
+      if (!_circuit_map.is_empty())
+      {
+        last_circuit = _circuit_map.end()[-1].second;
+      }
+    }
+
+    if (!last_circuit)
+    {
+      break;
+    }
+
+    last_circuit->send_destroy_cell();
 
     //
     // this call will:
     //   close all the streams in the circuit
     //   remove the circuit from our circuit map.
     //
-    _circuit_map.end()[-1].second->destroy();
+    last_circuit->destroy();
   }
 
   mini_assert(_circuit_map.is_empty());
@@ -137,7 +189,12 @@ tor_socket::create_circuit(
   }
 
   circuit* new_circuit = new circuit(*this);
-  _circuit_map.insert(new_circuit->get_circuit_id(), new_circuit);
+
+  mini_lock(_circuit_map_mutex)
+  {
+    _circuit_map.insert(new_circuit->get_circuit_id(), new_circuit);
+  }
+
   new_circuit->create(_onion_router, handshake);
 
   //
@@ -155,7 +212,25 @@ tor_socket::remove_circuit(
 {
   mini_debug("tor_socket::remove_circuit() [circuit: %u]", circuit->get_circuit_id() & 0x7FFFFFFF);
 
-  _circuit_map.remove(circuit->get_circuit_id());
+  bool is_dispatching = false;
+
+  mini_lock(_circuit_map_mutex)
+  {
+    _circuit_map.remove(circuit->get_circuit_id());
+
+    //
+    // the circuit may be removed from its own cell handler,
+    // there is nothing to wait for in that case.
+    //
+    is_dispatching =
+      _dispatching_circuit == circuit &&
+      _current_circuit != circuit;
+  }
+
+  if (is_dispatching)
+  {
+    _dispatch_done_event.wait();
+  }
 }
 
 void
@@ -165,67 +240,113 @@ tor_socket::send_cell(
 {
   if (is_connected())
   {
-    byte_buffer cell_content = cell.get_bytes(static_cast<protocol_version_type>(_protocol_version));
-    _socket->write(cell_content.get_buffer(), cell_content.get_size());
-  }
-}
+    const protocol_version_type protocol_version = static_cast<protocol_version_type>(_protocol_version);
+    const size_type cell_size = cell.get_size_in_bytes(protocol_version);
 
-cell
-tor_socket::recv_cell(
-  void
-  )
-{
-  cell cell;
+    bool is_due;
+    bool is_first;
 
-  if (is_connected()) do
-  {
-    io::stream_wrapper socket_buffer(*_socket, endianness::big_endian);
+    mini_lock(_send_buffer_mutex)
+    {
+      //
+      // serialize the cell right behind the queued ones.
+      //
+      const size_type offset = _send_buffer.get_size();
+      _send_buffer.resize_unsafe(offset + cell_size);
+
+      cell.write_bytes(protocol_version, mutable_byte_buffer_ref(
+        &_send_buffer[offset],
+        &_send_buffer[offset] + cell_size));
+
+      //
+      // the cells are held for up to the send delay,
+      // unless there is a full TLS record worth of them.
+      //
+      is_first = offset == 0;
+      is_due =
+        _send_delay == 0 ||
+        _send_buffer.get_size() >= send_buffer_flush_size;
+
+#ifdef MINI_OS_LINUX
+      if (is_due)
+      {
+        _send_requested = true;
+      }
+#else
+      if (is_due)
+      {
+        _send_buffer_full_event.set();
+      }
+#endif
+    }
 
+#ifdef MINI_OS_LINUX
     //
-    // get circuit id based on the current protocol version.
+    // the link handshake is performed before the socket
+    // is handed to the reactor, its cells are written right away.
     //
-    circuit_id_type circuit_id;
-    if (_protocol_version < 4)
+    if (get_state() == state::handshake_in_progress)
     {
-      circuit_id_v3_type circuit_id_v3;
-      mini_break_if(socket_buffer.read(circuit_id_v3) != sizeof(circuit_id_v3_type));
+      flush_send_buffer();
+      return;
+    }
+
+    net::reactor& reactor = net::reactor::get_default();
 
-      circuit_id = static_cast<circuit_id_type>(circuit_id_v3);
+    if (is_due || _send_timer == -1)
+    {
+      reactor.request_write(_socket->get_underlying_socket().get_native_handle());
     }
-    else
+    else if (is_first)
     {
-      mini_break_if(socket_buffer.read(circuit_id) != sizeof(circuit_id_type));
+      reactor.set_timer(_send_timer, _send_delay);
     }
+#else
+    MINI_UNREFERENCED(is_first);
 
-    //
-    // get the cell command.
-    //
-    cell_command command;
-    mini_break_if(socket_buffer.read(command) != sizeof(cell_command));
+    write_send_buffer();
+#endif
+  }
+}
 
-    //
-    // get payload size for variable-length cell types.
-    //
-    payload_size_type payload_size = cell::payload_size;
-    if (cell::is_variable_length_cell_command(command))
-    {
-      mini_break_if(socket_buffer.read<payload_size_type>(payload_size) != sizeof(payload_size_type));
-    }
+timeout_type
+tor_socket::get_send_delay(
+  void
+  ) const
+{
+  return _send_delay;
+}
 
-    //
-    // get the content of the payload.
-    //
-    byte_buffer payload(payload_size);
-    mini_break_if(socket_buffer.read(payload.get_buffer(), payload_size) != payload_size);
+void
+tor_socket::set_send_delay(
+  timeout_type send_delay
+  )
+{
+  _send_delay = send_delay;
+}
 
-    //
-    // build the cell
-    //
-    cell.set_circuit_id(circuit_id);
-    cell.set_command(command);
-    cell.set_payload(payload);
-    cell.mark_as_valid();
-  } while (false);
+cell
+tor_socket::recv_cell(
+  void
+  )
+{
+  //
+  // the cells are split from the receive buffer,
+  // the socket is read only when the buffer
+  // doesn't contain a complete cell.
+  //
+  cell cell;
+
+  if (is_connected())
+  {
+    while (!split_cell(cell))
+    {
+      if (!io::stream::success(read_recv_buffer()))
+      {
+        break;
+      }
+    }
+  }
 
   return cell;
 }
@@ -251,11 +372,30 @@ tor_socket::get_circuit_by_id(
   circuit_id_type circuit_id
   )
 {
-  circuit** circuit = _circuit_map.find(circuit_id);
+  mini_lock(_circuit_map_mutex)
+  {
+    circuit** circuit = _circuit_map.find(circuit_id);
 
-  return circuit
-    ? *circuit
-    : nullptr;
+    return circuit
+      ? *circuit
+      : nullptr;
+  }
+}
+
+circuit_pool*
+tor_socket::get_circuit_pool(
+  void
+  )
+{
+  return _circuit_pool;
+}
+
+void
+tor_socket::set_circuit_pool(
+  circuit_pool* pool
+  )
+{
+  _circuit_pool = pool;
 }
 
 bool
@@ -298,13 +438,48 @@ tor_socket::set_state(
     // this must be done before the actual change
     // of the state.
     //
-    _socket.reset();
-    _recv_cell_loop_thread->join();
+#ifdef MINI_OS_LINUX
+    if (_socket)
+    {
+      net::reactor& reactor = net::reactor::get_default();
 
+      if (_send_timer != -1)
+      {
+        reactor.remove(_send_timer);
+        _send_timer = -1;
+      }
+
+      reactor.remove(_socket->get_underlying_socket().get_native_handle());
+
+      //
+      // the reactor doesn't write anymore, flush the queued
+      // cells (e.g. DESTROY cells sent by close()) here.
+      //
+      _socket->get_underlying_socket().set_blocking_write(true);
+      flush_send_buffer();
+    }
+
+    _socket.reset();
+#else
     //
-    // terminate the thread.
+    // the cells are written by the threads which queued them,
+    // wait for the last write to finish.
     //
-    _recv_cell_loop_thread.reset();
+    _send_buffer_full_event.set();
+    _send_idle_event.wait();
+
+    _socket.reset();
+
+    if (_recv_cell_loop_thread)
+    {
+      _recv_cell_loop_thread->join();
+
+      //
+      // terminate the thread.
+      //
+      _recv_cell_loop_thread.reset();
+    }
+#endif
 
     //
     // set back the protocol version to 3.
@@ -478,17 +653,370 @@ tor_socket::recv_cell_loop(
       break;
     }
 
-    if (circuit* circuit = get_circuit_by_id(cell.get_circuit_id()))
+    handle_cell(cell);
+  }
+}
+
+#ifdef MINI_OS_LINUX
+
+void
+tor_socket::on_readable(
+  void
+  )
+{
+  for (;;)
+  {
+    //
+    // handle all the complete cells received so far.
+    //
+    cell cell;
+    while (split_cell(cell))
+    {
+      handle_cell(cell);
+
+      if (get_state() == state::closing)
+      {
+        return;
+      }
+
+      cell = tor::cell();
+    }
+
+    const size_type bytes_read = read_recv_buffer();
+
+    //
+    // drained, the reactor notifies us again
+    // when more data arrive.
+    //
+    if (bytes_read == io::stream::would_block)
+    {
+      return;
+    }
+
+    if (!io::stream::success(bytes_read))
+    {
+      if (get_state() != state::closing)
+      {
+        mini_warning("tor_socket::on_readable() !! connection closed");
+        close();
+      }
+
+      return;
+    }
+  }
+}
+
+void
+tor_socket::on_writable(
+  void
+  )
+{
+  if (!is_connected())
+  {
+    return;
+  }
+
+  bool send_requested;
+
+  mini_lock(_send_buffer_mutex)
+  {
+    send_requested = _send_requested;
+  }
+
+  //
+  // the TLS layer might need to answer (e.g. a key update)
+  // even if there are no cells due.
+  //
+  if (send_requested)
+  {
+    flush_send_buffer();
+  }
+  else
+  {
+    _socket->flush();
+  }
+
+  //
+  // the socket didn't accept everything, the rest
+  // is written once it becomes writable again.
+  //
+  if (_socket->has_pending_output())
+  {
+    net::reactor::get_default().request_write(
+      _socket->get_underlying_socket().get_native_handle());
+  }
+}
+
+void
+tor_socket::on_send_timer(
+  void
+  )
+{
+  mini_lock(_send_buffer_mutex)
+  {
+    _send_requested = true;
+  }
+
+  net::reactor::get_default().request_write(
+    _socket->get_underlying_socket().get_native_handle());
+}
+
+#endif
+
+void
+tor_socket::handle_cell(
+  cell& cell
+  )
+{
+  //
+  // the circuit stays in the circuit map for the whole dispatch,
+  // remove_circuit() waits until the dispatch is done.
+  //
+  circuit* circuit = nullptr;
+
+  mini_lock(_circuit_map_mutex)
+  {
+    if (auto circuit_entry = _circuit_map.find(cell.get_circuit_id()))
+    {
+      circuit = *circuit_entry;
+      _dispatching_circuit = circuit;
+      _dispatch_done_event.reset();
+    }
+  }
+
+  if (circuit)
+  {
+    _current_circuit = circuit;
+    circuit->handle_cell(cell);
+    _current_circuit = nullptr;
+
+    mini_lock(_circuit_map_mutex)
+    {
+      _dispatching_circuit = nullptr;
+      _dispatch_done_event.set();
+    }
+  }
+  else
+  {
+    mini_warning(
+      "tor_socket::handle_cell() !! received cell for non-existent circuit-id: %u",
+      cell.get_circuit_id() & 0x7fffffff);
+  }
+}
+
+bool
+tor_socket::split_cell(
+  cell& cell
+  )
+{
+  //
+  // get circuit id based on the current protocol version.
+  //
+  const size_type circuit_id_size = _protocol_version < 4
+    ? sizeof(circuit_id_v3_type)
+    : sizeof(circuit_id_type);
+
+  //
+  // each cell is at least this long, the payload size
+  // of the variable-length cells fits in as well.
+  //
+  const size_type header_size =
+    circuit_id_size +
+    sizeof(cell_command) +
+    sizeof(payload_size_type);
+
+  if (_recv_buffer_data_size < header_size)
+  {
+    return false;
+  }
+
+  io::memory_stream header_stream(byte_buffer_ref(
+    &_recv_buffer[_recv_buffer_offset],
+    &_recv_buffer[_recv_buffer_offset] + header_size));
+  io::stream_wrapper header_buffer(header_stream, endianness::big_endian);
+
+  circuit_id_type circuit_id;
+  if (_protocol_version < 4)
+  {
+    circuit_id = static_cast<circuit_id_type>(header_buffer.read<circuit_id_v3_type>());
+  }
+  else
+  {
+    circuit_id = header_buffer.read<circuit_id_type>();
+  }
+
+  //
+  // get the cell command.
+  //
+  const cell_command command = header_buffer.read<cell_command>();
+
+  //
+  // get payload size for variable-length cell types.
+  //
+  payload_size_type payload_size = cell::payload_size;
+  if (cell::is_variable_length_cell_command(command))
+  {
+    payload_size = header_buffer.read<payload_size_type>();
+  }
+
+  const size_type payload_offset = header_stream.get_position();
+  const size_type cell_size = payload_offset + payload_size;
+
+  if (_recv_buffer_data_size < cell_size)
+  {
+    //
+    // variable-length cells might not fit into the buffer.
+    //
+    if (cell_size > _recv_buffer.get_size())
+    {
+      _recv_buffer.resize(cell_size);
+    }
+
+    return false;
+  }
+
+  //
+  // copy the payload into the cell.
+  //
+  cell.set_payload_size(payload_size);
+  memory::copy(
+    cell.get_mutable_payload().get_buffer(),
+    &_recv_buffer[_recv_buffer_offset + payload_offset],
+    payload_size);
+
+  _recv_buffer_offset += cell_size;
+  _recv_buffer_data_size -= cell_size;
+
+  if (_recv_buffer_data_size == 0)
+  {
+    _recv_buffer_offset = 0;
+  }
+
+  //
+  // build the cell
+  //
+  cell.set_circuit_id(circuit_id);
+  cell.set_command(command);
+  cell.mark_as_valid();
+
+  return true;
+}
+
+size_type
+tor_socket::read_recv_buffer(
+  void
+  )
+{
+  //
+  // move the incomplete cell to the very begin
+  // of the buffer if there is no room behind it.
+  //
+  if (_recv_buffer_offset + _recv_buffer_data_size == _recv_buffer.get_size())
+  {
+    memory::move(
+      &_recv_buffer[0],
+      &_recv_buffer[_recv_buffer_offset],
+      _recv_buffer_data_size);
+
+    _recv_buffer_offset = 0;
+  }
+
+  //
+  // read as much as the socket has available.
+  //
+  const size_type write_offset = _recv_buffer_offset + _recv_buffer_data_size;
+  const size_type bytes_read = _socket->read(
+    &_recv_buffer[write_offset],
+    _recv_buffer.get_size() - write_offset);
+
+  if (io::stream::success(bytes_read))
+  {
+    _recv_buffer_data_size += bytes_read;
+  }
+
+  return bytes_read;
+}
+
+void
+tor_socket::flush_send_buffer(
+  void
+  )
+{
+  mini_lock(_send_buffer_mutex)
+  {
+    _write_buffer.clear();
+    _write_buffer.swap(_send_buffer);
+
+#ifdef MINI_OS_LINUX
+    _send_requested = false;
+#endif
+  }
+
+  //
+  // all the cells queued so far are written at once,
+  // the records produced by the reader go along.
+  //
+  if (!_write_buffer.is_empty())
+  {
+    _socket->write(_write_buffer.get_buffer(), _write_buffer.get_size());
+  }
+  else
+  {
+    _socket->flush();
+  }
+}
+
+#ifndef MINI_OS_LINUX
+
+void
+tor_socket::write_send_buffer(
+  void
+  )
+{
+  mini_lock(_send_buffer_mutex)
+  {
+    //
+    // the writing thread picks the cell up.
+    //
+    if (_send_in_progress)
     {
-      circuit->handle_cell(cell);
+      return;
     }
-    else
+
+    _send_in_progress = true;
+    _send_idle_event.reset();
+  }
+
+  //
+  // give the other threads a chance to fill the TLS record,
+  // but don't hold the cells longer than the send delay.
+  //
+  if (_send_delay > 0)
+  {
+    _send_buffer_full_event.wait(_send_delay);
+  }
+
+  for (;;)
+  {
+    flush_send_buffer();
+
+    mini_lock(_send_buffer_mutex)
     {
-      mini_warning(
-        "tor_socket::recv_cell_loop() !! received cell for non-existent circuit-id: %u",
-        cell.get_circuit_id() & 0x7fffffff);
+      //
+      // the cells queued during the write
+      // are written by this thread as well.
+      //
+      if (_send_buffer.is_empty())
+      {
+        _send_in_progress = false;
+        _send_buffer_full_event.reset();
+        _send_idle_event.set();
+        return;
+      }
     }
   }
 }
 
+#endif
+
 }
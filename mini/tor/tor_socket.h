@@ -4,7 +4,9 @@
 
 #include <mini/ptr.h>
 #include <mini/net/ssl_socket.h>
+#include <mini/net/reactor.h>
 #include <mini/threading/thread_function.h>
+#include <mini/threading/event.h>
 #include <mini/threading/mutex.h>
 #include <mini/threading/locked_value.h>
 
@@ -13,6 +15,7 @@
 namespace mini::tor {
 
 class circuit;
+class circuit_pool;
 
 class tor_socket
 {
@@ -43,16 +46,42 @@ class tor_socket
       handshake_type handshake = preferred_handshake_type
       );
 
+    //
+    // removes the circuit from the circuit map and waits
+    // until the receive path isn't dispatching a cell to it.
+    // afterwards the circuit can be safely deleted.
+    //
     void
     remove_circuit(
       circuit* circuit
       );
 
+    //
+    // the cell is queued and written along with the other
+    // queued cells, by the reactor on linux, otherwise
+    // by the thread which finds no write in progress.
+    //
     void
     send_cell(
       const cell& cell
       );
 
+    //
+    // how long the queued cells may be held
+    // while waiting for a full TLS record worth of data.
+    // 0 means the cells are written as soon as possible,
+    // they are still coalesced while a write is in progress.
+    //
+    timeout_type
+    get_send_delay(
+      void
+      ) const;
+
+    void
+    set_send_delay(
+      timeout_type send_delay
+      );
+
     cell
     recv_cell(
       void
@@ -68,11 +97,29 @@ class tor_socket
       void
       );
 
+    //
+    // the circuit may be deleted by another thread
+    // once it is removed from the circuit map.
+    //
     circuit*
     get_circuit_by_id(
       circuit_id_type circuit_id
       );
 
+    //
+    // the pool of prebuilt circuits on this socket, if any.
+    // the socket doesn't own it.
+    //
+    circuit_pool*
+    get_circuit_pool(
+      void
+      );
+
+    void
+    set_circuit_pool(
+      circuit_pool* pool
+      );
+
     bool
     is_connected(
       void
@@ -146,13 +193,147 @@ class tor_socket
       void
       );
 
+#ifdef MINI_OS_LINUX
+    //
+    // called by the reactor when the socket becomes readable.
+    //
+    void
+    on_readable(
+      void
+      );
+
+    //
+    // called by the reactor when the socket becomes writable
+    // after the write was requested.
+    //
+    void
+    on_writable(
+      void
+      );
+
+    //
+    // called by the reactor when the send delay expires.
+    //
+    void
+    on_send_timer(
+      void
+      );
+#endif
+
+    void
+    handle_cell(
+      cell& cell
+      );
+
+    //
+    // moves the next complete cell out of the receive buffer.
+    // returns false if the buffer doesn't contain one yet.
+    //
+    bool
+    split_cell(
+      cell& cell
+      );
+
+    //
+    // single read from the socket into the receive buffer.
+    //
+    size_type
+    read_recv_buffer(
+      void
+      );
+
+    //
+    // writes all the queued cells (the TLS layer
+    // keeps what the non-blocking socket doesn't accept).
+    //
+    void
+    flush_send_buffer(
+      void
+      );
+
+#ifndef MINI_OS_LINUX
+    //
+    // writes the queued cells unless another
+    // thread is writing them already.
+    //
+    void
+    write_send_buffer(
+      void
+      );
+#endif
+
+    //
+    // size of the buffer for the incoming data,
+    // it holds several full TLS records worth of cells.
+    //
+    static constexpr size_type recv_buffer_size = 32 * 1024;
+
     ptr<net::ssl_socket> _socket;
+
+    //
+    // data received from the socket which haven't
+    // been split into the cells yet.
+    //
+    byte_buffer _recv_buffer;
+    size_type _recv_buffer_offset = 0;
+    size_type _recv_buffer_data_size = 0;
+
+    //
+    // maximum size of the TLS record payload.
+    // the queued cells aren't held for more data
+    // once this much is queued.
+    //
+    static constexpr size_type send_buffer_flush_size = 16 * 1024;
+
+    //
+    // serialized cells waiting to be written.
+    // the cells being written are swapped into
+    // the _write_buffer, so both keep their capacity.
+    //
+    byte_buffer _send_buffer;
+    byte_buffer _write_buffer;
+    threading::mutex _send_buffer_mutex;
+    timeout_type _send_delay = 0;
+
+#ifdef MINI_OS_LINUX
+    //
+    // set when the queued cells are due,
+    // guarded by _send_buffer_mutex.
+    //
+    bool _send_requested = false;
+    int _send_timer = -1;
+#else
+    //
+    // set while no thread is writing the queued cells,
+    // _send_in_progress is guarded by _send_buffer_mutex.
+    //
+    bool _send_in_progress = false;
+    threading::event _send_idle_event { threading::reset_type::manual_reset, true };
+    threading::event _send_buffer_full_event;
+#endif
+
     ptr<threading::thread_function> _recv_cell_loop_thread;
 
     onion_router* _onion_router = nullptr;
     uint32_t _protocol_version = protocol_version_initial;
 
+    //
+    // the circuits are created and destroyed
+    // by the circuit pool threads as well.
+    //
     collections::pair_list<circuit_id_type, circuit*> _circuit_map;
+    threading::mutex _circuit_map_mutex;
+
+    //
+    // the circuit handle_cell() is dispatching a cell to,
+    // guarded by _circuit_map_mutex. the event is set
+    // while no dispatch is in progress.
+    //
+    circuit* _dispatching_circuit = nullptr;
+    threading::event _dispatch_done_event;
+    static thread_local circuit* _current_circuit;
+
+    circuit_pool* _circuit_pool = nullptr;
     threading::locked_value<state> _state = state::closed;
 };
 
@@ -12,6 +12,7 @@ tor_stream::tor_stream(
   )
   : _stream_id(stream_id)
   , _circuit(circuit)
+  , _buffer_event(threading::reset_type::manual_reset, false)
 {
 
 }
@@ -91,6 +92,38 @@ tor_stream::get_stream_id(
   return _stream_id;
 }
 
+timeout_type
+tor_stream::get_read_timeout(
+  void
+  ) const
+{
+  return _read_timeout;
+}
+
+void
+tor_stream::set_read_timeout(
+  timeout_type timeout
+  )
+{
+  _read_timeout = timeout;
+}
+
+size_type
+tor_stream::get_recv_high_water_mark(
+  void
+  ) const
+{
+  return _recv_high_water_mark;
+}
+
+void
+tor_stream::set_recv_high_water_mark(
+  size_type high_water_mark
+  )
+{
+  _recv_high_water_mark = high_water_mark;
+}
+
 void
 tor_stream::close(
   void
@@ -117,7 +150,12 @@ tor_stream::append_to_recv_buffer(
   {
     mini_debug("tor_stream::append_to_recv_buffer() [ size = %u ]", static_cast<uint32_t>(buffer.get_size()));
 
-    _buffer.add_many(buffer);
+    _buffer.write(buffer);
+
+    //
+    // wake up the reader.
+    //
+    _buffer_event.set();
   }
 }
 
@@ -139,6 +177,12 @@ tor_stream::set_state(
   if (new_state == state::destroyed)
   {
     _state.cancel_all_waits();
+
+    //
+    // wake up the reader, it will return
+    // whatever is left in the buffer.
+    //
+    _buffer_event.set();
   }
 }
 
@@ -151,6 +195,40 @@ tor_stream::wait_for_state(
   return _state.wait_for_value(desired_state, timeout);
 }
 
+bool
+tor_stream::wait_for_connected(
+  timeout_type timeout
+  )
+{
+  //
+  // RELAY_END or the circuit destruction
+  // set the destroyed state and cancel the wait.
+  //
+  if (!mini_wait_success(wait_for_state(state::ready, timeout)))
+  {
+    mini_warning("tor_stream::wait_for_connected() [stream: %u, state: %s]",
+      _stream_id,
+      get_state() == state::destroyed ? "destroyed" : "timeout");
+
+    return false;
+  }
+
+  return true;
+}
+
+void
+tor_stream::cancel_waits(
+  void
+  )
+{
+  _state.cancel_all_waits();
+
+  mini_lock(_buffer_mutex)
+  {
+    _buffer_event.set();
+  }
+}
+
 //
 // flow control.
 //
@@ -216,6 +294,22 @@ tor_stream::consider_sending_sendme(
       return false;
     }
 
+    //
+    // the reader isn't keeping up, let the exit wait.
+    // send_pending_sendmes() catches up once the buffer drains.
+    //
+    size_type buffer_size;
+    mini_lock(_buffer_mutex)
+    {
+      buffer_size = _buffer.get_size();
+    }
+
+    if (buffer_size >= _recv_high_water_mark)
+    {
+      mini_debug("tor_stream::consider_sending_sendme(): false (high water mark reached)");
+      return false;
+    }
+
     //
     // we're currently flushing immediatelly upon write,
     // therefore there is no need to check unflushed cell count,
@@ -234,6 +328,21 @@ tor_stream::consider_sending_sendme(
   }
 }
 
+void
+tor_stream::send_pending_sendmes(
+  void
+  )
+{
+  //
+  // called by the reader after it has consumed data
+  // from the receive buffer.
+  //
+  while (get_state() != state::destroyed && consider_sending_sendme())
+  {
+    _circuit->send_relay_sendme_cell(this);
+  }
+}
+
 //
 // io::stream
 //
@@ -245,7 +354,7 @@ tor_stream::read_impl(
   )
 {
   //
-  // pull data.
+  // wait for data.
   //
   for (;;)
   {
@@ -255,29 +364,40 @@ tor_stream::read_impl(
       {
         break;
       }
+
+      //
+      // the event is reset under the buffer lock,
+      // so we can't miss the append_to_recv_buffer() signal.
+      //
+      _buffer_event.reset();
     }
 
-    if (get_state() == state::destroyed)
+    if (get_state() == state::destroyed || _circuit->is_cancelled())
     {
       break;
     }
 
-    threading::thread::sleep(10);
+    if (!mini_wait_success(_buffer_event.wait(_read_timeout)))
+    {
+      mini_warning("tor_stream::read() !! timeout [stream: %u]", _stream_id);
+      break;
+    }
   }
 
   //
   // process data
   //
-  size_type size_to_copy;
+  size_type size_copied;
   mini_lock(_buffer_mutex)
   {
-    size_to_copy = algorithm::min(size, _buffer.get_size());
-    memory::copy(buffer, &_buffer[0], size_to_copy);
-
-    _buffer = byte_buffer_ref(_buffer).slice(size_to_copy);
+    size_copied = _buffer.read(mutable_byte_buffer_ref(
+      static_cast<byte_type*>(buffer),
+      static_cast<byte_type*>(buffer) + size));
   }
 
-  return size_to_copy;
+  send_pending_sendmes();
+
+  return size_copied;
 }
 
 size_type
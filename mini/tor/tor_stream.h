@@ -2,16 +2,24 @@
 #include "common.h"
 
 #include <mini/io/stream.h>
+#include <mini/collections/ring_buffer.h>
+#include <mini/threading/event.h>
 #include <mini/threading/locked_value.h>
 
 namespace mini::tor {
 
 class circuit;
 
+namespace detail {
+struct tor_stream_access;
+}
+
 class tor_stream
   : public io::stream
 {
   public:
+    static constexpr timeout_type connect_timeout_default = 30000;
+
     tor_stream(
       tor_stream_id_type stream_id,
       circuit* circuit
@@ -67,8 +75,29 @@ class tor_stream
       void
       ) const;
 
+    timeout_type
+    get_read_timeout(
+      void
+      ) const;
+
+    void
+    set_read_timeout(
+      timeout_type timeout
+      );
+
+    size_type
+    get_recv_high_water_mark(
+      void
+      ) const;
+
+    void
+    set_recv_high_water_mark(
+      size_type high_water_mark
+      );
+
   private:
     friend class circuit;
+    friend struct detail::tor_stream_access;
 
     enum class state
     {
@@ -96,7 +125,21 @@ class tor_stream
     threading::wait_result
     wait_for_state(
       state desired_state,
-      timeout_type timeout = 30000
+      timeout_type timeout = connect_timeout_default
+      );
+
+    bool
+    wait_for_connected(
+      timeout_type timeout
+      );
+
+    //
+    // wakes the reader and the connect wait
+    // of a cancelled circuit.
+    //
+    void
+    cancel_waits(
+      void
       );
 
     //
@@ -123,6 +166,11 @@ class tor_stream
       void
       );
 
+    void
+    send_pending_sendmes(
+      void
+      );
+
     //
     // io::stream
     //
@@ -143,6 +191,13 @@ class tor_stream
     static constexpr size_type window_increment = 50;
     static constexpr size_type window_max_unflushed = 10;
 
+    //
+    // when the receive buffer holds at least this many bytes,
+    // the stream-level RELAY_SENDME is held back until the reader
+    // drains it, which stops the exit from sending more data.
+    //
+    static constexpr size_type recv_high_water_mark_default = 128 * 1024;
+
     tor_stream_id_type _stream_id;
     circuit* _circuit;
 
@@ -150,9 +205,16 @@ class tor_stream
     size_type _package_window = window_start;
     threading::mutex _window_mutex;
 
-    byte_buffer _buffer;
+    collections::ring_buffer<byte_type> _buffer;
+    size_type _recv_high_water_mark = recv_high_water_mark_default;
     threading::mutex _buffer_mutex;
 
+    //
+    // signaled when new data arrives or the stream is destroyed.
+    //
+    threading::event _buffer_event;
+    timeout_type _read_timeout = wait_infinite;
+
     threading::locked_value<state> _state = state::connecting;
 };
 